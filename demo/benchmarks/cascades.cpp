@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "Gamma.h"
+#include "system/CascadeSet.h"
+#include "benchmarks/cascades.h"
+
+using namespace Gamma;
+
+constexpr static u32 TOTAL_CAMERAS = 1000;
+constexpr static u32 TOTAL_BUILDS = 100000;
+
+static float randomFloat(float low, float high) {
+  return low + (high - low) * ((float)rand() / (float)RAND_MAX);
+}
+
+static Camera createRandomCamera(const Vec3f& position, float range) {
+  Camera camera;
+
+  camera.position = position + Vec3f(randomFloat(-range, range), randomFloat(-range, range), randomFloat(-range, range));
+  camera.orientation = Orientation(0.0f, randomFloat(-1.5f, 1.5f), randomFloat(-Gm_PI, Gm_PI));
+  camera.rotation = camera.orientation.toQuaternion();
+
+  return camera;
+}
+
+/**
+ * Builds cascades for cameras turning and moving slightly
+ * around a point, and logs how far their light matrices drift
+ * from a reference set of cascades. The rotation/scale terms
+ * shouldn't change at all, and translations should only ever
+ * shift by whole shadow map texels.
+ */
+static void verify_cascade_stability() {
+  Console::log("verify_cascade_stability");
+
+  Vec3f position(12.3f, 40.0f, -77.0f);
+  Vec3f lightDirection = Vec3f(0.3f, -1.0f, 0.2f).unit();
+  Area<u32> resolution = { 1920, 1080 };
+  CascadeSettings settings;
+  CascadeSet reference;
+
+  reference.build(settings, lightDirection, createRandomCamera(position, 0.0f), resolution);
+
+  float largestScaleDrift = 0.0f;
+  float largestTexelDrift = 0.0f;
+  u32 totalMismatches = 0;
+
+  for (u32 i = 0; i < TOTAL_CAMERAS; i++) {
+    Camera camera = createRandomCamera(position, 3.0f);
+    CascadeSet cascades;
+    CascadeSet rebuiltCascades;
+
+    cascades.build(settings, lightDirection, camera, resolution);
+    rebuiltCascades.build(settings, lightDirection, camera, resolution);
+
+    for (u32 c = 0; c < cascades.size(); c++) {
+      auto& a = reference[c].matLightViewProjection;
+      auto& b = cascades[c].matLightViewProjection;
+
+      for (u32 j = 0; j < 12; j++) {
+        largestScaleDrift = std::max(largestScaleDrift, fabsf(a.m[j] - b.m[j]));
+      }
+
+      for (u32 j = 12; j < 14; j++) {
+        // Clip space spans 2 units across the shadow map
+        float texels = (a.m[j] - b.m[j]) * (float)DIRECTIONAL_SHADOW_MAP_SIZE * 0.5f;
+
+        largestTexelDrift = std::max(largestTexelDrift, fabsf(texels - roundf(texels)));
+      }
+
+      if (std::memcmp(&cascades[c], &rebuiltCascades[c], sizeof(Cascade)) != 0) {
+        totalMismatches++;
+      }
+    }
+  }
+
+  Console::log("Scale drift:", largestScaleDrift, "Sub-texel drift:", largestTexelDrift, "Rebuild mismatches:", totalMismatches);
+}
+
+static void benchmark_cascade_builds() {
+  Console::log("benchmark_cascade_builds");
+
+  Vec3f lightDirection = Vec3f(0.3f, -1.0f, 0.2f).unit();
+  Camera camera = createRandomCamera(Vec3f(0.0f), 100.0f);
+  CascadeSettings settings;
+  float sum = 0.0f;
+
+  Gm_RepeatBenchmarkTest([&]() {
+    for (u32 i = 0; i < TOTAL_BUILDS; i++) {
+      CascadeSet cascades;
+
+      cascades.build(settings, lightDirection, camera, { 1920, 1080 });
+
+      sum += cascades[cascades.size() - 1].matLightViewProjection.m[0];
+    }
+  }, 3);
+
+  Console::log("Sum:", sum);
+}
+
+void benchmark_cascades() {
+  verify_cascade_stability();
+  benchmark_cascade_builds();
+}
\ No newline at end of file
@@ -0,0 +1,3 @@
+#pragma once
+
+void benchmark_cascades();
\ No newline at end of file
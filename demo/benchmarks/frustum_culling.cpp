@@ -0,0 +1,120 @@
+#include <cstdlib>
+#include <vector>
+
+#include "Gamma.h"
+#include "math/batch_culling.h"
+#include "math/simd.h"
+#include "benchmarks/frustum_culling.h"
+
+using namespace Gamma;
+
+constexpr static u32 TOTAL_FRAMES = 60;
+
+static float randomFloat(float low, float high) {
+  return low + (high - low) * ((float)rand() / (float)RAND_MAX);
+}
+
+static Frustum createFrustum() {
+  Camera camera;
+
+  camera.position = Vec3f(0.0f, 50.0f, 0.0f);
+
+  return Gm_GetCameraFrustum(camera, { 1920, 1080 });
+}
+
+/**
+ * Creates a pool of objects scattered around the camera,
+ * roughly a fifth of which are inside the frustum.
+ */
+static void createScatteredObjects(ObjectPool& pool, u32 total) {
+  srand(1);
+
+  pool.reserve(total);
+  pool.setBoundingSphere(Vec3f(0.0f), 1.0f);
+
+  for (auto& object : pool.createObjects(total)) {
+    object.position = Vec3f(
+      randomFloat(-5000.0f, 5000.0f),
+      randomFloat(-500.0f, 500.0f),
+      randomFloat(-5000.0f, 5000.0f)
+    );
+
+    object.scale = randomFloat(1.0f, 50.0f);
+    object.rotation = Vec3f(randomFloat(0.0f, Gm_TAU), randomFloat(0.0f, Gm_TAU), 0.0f);
+  }
+
+  pool.commitObjects();
+}
+
+static u64 benchmark_sphere_visibility(SimdLevel level, u32 totalObjects, u32 iterations) {
+  Gm_SetSimdLevel(level);
+
+  Console::log("benchmark_sphere_visibility", Gm_GetSimdLevelName(Gm_GetSimdLevel()), totalObjects);
+
+  ObjectPool pool;
+  std::vector<u32> masks(Gm_GetVisibilityMaskSize(totalObjects));
+  auto frustum = createFrustum();
+
+  createScatteredObjects(pool, totalObjects);
+
+  defer({
+    pool.free();
+  });
+
+  return Gm_RepeatBenchmarkTest([&]() {
+    for (u32 frame = 0; frame < TOTAL_FRAMES; frame++) {
+      Gm_ComputeSphereVisibility(frustum, pool.getBounds(), masks.data(), totalObjects);
+    }
+  }, iterations);
+}
+
+static u64 benchmark_partition_by_visibility(SimdLevel level, u32 totalObjects, u32 iterations) {
+  Gm_SetSimdLevel(level);
+
+  Console::log("benchmark_partition_by_visibility", Gm_GetSimdLevelName(Gm_GetSimdLevel()), totalObjects);
+
+  ObjectPool pool;
+  auto frustum = createFrustum();
+
+  createScatteredObjects(pool, totalObjects);
+
+  defer({
+    pool.free();
+  });
+
+  // Alternate between two camera orientations, so each frame
+  // has to reorder the pool rather than leave it as it was
+  Camera turnedCamera;
+
+  turnedCamera.position = Vec3f(0.0f, 50.0f, 0.0f);
+  turnedCamera.rotation = Quaternion::fromAxisAngle(Gm_PI, 0.0f, 1.0f, 0.0f);
+
+  auto turnedFrustum = Gm_GetCameraFrustum(turnedCamera, { 1920, 1080 });
+
+  return Gm_RepeatBenchmarkTest([&]() {
+    for (u32 frame = 0; frame < TOTAL_FRAMES; frame++) {
+      pool.partitionByVisibility(frame % 2 == 0 ? frustum : turnedFrustum);
+    }
+  }, iterations);
+}
+
+void benchmark_frustum_culling() {
+  u32 objectCounts[] = { 10000, 100000, 1000000 };
+
+  for (auto totalObjects : objectCounts) {
+    auto b_scalar = benchmark_sphere_visibility(SimdLevel::SCALAR, totalObjects, 3);
+    auto b_sse = benchmark_sphere_visibility(SimdLevel::SSE, totalObjects, 3);
+    auto b_avx2 = benchmark_sphere_visibility(SimdLevel::AVX2, totalObjects, 3);
+
+    Gm_CompareBenchmarks(b_scalar, b_sse);
+    Gm_CompareBenchmarks(b_scalar, b_avx2);
+
+    auto b_scalar_partition = benchmark_partition_by_visibility(SimdLevel::SCALAR, totalObjects, 3);
+    auto b_avx2_partition = benchmark_partition_by_visibility(SimdLevel::AVX2, totalObjects, 3);
+
+    Gm_CompareBenchmarks(b_scalar_partition, b_avx2_partition);
+  }
+
+  // Restore the widest supported level
+  Gm_SetSimdLevel(SimdLevel::AVX2);
+}
\ No newline at end of file
@@ -0,0 +1,3 @@
+#pragma once
+
+void benchmark_frustum_culling();
\ No newline at end of file
@@ -1,12 +1,143 @@
+#include <cstdlib>
+#include <vector>
+
 #include "Gamma.h"
 #include "benchmarks/matrix_multiplication.h"
 
 using namespace Gamma;
 
-constexpr static uint32 TEST_ITERATIONS = 1;
-constexpr static uint32 TOTAL_MATRICES = 1000000;
+constexpr static u32 TEST_ITERATIONS = 1;
+constexpr static u32 TOTAL_MATRICES = 1000000;
+
+/**
+ * The number of times each math kernel benchmark runs over
+ * its (cache resident) matrices.
+ */
+constexpr static u32 TOTAL_KERNEL_PASSES = 1000;
+constexpr static u32 TOTAL_KERNEL_MATRICES = 1024;
+
+static float randomFloat(float low, float high) {
+  return low + (high - low) * ((float)rand() / (float)RAND_MAX);
+}
+
+/**
+ * Creates random transformation matrices, which are always
+ * invertible, for the math kernel benchmarks.
+ */
+static std::vector<Matrix4f> createRandomMatrices() {
+  std::vector<Matrix4f> matrices(TOTAL_KERNEL_MATRICES);
+
+  srand(1);
+
+  for (auto& matrix : matrices) {
+    Vec3f position = Vec3f(randomFloat(-1000.0f, 1000.0f), randomFloat(-1000.0f, 1000.0f), randomFloat(-1000.0f, 1000.0f));
+    Vec3f scale = Vec3f(randomFloat(0.1f, 10.0f), randomFloat(0.1f, 10.0f), randomFloat(0.1f, 10.0f));
+    Vec3f rotation = Vec3f(randomFloat(0.0f, Gm_TAU), randomFloat(0.0f, Gm_TAU), randomFloat(0.0f, Gm_TAU));
+
+    matrix = Matrix4f::transformation(position, scale, rotation);
+  }
+
+  return matrices;
+}
+
+static std::vector<Quaternion> createRandomQuaternions() {
+  std::vector<Quaternion> quaternions(TOTAL_KERNEL_MATRICES);
+
+  srand(1);
+
+  for (auto& quaternion : quaternions) {
+    Vec3f axis = Vec3f(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f)).unit();
+
+    quaternion = Quaternion::fromAxisAngle(randomFloat(0.0f, Gm_TAU), axis.x, axis.y, axis.z);
+  }
+
+  return quaternions;
+}
+
+/**
+ * Runs a kernel over the indices of the random matrices, many
+ * times over, accumulating a term of each result so the kernel
+ * can't be optimized out.
+ */
+template<typename Kernel>
+static u64 benchmark_kernel(const char* name, Kernel kernel) {
+  Console::log(name);
+
+  float sum = 0.0f;
+
+  u64 time = Gm_RepeatBenchmarkTest([&]() {
+    for (u32 pass = 0; pass < TOTAL_KERNEL_PASSES; pass++) {
+      for (u32 i = 0; i < TOTAL_KERNEL_MATRICES; i++) {
+        sum += kernel(i);
+      }
+    }
+  }, TEST_ITERATIONS);
+
+  Console::log("Sum:", sum);
+
+  return time;
+}
+
+static void benchmark_math_kernels() {
+  auto matrices = createRandomMatrices();
+  auto quaternions = createRandomQuaternions();
+
+  auto next = [](u32 i) {
+    return (i + 1) % TOTAL_KERNEL_MATRICES;
+  };
+
+  auto b_multiply_scalar = benchmark_kernel("Gm_MultiplyMatricesScalar", [&](u32 i) {
+    return Gm_MultiplyMatricesScalar(matrices[i], matrices[next(i)]).m[5];
+  });
+
+  auto b_multiply = benchmark_kernel("Matrix4f::operator*(Matrix4f)", [&](u32 i) {
+    return (matrices[i] * matrices[next(i)]).m[5];
+  });
+
+  auto b_inverse_scalar = benchmark_kernel("Gm_InvertMatrixScalar", [&](u32 i) {
+    return Gm_InvertMatrixScalar(matrices[i]).m[5];
+  });
+
+  auto b_inverse = benchmark_kernel("Matrix4f::inverse", [&](u32 i) {
+    return matrices[i].inverse().m[5];
+  });
+
+  auto b_transpose_scalar = benchmark_kernel("Gm_TransposeMatrixScalar", [&](u32 i) {
+    return Gm_TransposeMatrixScalar(matrices[i]).m[5];
+  });
+
+  auto b_transpose = benchmark_kernel("Matrix4f::transpose", [&](u32 i) {
+    return matrices[i].transpose().m[5];
+  });
+
+  auto b_vector_scalar = benchmark_kernel("Gm_TransformVectorScalar", [&](u32 i) {
+    auto& b = matrices[next(i)];
+
+    return Gm_TransformVectorScalar(matrices[i], Vec3f(b.m[3], b.m[7], b.m[11])).y;
+  });
 
-static uint64 benchmark_2_multiplications() {
+  auto b_vector = benchmark_kernel("Matrix4f::operator*(Vec3f)", [&](u32 i) {
+    auto& b = matrices[next(i)];
+
+    return (matrices[i] * Vec3f(b.m[3], b.m[7], b.m[11])).y;
+  });
+
+  auto b_quaternion_scalar = benchmark_kernel("Gm_MultiplyQuaternionsScalar", [&](u32 i) {
+    return Gm_MultiplyQuaternionsScalar(quaternions[i], quaternions[next(i)]).x;
+  });
+
+  auto b_quaternion = benchmark_kernel("Quaternion::operator*", [&](u32 i) {
+    return (quaternions[i] * quaternions[next(i)]).x;
+  });
+
+  Gm_CompareBenchmarks(b_multiply_scalar, b_multiply);
+  Gm_CompareBenchmarks(b_inverse_scalar, b_inverse);
+  Gm_CompareBenchmarks(b_transpose_scalar, b_transpose);
+  Gm_CompareBenchmarks(b_vector_scalar, b_vector);
+  Gm_CompareBenchmarks(b_quaternion_scalar, b_quaternion);
+}
+
+static u64 benchmark_2_multiplications() {
   Console::log("benchmark_2_multiplications");
 
   struct Transformable {
@@ -18,14 +149,14 @@ static uint64 benchmark_2_multiplications() {
 
   Transformable* transformables = new Transformable[TOTAL_MATRICES];
 
-  for (uint32 i = 0; i < TOTAL_MATRICES; i++) {
+  for (u32 i = 0; i < TOTAL_MATRICES; i++) {
     transformables[i].position = Vec3f(10.0f, 5.0f, 12.3f);
     transformables[i].rotation = Vec3f(-3.6f, 7.9f, 0.035f);
     transformables[i].scale = Vec3f(15.f, 12.3f, 0.8f);
   }
 
-  uint64 time = Gm_RepeatBenchmarkTest([&]() {
-    for (uint32 i = 0; i < TOTAL_MATRICES; i++) {
+  u64 time = Gm_RepeatBenchmarkTest([&]() {
+    for (u32 i = 0; i < TOTAL_MATRICES; i++) {
       auto& transformable = transformables[i];
 
       transformable.matrix = (
@@ -42,7 +173,7 @@ static uint64 benchmark_2_multiplications() {
   return time;
 }
 
-static uint64 benchmark_Matrix4f_transformation() {
+static u64 benchmark_Matrix4f_transformation() {
   Console::log("benchmark_Matrix4f_transformation");
 
   struct Transformable {
@@ -54,20 +185,56 @@ static uint64 benchmark_Matrix4f_transformation() {
 
   Transformable* transformables = new Transformable[TOTAL_MATRICES];
 
-  for (uint32 i = 0; i < TOTAL_MATRICES; i++) {
+  for (u32 i = 0; i < TOTAL_MATRICES; i++) {
     transformables[i].position = Vec3f(10.0f, 5.0f, 12.3f);
     transformables[i].rotation = Vec3f(-3.6f, 7.9f, 0.035f);
     transformables[i].scale = Vec3f(15.f, 12.3f, 0.8f);
   }
 
-  uint64 time = Gm_RepeatBenchmarkTest([&]() {
-    for (uint32 i = 0; i < TOTAL_MATRICES; i++) {
+  u64 time = Gm_RepeatBenchmarkTest([&]() {
+    for (u32 i = 0; i < TOTAL_MATRICES; i++) {
+      auto& transformable = transformables[i];
+
+      transformable.matrix = Matrix4f::transformation(
+        transformable.position,
+        transformable.scale,
+        transformable.rotation
+      ).transpose();
+    }
+  }, TEST_ITERATIONS);
+
+  // Cleanup
+  delete[] transformables;
+
+  return time;
+}
+
+static u64 benchmark_Matrix4f_transformation_quaternion() {
+  Console::log("benchmark_Matrix4f_transformation_quaternion");
+
+  struct Transformable {
+    Vec3f position;
+    Quaternion orientation;
+    Vec3f scale;
+    Matrix4f matrix;
+  };
+
+  Transformable* transformables = new Transformable[TOTAL_MATRICES];
+
+  for (u32 i = 0; i < TOTAL_MATRICES; i++) {
+    transformables[i].position = Vec3f(10.0f, 5.0f, 12.3f);
+    transformables[i].orientation = Quaternion::fromAxisAngle(1.2f, 0.0f, 1.0f, 0.0f);
+    transformables[i].scale = Vec3f(15.f, 12.3f, 0.8f);
+  }
+
+  u64 time = Gm_RepeatBenchmarkTest([&]() {
+    for (u32 i = 0; i < TOTAL_MATRICES; i++) {
       auto& transformable = transformables[i];
 
       transformable.matrix = Matrix4f::transformation(
         transformable.position,
-        transformable.rotation,
-        transformable.scale
+        transformable.scale,
+        transformable.orientation
       ).transpose();
     }
   }, TEST_ITERATIONS);
@@ -79,8 +246,19 @@ static uint64 benchmark_Matrix4f_transformation() {
 }
 
 void benchmark_matrix_multiplication() {
+  benchmark_math_kernels();
+
+  auto b_multiplications = benchmark_2_multiplications();
+  auto b_euler = benchmark_Matrix4f_transformation();
+  auto b_quaternion = benchmark_Matrix4f_transformation_quaternion();
+
+  Gm_CompareBenchmarks(
+    b_multiplications,
+    b_euler
+  );
+
   Gm_CompareBenchmarks(
-    benchmark_2_multiplications(),
-    benchmark_Matrix4f_transformation()
+    b_euler,
+    b_quaternion
   );
 }
\ No newline at end of file
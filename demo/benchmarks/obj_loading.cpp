@@ -0,0 +1,60 @@
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Gamma.h"
+#include "system/ObjLoader.h"
+#include "benchmarks/obj_loading.h"
+
+using namespace Gamma;
+
+constexpr static u32 TOTAL_LOADS = 5;
+constexpr static u32 TOTAL_RUNS = 3;
+
+const static std::vector<std::string> MODEL_PATHS = {
+  "./demo/assets/models/chess-pawn.obj",
+  "./demo/assets/models/chess-king-lod.obj",
+  "./demo/assets/models/lucy-lod.obj",
+  "./demo/assets/models/dragon-lod.obj",
+  "./demo/assets/models/da-vinci.obj"
+};
+
+static u64 getFileSize(const std::string& path) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+  return file.fail() ? 0 : (u64)file.tellg();
+}
+
+/**
+ * Loads a set of demo models repeatedly, and logs the rate
+ * at which .obj data is parsed.
+ */
+static void benchmark_obj_file_loading() {
+  Console::log("benchmark_obj_file_loading");
+
+  u64 totalBytes = 0;
+  u64 totalFaces = 0;
+
+  for (auto& path : MODEL_PATHS) {
+    totalBytes += getFileSize(path);
+  }
+
+  u64 time = Gm_RepeatBenchmarkTest([&]() {
+    for (u32 i = 0; i < TOTAL_LOADS; i++) {
+      for (auto& path : MODEL_PATHS) {
+        ObjLoader obj(path.c_str());
+
+        totalFaces += obj.faces.size();
+      }
+    }
+  }, TOTAL_RUNS);
+
+  float megabytes = (float)(totalBytes * TOTAL_LOADS * TOTAL_RUNS) / (1024.0f * 1024.0f);
+  float seconds = (float)time / 1000.0f;
+
+  Console::log("Megabytes loaded:", megabytes, "Megabytes per second:", seconds > 0.0f ? megabytes / seconds : 0.0f, "Faces:", totalFaces);
+}
+
+void benchmark_obj_loading() {
+  benchmark_obj_file_loading();
+}
\ No newline at end of file
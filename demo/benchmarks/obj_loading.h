@@ -0,0 +1,3 @@
+#pragma once
+
+void benchmark_obj_loading();
\ No newline at end of file
@@ -1,33 +1,34 @@
 #include <vector>
 
 #include "Gamma.h"
+#include "math/simd.h"
 #include "benchmarks/object_management.h"
 
 using namespace Gamma;
 
-constexpr static uint32 TOTAL_MESHES = 100;
-constexpr static uint32 TOTAL_OBJECTS = 100000;
+constexpr static u32 TOTAL_MESHES = 100;
+constexpr static u32 TOTAL_OBJECTS = 100000;
 
-static uint64 benchmark_pointer_object_properties(uint32 iterations) {
+static u64 benchmark_pointer_object_properties(u32 iterations) {
   Console::log("benchmark_pointer_object_properties");
 
   std::vector<Object*> ptr_objects;
 
-  loop(TOTAL_OBJECTS) {
+  for (u32 i = 0; i < TOTAL_OBJECTS; i++) {
     ptr_objects.push_back(new Object());
   }
 
   defer({
-    loop(TOTAL_OBJECTS) {
-      delete ptr_objects[idx];
+    for (u32 i = 0; i < TOTAL_OBJECTS; i++) {
+      delete ptr_objects[i];
     }
 
     ptr_objects.clear();
   });
 
   // Simulate object recycling (memory fragmentation)
-  for (uint32 x = 5; x < 10; x += 2) {
-    for (uint32 i = 0; i < TOTAL_OBJECTS; i += x) {
+  for (u32 x = 5; x < 10; x += 2) {
+    for (u32 i = 0; i < TOTAL_OBJECTS; i += x) {
       delete ptr_objects[i];
 
       ptr_objects[i] = new Object();
@@ -35,8 +36,8 @@ static uint64 benchmark_pointer_object_properties(uint32 iterations) {
   }
 
   return Gm_RepeatBenchmarkTest([&]() {
-    loop(TOTAL_OBJECTS) {
-      auto& object = *ptr_objects[idx];
+    for (u32 i = 0; i < TOTAL_OBJECTS; i++) {
+      auto& object = *ptr_objects[i];
 
       object.position = Vec3f(1.0f, 0.5f, 0.25f);
       object.scale = 20.0f;
@@ -45,21 +46,21 @@ static uint64 benchmark_pointer_object_properties(uint32 iterations) {
   }, iterations);
 }
 
-static uint64 benchmark_pointer_object_matrices(uint32 iterations) {
+static u64 benchmark_pointer_object_matrices(u32 iterations) {
   Console::log("benchmark_pointer_object_matrices");
 
   std::vector<Object*> ptr_objects;
   std::vector<Matrix4f> ptr_matrices;
 
-  loop(TOTAL_OBJECTS) {
+  for (u32 i = 0; i < TOTAL_OBJECTS; i++) {
     ptr_objects.push_back(new Object());
   }
 
   ptr_matrices.resize(TOTAL_OBJECTS);
 
   defer({
-    loop(TOTAL_OBJECTS) {
-      delete ptr_objects[idx];
+    for (u32 i = 0; i < TOTAL_OBJECTS; i++) {
+      delete ptr_objects[i];
     }
 
     ptr_objects.clear();
@@ -67,8 +68,8 @@ static uint64 benchmark_pointer_object_matrices(uint32 iterations) {
   });
 
   // Simulate object recycling (memory fragmentation)
-  for (uint32 x = 5; x < 10; x += 2) {
-    for (uint32 i = 0; i < TOTAL_OBJECTS; i += x) {
+  for (u32 x = 5; x < 10; x += 2) {
+    for (u32 i = 0; i < TOTAL_OBJECTS; i += x) {
       delete ptr_objects[i];
 
       ptr_objects[i] = new Object();
@@ -76,14 +77,14 @@ static uint64 benchmark_pointer_object_matrices(uint32 iterations) {
   }
 
   return Gm_RepeatBenchmarkTest([&]() {
-    loop(TOTAL_OBJECTS) {
-      auto& object = *ptr_objects[idx];
+    for (u32 i = 0; i < TOTAL_OBJECTS; i++) {
+      auto& object = *ptr_objects[i];
 
       object.position = Vec3f(1.0f, 0.5f, 0.25f);
       object.scale = 20.0f;
       object.rotation = Vec3f(0.9f, 2.3f, 1.4f);
 
-      ptr_matrices[idx] = Matrix4f::transformation(
+      ptr_matrices[i] = Matrix4f::transformation(
         object.position,
         object.scale,
         object.rotation
@@ -92,31 +93,31 @@ static uint64 benchmark_pointer_object_matrices(uint32 iterations) {
   }, iterations);
 }
 
-static uint64 benchmark_pool_object_properties(uint32 iterations) {
+static u64 benchmark_pool_object_properties(u32 iterations) {
   Console::log("benchmark_pool_object_properties");
 
   std::vector<ObjectPool*> pools;
 
-  for (uint32 i = 0; i < TOTAL_MESHES; i++) {
+  for (u32 i = 0; i < TOTAL_MESHES; i++) {
     pools.push_back(new ObjectPool());
     pools[i]->reserve(TOTAL_OBJECTS / TOTAL_MESHES);
 
-    for (uint32 j = 0; j < TOTAL_OBJECTS / TOTAL_MESHES; j++) {
+    for (u32 j = 0; j < TOTAL_OBJECTS / TOTAL_MESHES; j++) {
       pools[i]->createObject();
     }
   }
 
   defer({
-    for (uint32 i = 0; i < TOTAL_MESHES; i++) {
+    for (u32 i = 0; i < TOTAL_MESHES; i++) {
       pools[i]->free();
     }
   });
 
   return Gm_RepeatBenchmarkTest([&]() {
-    for (uint32 i = 0; i < TOTAL_MESHES; i++) {
+    for (u32 i = 0; i < TOTAL_MESHES; i++) {
       auto& pool = *pools[i];
 
-      // for (uint32 j = 0; j < pool.total(); j++) {
+      // for (u32 j = 0; j < pool.total(); j++) {
       //   auto& object = *pool.getById(j);
 
       //   object.position = Vec3f(1.0f, 0.5f, 0.25f);
@@ -133,31 +134,31 @@ static uint64 benchmark_pool_object_properties(uint32 iterations) {
   }, iterations);
 }
 
-static uint64 benchmark_pool_object_matrices(uint32 iterations) {
+static u64 benchmark_pool_object_matrices(u32 iterations) {
   Console::log("benchmark_pool_object_matrices");
 
   std::vector<ObjectPool*> pools;
 
-  for (uint32 i = 0; i < TOTAL_MESHES; i++) {
+  for (u32 i = 0; i < TOTAL_MESHES; i++) {
     pools.push_back(new ObjectPool());
     pools[i]->reserve(TOTAL_OBJECTS / TOTAL_MESHES);
 
-    for (uint32 j = 0; j < TOTAL_OBJECTS / TOTAL_MESHES; j++) {
+    for (u32 j = 0; j < TOTAL_OBJECTS / TOTAL_MESHES; j++) {
       pools[i]->createObject();
     }
   }
 
   defer({
-    for (uint32 i = 0; i < TOTAL_MESHES; i++) {
+    for (u32 i = 0; i < TOTAL_MESHES; i++) {
       pools[i]->free();
     }
   });
 
   return Gm_RepeatBenchmarkTest([&]() {
-    for (uint32 i = 0; i < TOTAL_MESHES; i++) {
+    for (u32 i = 0; i < TOTAL_MESHES; i++) {
       auto& pool = *pools[i];
 
-      for (uint32 j = 0; j < pool.totalActive(); j++) {
+      for (u32 j = 0; j < pool.totalActive(); j++) {
         auto& object = *pool.getById(j);
 
         object.position = Vec3f(1.0f, 0.5f, 0.25f);
@@ -174,7 +175,50 @@ static uint64 benchmark_pool_object_matrices(uint32 iterations) {
   }, iterations);
 }
 
-static uint64 benchmark_soa_object_properties(uint32 iterations) {
+static u64 benchmark_pool_stream_matrices(u32 iterations) {
+  Console::log("benchmark_pool_stream_matrices", Gm_GetSimdLevelName(Gm_GetSimdLevel()));
+
+  std::vector<ObjectPool*> pools;
+
+  for (u32 i = 0; i < TOTAL_MESHES; i++) {
+    pools.push_back(new ObjectPool());
+    pools[i]->reserve(TOTAL_OBJECTS / TOTAL_MESHES);
+    pools[i]->useTransformStreams();
+
+    for (u32 j = 0; j < TOTAL_OBJECTS / TOTAL_MESHES; j++) {
+      pools[i]->createObject();
+    }
+  }
+
+  defer({
+    for (u32 i = 0; i < TOTAL_MESHES; i++) {
+      pools[i]->free();
+    }
+  });
+
+  return Gm_RepeatBenchmarkTest([&]() {
+    for (u32 i = 0; i < TOTAL_MESHES; i++) {
+      auto& pool = *pools[i];
+      auto& streams = pool.getTransformStreams();
+
+      for (u32 j = 0; j < pool.totalActive(); j++) {
+        streams.positionX[j] = 1.0f;
+        streams.positionY[j] = 0.5f;
+        streams.positionZ[j] = 0.25f;
+        streams.scaleX[j] = 20.0f;
+        streams.scaleY[j] = 20.0f;
+        streams.scaleZ[j] = 20.0f;
+        streams.rotationX[j] = 0.9f;
+        streams.rotationY[j] = 2.3f;
+        streams.rotationZ[j] = 1.4f;
+      }
+
+      pool.computeMatrices();
+    }
+  }, iterations);
+}
+
+static u64 benchmark_soa_object_properties(u32 iterations) {
   Console::log("benchmark_soa_object_properties");
 
   struct SOA_Objects {
@@ -217,8 +261,8 @@ static uint64 benchmark_soa_object_properties(uint32 iterations) {
     delete[] objects.rz;
   });
 
-  #define setAll(property, value) loop(TOTAL_OBJECTS) {\
-    objects.property[idx] = value;\
+  #define setAll(property, value) for (u32 i = 0; i < TOTAL_OBJECTS; i++) {\
+    objects.property[i] = value;\
   }\
 
   return Gm_RepeatBenchmarkTest([&]() {
@@ -236,7 +280,7 @@ static uint64 benchmark_soa_object_properties(uint32 iterations) {
   }, iterations);
 }
 
-static uint64 benchmark_soa_object_matrices(uint32 iterations) {
+static u64 benchmark_soa_object_matrices(u32 iterations) {
   Console::log("benchmark_soa_object_matrices");
 
   struct SOA_Objects {
@@ -284,8 +328,8 @@ static uint64 benchmark_soa_object_matrices(uint32 iterations) {
     delete[] objects.matrices;
   });
 
-  #define setAll(property, value) loop(TOTAL_OBJECTS) {\
-    objects.property[idx] = value;\
+  #define setAll(property, value) for (u32 i = 0; i < TOTAL_OBJECTS; i++) {\
+    objects.property[i] = value;\
   }\
 
   return Gm_RepeatBenchmarkTest([&]() {
@@ -301,8 +345,8 @@ static uint64 benchmark_soa_object_matrices(uint32 iterations) {
     setAll(ry, 2.3f);
     setAll(rz, 1.4f);
 
-    loop(TOTAL_OBJECTS) {
-      objects.matrices[idx] = Matrix4f::transformation(
+    for (u32 i = 0; i < TOTAL_OBJECTS; i++) {
+      objects.matrices[i] = Matrix4f::transformation(
         Vec3f(1.0f, 0.5f, 0.25f),
         20.0f,
         Vec3f(0.9f, 2.3f, 1.4f)
@@ -329,4 +373,12 @@ void benchmark_object_management() {
     b_pool,
     b_soa
   );
+
+  auto b_pool_matrices = benchmark_pool_object_matrices(1);
+  auto b_pool_streams = benchmark_pool_stream_matrices(1);
+
+  Gm_CompareBenchmarks(
+    b_pool_matrices,
+    b_pool_streams
+  );
 }
\ No newline at end of file
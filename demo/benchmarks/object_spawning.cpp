@@ -0,0 +1,109 @@
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Gamma.h"
+#include "benchmarks/object_spawning.h"
+
+using namespace Gamma;
+
+// Simulate two seconds of debris at 60fps, spawning
+// 50k objects per second which live for one second.
+// Objects aren't committed, since that costs the same
+// either way and would dominate the spawn/despawn time.
+constexpr static u32 TOTAL_FRAMES = 60;
+constexpr static u32 SPAWNS_PER_FRAME = 50000 / TOTAL_FRAMES;
+constexpr static float FALL_PER_FRAME = 1.0f / (float)TOTAL_FRAMES;
+constexpr static u32 TOTAL_MESHES = 100;
+
+static void updateDebris(ObjectPool& pool) {
+  for (auto& object : pool) {
+    object.position.y -= FALL_PER_FRAME;
+  }
+}
+
+static u64 benchmark_individual_spawning(u32 iterations) {
+  Console::log("benchmark_individual_spawning");
+
+  ObjectPool pool;
+  std::vector<u32> expiredIds;
+  std::map<std::string, ObjectPool*> poolMap;
+
+  pool.reserve(SPAWNS_PER_FRAME);
+
+  // Look up the pool by name for each spawned object,
+  // as with Gm_CreateObjectFrom(context, meshName)
+  for (u32 i = 0; i < TOTAL_MESHES; i++) {
+    poolMap.emplace("mesh_" + std::to_string(i), &pool);
+  }
+
+  defer({
+    pool.free();
+  });
+
+  return Gm_RepeatBenchmarkTest([&]() {
+    pool.reset();
+
+    for (u32 frame = 0; frame < TOTAL_FRAMES * 2; frame++) {
+      updateDebris(pool);
+
+      // Objects can't be removed while iterating over the
+      // pool, since removal swaps the last object into place
+      expiredIds.clear();
+
+      for (auto& object : pool) {
+        if (object.position.y < 0.0f) {
+          expiredIds.push_back(object._record.id);
+        }
+      }
+
+      for (auto id : expiredIds) {
+        pool.removeById(id);
+      }
+
+      for (u32 i = 0; i < SPAWNS_PER_FRAME; i++) {
+        auto& object = poolMap.at("mesh_50")->createObject();
+
+        object.position = Vec3f(0.0f, 1.0f, 0.0f);
+      }
+    }
+  }, iterations);
+}
+
+static u64 benchmark_bulk_spawning(u32 iterations) {
+  Console::log("benchmark_bulk_spawning");
+
+  ObjectPool pool;
+
+  pool.reserve(SPAWNS_PER_FRAME);
+
+  defer({
+    pool.free();
+  });
+
+  return Gm_RepeatBenchmarkTest([&]() {
+    pool.reset();
+
+    for (u32 frame = 0; frame < TOTAL_FRAMES * 2; frame++) {
+      updateDebris(pool);
+
+      pool.removeIf([](const Object& object) {
+        return object.position.y < 0.0f;
+      });
+
+      for (auto& object : pool.createObjects(SPAWNS_PER_FRAME)) {
+        object.position = Vec3f(0.0f, 1.0f, 0.0f);
+      }
+    }
+  }, iterations);
+}
+
+void benchmark_object_spawning() {
+  auto b_individual = benchmark_individual_spawning(10);
+  auto b_bulk = benchmark_bulk_spawning(10);
+
+  Gm_CompareBenchmarks(
+    b_individual,
+    b_bulk
+  );
+}
\ No newline at end of file
@@ -0,0 +1,3 @@
+#pragma once
+
+void benchmark_object_spawning();
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "Gamma.h"
+#include "math/batch_transforms.h"
+#include "math/simd.h"
+#include "math/trigonometry.h"
+#include "benchmarks/trigonometry.h"
+
+using namespace Gamma;
+
+constexpr static u32 TOTAL_ANGLES = 1000000;
+constexpr static u32 TOTAL_TRANSFORMS = 100000;
+constexpr static u32 TOTAL_TRANSFORM_PASSES = 20;
+
+static float randomFloat(float low, float high) {
+  return low + (high - low) * ((float)rand() / (float)RAND_MAX);
+}
+
+/**
+ * Sweeps Gm_SinCos() across a range of angles, and logs its
+ * largest error against the (double precision) libm sin/cos,
+ * alongside the largest error of sinf()/cosf().
+ */
+static void verify_sincos(float range) {
+  Console::log("verify_sincos", range);
+
+  double largestError = 0.0;
+  double largestLibmError = 0.0;
+
+  for (u32 i = 0; i <= TOTAL_ANGLES; i++) {
+    float angle = -range + 2.0f * range * ((float)i / (float)TOTAL_ANGLES);
+    double exactSine = sin((double)angle);
+    double exactCosine = cos((double)angle);
+    float sine, cosine;
+
+    Gm_SinCos(angle, sine, cosine);
+
+    largestError = std::max(largestError, std::max(fabs(sine - exactSine), fabs(cosine - exactCosine)));
+    largestLibmError = std::max(largestLibmError, std::max(fabs(sinf(angle) - exactSine), fabs(cosf(angle) - exactCosine)));
+  }
+
+  Console::log("Gm_SinCos error:", (float)largestError, "sinf/cosf error:", (float)largestLibmError);
+}
+
+static u64 benchmark_sincos(bool isFast) {
+  Console::log(isFast ? "benchmark_sincos Gm_SinCos" : "benchmark_sincos sinf/cosf");
+
+  std::vector<float> angles(TOTAL_ANGLES);
+  float sum = 0.0f;
+
+  for (auto& angle : angles) {
+    angle = randomFloat(-Gm_TAU, Gm_TAU);
+  }
+
+  u64 time = Gm_RepeatBenchmarkTest([&]() {
+    for (auto angle : angles) {
+      float sine, cosine;
+
+      if (isFast) {
+        Gm_SinCos(angle, sine, cosine);
+      } else {
+        sine = sinf(angle);
+        cosine = cosf(angle);
+      }
+
+      sum += sine + cosine;
+    }
+  }, 3);
+
+  Console::log("Sum:", sum);
+
+  return time;
+}
+
+/**
+ * Computes transform matrices in bulk, as ObjectPool does
+ * for pools using transform streams.
+ */
+static u64 benchmark_batch_transforms(SimdLevel level, bool isFast) {
+  Gm_SetSimdLevel(level);
+  Gm_SetFastTrigonometry(isFast);
+
+  Console::log("benchmark_batch_transforms", Gm_GetSimdLevelName(Gm_GetSimdLevel()), isFast ? "Gm_SinCos" : "sinf/cosf");
+
+  std::vector<float> values(TOTAL_TRANSFORMS * 9);
+  std::vector<Matrix4f> matrices(TOTAL_TRANSFORMS);
+  TransformStreams streams;
+
+  for (auto& value : values) {
+    value = randomFloat(-Gm_TAU, Gm_TAU);
+  }
+
+  streams.positionX = &values[0];
+  streams.positionY = &values[TOTAL_TRANSFORMS];
+  streams.positionZ = &values[TOTAL_TRANSFORMS * 2];
+  streams.scaleX = &values[TOTAL_TRANSFORMS * 3];
+  streams.scaleY = &values[TOTAL_TRANSFORMS * 4];
+  streams.scaleZ = &values[TOTAL_TRANSFORMS * 5];
+  streams.rotationX = &values[TOTAL_TRANSFORMS * 6];
+  streams.rotationY = &values[TOTAL_TRANSFORMS * 7];
+  streams.rotationZ = &values[TOTAL_TRANSFORMS * 8];
+
+  return Gm_RepeatBenchmarkTest([&]() {
+    for (u32 pass = 0; pass < TOTAL_TRANSFORM_PASSES; pass++) {
+      Gm_ComputeTransformMatrices(streams, matrices.data(), 0, TOTAL_TRANSFORMS);
+    }
+  }, 3);
+}
+
+void benchmark_trigonometry() {
+  verify_sincos(Gm_PI);
+  verify_sincos(8192.0f);
+  verify_sincos(100000.0f);
+
+  auto b_libm = benchmark_sincos(false);
+  auto b_sincos = benchmark_sincos(true);
+
+  Gm_CompareBenchmarks(b_libm, b_sincos);
+
+  SimdLevel levels[] = { SimdLevel::SCALAR, SimdLevel::SSE, SimdLevel::AVX2 };
+
+  for (auto level : levels) {
+    auto b_libm_transforms = benchmark_batch_transforms(level, false);
+    auto b_fast_transforms = benchmark_batch_transforms(level, true);
+
+    Gm_CompareBenchmarks(b_libm_transforms, b_fast_transforms);
+  }
+
+  // Restore the defaults
+  Gm_SetSimdLevel(SimdLevel::AVX2);
+  Gm_SetFastTrigonometry(true);
+}
\ No newline at end of file
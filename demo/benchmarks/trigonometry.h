@@ -0,0 +1,3 @@
+#pragma once
+
+void benchmark_trigonometry();
\ No newline at end of file
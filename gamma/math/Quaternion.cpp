@@ -4,15 +4,25 @@
 #include "math/matrix.h"
 #include "math/orientation.h"
 #include "math/Quaternion.h"
+#include "math/simd.h"
+#include "math/trigonometry.h"
 #include "math/utilities.h"
 #include "math/vector.h"
 
 namespace Gamma {
   Quaternion Quaternion::fromAxisAngle(float angle, float x, float y, float z) {
-    float sa = sinf(angle / 2.0f);
+    float sa;
+    float ca;
+
+    if (Gm_IsFastTrigonometryEnabled()) {
+      Gm_SinCos(angle / 2.0f, sa, ca);
+    } else {
+      sa = sinf(angle / 2.0f);
+      ca = cosf(angle / 2.0f);
+    }
 
     return {
-      cosf(angle / 2.0f),
+      ca,
       x * sa,
       y * sa,
       z * sa
@@ -68,13 +78,35 @@ namespace Gamma {
     return r.unit();
   }
 
+  /**
+   * Multiplies all four components at once, as one term per
+   * component of this quaternion, with the other quaternion's
+   * components shuffled and negated to match. Terms are summed
+   * in the same order as Gm_MultiplyQuaternionsScalar(), so
+   * results match.
+   */
   Quaternion Quaternion::operator*(const Quaternion& q2) const {
-    return {
-      w * q2.w - x * q2.x - y * q2.y - z * q2.z,
-      w * q2.x + x * q2.w + y * q2.z - z * q2.y,
-      w * q2.y - x * q2.z + y * q2.w + z * q2.x,
-      w * q2.z + x * q2.y - y * q2.x + z * q2.w
-    };
+    #if GAMMA_SIMD_X86
+      // Components are stored as (w, x, y, z)
+      __m128 a = _mm_loadu_ps(&w);
+      __m128 b = _mm_loadu_ps(&q2.w);
+      __m128 wTerm = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)), b);
+      __m128 xTerm = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1)));
+      __m128 yTerm = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2)));
+      __m128 zTerm = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 1, 2, 3)));
+
+      xTerm = _mm_xor_ps(xTerm, _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f));
+      yTerm = _mm_xor_ps(yTerm, _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f));
+      zTerm = _mm_xor_ps(zTerm, _mm_setr_ps(-0.0f, -0.0f, 0.0f, 0.0f));
+
+      Quaternion product;
+
+      _mm_storeu_ps(&product.w, _mm_add_ps(_mm_add_ps(_mm_add_ps(wTerm, xTerm), yTerm), zTerm));
+
+      return product;
+    #else
+      return Gm_MultiplyQuaternionsScalar(*this, q2);
+    #endif
   }
 
   void Quaternion::operator*=(const Quaternion& q2) {
@@ -109,11 +141,29 @@ namespace Gamma {
     *this *= rotation;
   }
 
+  /**
+   * Shares the doubled products between terms, computing 12
+   * products rather than 24. Doubling is exact, so results
+   * match the unshared expressions.
+   */
   Matrix4f Quaternion::toMatrix4f() const {
+    float x2 = x + x;
+    float y2 = y + y;
+    float z2 = z + z;
+    float xx = x * x2;
+    float yy = y * y2;
+    float zz = z * z2;
+    float xy = x * y2;
+    float xz = x * z2;
+    float yz = y * z2;
+    float wx = w * x2;
+    float wy = w * y2;
+    float wz = w * z2;
+
     return {
-      1 - 2 * y * y - 2 * z * z, 2 * x * y - 2 * z * w, 2 * x * z + 2 * y * w, 0.0f,
-      2 * x * y + 2 * z * w, 1 - 2 * x * x - 2 * z * z, 2 * y * z - 2 * x * w, 0.0f,
-      2 * x * z - 2 * y * w, 2 * y * z + 2 * x * w, 1 - 2 * x * x - 2 * y * y, 0.0f,
+      1 - yy - zz, xy - wz, xz + wy, 0.0f,
+      xy + wz, 1 - xx - zz, yz - wx, 0.0f,
+      xz - wy, yz + wx, 1 - xx - yy, 0.0f,
       0.0f, 0.0f, 0.0f, 1.0f
     };
   }
@@ -128,4 +178,13 @@ namespace Gamma {
       z / magnitude
     };
   }
+
+  Quaternion Gm_MultiplyQuaternionsScalar(const Quaternion& q1, const Quaternion& q2) {
+    return {
+      q1.w * q2.w - q1.x * q2.x - q1.y * q2.y - q1.z * q2.z,
+      q1.w * q2.x + q1.x * q2.w + q1.y * q2.z - q1.z * q2.y,
+      q1.w * q2.y - q1.x * q2.z + q1.y * q2.w + q1.z * q2.x,
+      q1.w * q2.z + q1.x * q2.y - q1.y * q2.x + q1.z * q2.w
+    };
+  }
 }
\ No newline at end of file
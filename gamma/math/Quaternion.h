@@ -29,4 +29,10 @@ namespace Gamma {
     Matrix4f toMatrix4f() const;
     Quaternion unit() const;
   };
+
+  /**
+   * Scalar reference implementation of Quaternion::operator*(),
+   * for verifying SIMD results and for benchmarks.
+   */
+  Quaternion Gm_MultiplyQuaternionsScalar(const Quaternion& q1, const Quaternion& q2);
 }
\ No newline at end of file
@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "math/batch_culling.h"
+#include "math/simd.h"
+
+namespace Gamma {
+  /**
+   * Computes the visibility bits of spheres [start, end), with
+   * sphere 'start' in the lowest bit. At most 32 spheres can be
+   * tested at once.
+   */
+  inline static u32 computeVisibilityWordScalar(const Frustum& frustum, const BoundsStreams& bounds, u32 start, u32 end) {
+    u32 word = 0;
+
+    for (u32 i = start; i < end; i++) {
+      Vec3f center(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]);
+
+      if (frustum.isSphereVisible(center, bounds.radius[i])) {
+        word |= 1U << (i - start);
+      }
+    }
+
+    return word;
+  }
+
+  /**
+   * Computes the slack of spheres [start, end). Plane distances
+   * are summed and compared in the same order as the SIMD
+   * kernels, so every kernel produces identical results.
+   */
+  inline static void computeSlackScalar(const Frustum& frustum, const BoundsStreams& bounds, float* slack, u32 start, u32 end) {
+    for (u32 i = start; i < end; i++) {
+      float minimum = FLT_MAX;
+
+      for (u32 p = 0; p < 6; p++) {
+        auto& plane = frustum.planes[p];
+        float distance = plane.normal.x * bounds.centerX[i] + plane.normal.y * bounds.centerY[i] + plane.normal.z * bounds.centerZ[i] + plane.distance;
+
+        minimum = distance < minimum ? distance : minimum;
+      }
+
+      slack[i] = minimum + bounds.radius[i];
+    }
+  }
+
+  void Gm_ComputeSphereSlack(const Frustum& frustum, const BoundsStreams& bounds, float* slack, u32 total) {
+    switch (Gm_GetSimdLevel()) {
+      case SimdLevel::AVX2:
+        Gm_ComputeSphereSlackAVX2(frustum, bounds, slack, total);
+        break;
+      case SimdLevel::SSE:
+        Gm_ComputeSphereSlackSSE(frustum, bounds, slack, total);
+        break;
+      default:
+        Gm_ComputeSphereSlackScalar(frustum, bounds, slack, total);
+        break;
+    }
+  }
+
+  void Gm_ComputeSphereSlackScalar(const Frustum& frustum, const BoundsStreams& bounds, float* slack, u32 total) {
+    computeSlackScalar(frustum, bounds, slack, 0, total);
+  }
+
+  void Gm_ComputeSphereVisibility(const Frustum& frustum, const BoundsStreams& bounds, u32* masks, u32 total) {
+    switch (Gm_GetSimdLevel()) {
+      case SimdLevel::AVX2:
+        Gm_ComputeSphereVisibilityAVX2(frustum, bounds, masks, total);
+        break;
+      case SimdLevel::SSE:
+        Gm_ComputeSphereVisibilitySSE(frustum, bounds, masks, total);
+        break;
+      default:
+        Gm_ComputeSphereVisibilityScalar(frustum, bounds, masks, total);
+        break;
+    }
+  }
+
+  void Gm_ComputeSphereVisibilityScalar(const Frustum& frustum, const BoundsStreams& bounds, u32* masks, u32 total) {
+    for (u32 i = 0; i < total; i += 32) {
+      u32 end = i + 32 < total ? i + 32 : total;
+
+      masks[i / 32] = computeVisibilityWordScalar(frustum, bounds, i, end);
+    }
+  }
+
+  void Gm_ComputeSphereProximity(const Vec3f& origin, float range, const BoundsStreams& bounds, u32* masks, u32 total) {
+    for (u32 i = 0; i < total; i += 32) {
+      u32 end = i + 32 < total ? i + 32 : total;
+      u32 word = 0;
+
+      for (u32 j = i; j < end; j++) {
+        float dx = bounds.centerX[j] - origin.x;
+        float dy = bounds.centerY[j] - origin.y;
+        float dz = bounds.centerZ[j] - origin.z;
+        float limit = range + bounds.radius[j];
+
+        word |= u32(dx * dx + dy * dy + dz * dz <= limit * limit) << (j - i);
+      }
+
+      masks[i / 32] = word;
+    }
+  }
+
+  float Gm_GetSpotLightHalfAngle(float fov) {
+    float coneAlignment = std::max(-1.0f, std::min(1.0f, 1.0f - fov / 180.0f));
+
+    return acosf(coneAlignment);
+  }
+
+  void Gm_ComputeSphereConeVisibility(const Vec3f& origin, const Vec3f& direction, float halfAngle, float range, const BoundsStreams& bounds, u32* masks, u32 total) {
+    float sine = sinf(halfAngle);
+    float cosine = cosf(halfAngle);
+    // Cones wider than a hemisphere reach behind their apex
+    bool isWideCone = cosine < 0.0f;
+
+    for (u32 i = 0; i < total; i += 32) {
+      u32 end = i + 32 < total ? i + 32 : total;
+      u32 word = 0;
+
+      for (u32 j = i; j < end; j++) {
+        float dx = bounds.centerX[j] - origin.x;
+        float dy = bounds.centerY[j] - origin.y;
+        float dz = bounds.centerZ[j] - origin.z;
+        float radius = bounds.radius[j];
+        float limit = range + radius;
+        float distanceSquared = dx * dx + dy * dy + dz * dz;
+        // Distance along the cone axis, and from the axis
+        float axial = dx * direction.x + dy * direction.y + dz * direction.z;
+        float lateral = sqrtf(std::max(distanceSquared - axial * axial, 0.0f));
+        // Distance from the sphere center to the side of the cone
+        float side = cosine * lateral - sine * axial;
+
+        bool isVisible = isWideCone
+          ? distanceSquared <= limit * limit && side <= radius
+          : axial >= -radius && axial <= limit && side <= radius;
+
+        word |= u32(isVisible) << (j - i);
+      }
+
+      masks[i / 32] = word;
+    }
+  }
+
+  #if GAMMA_SIMD_X86
+    /**
+     * Returns a 4-bit mask of which of 4 spheres are visible.
+     * Spheres are culled when they are entirely behind any one
+     * plane, using the same comparison as isSphereVisible(),
+     * so NaN bounds are treated as visible.
+     */
+    inline static u32 computeVisibilityBitsSSE(const Frustum& frustum, const BoundsStreams& bounds, u32 offset) {
+      __m128 x = _mm_loadu_ps(&bounds.centerX[offset]);
+      __m128 y = _mm_loadu_ps(&bounds.centerY[offset]);
+      __m128 z = _mm_loadu_ps(&bounds.centerZ[offset]);
+      __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&bounds.radius[offset]));
+      __m128 culled = _mm_setzero_ps();
+
+      for (u32 p = 0; p < 6; p++) {
+        auto& plane = frustum.planes[p];
+
+        __m128 distance = _mm_add_ps(
+          _mm_add_ps(
+            _mm_add_ps(
+              _mm_mul_ps(_mm_set1_ps(plane.normal.x), x),
+              _mm_mul_ps(_mm_set1_ps(plane.normal.y), y)
+            ),
+            _mm_mul_ps(_mm_set1_ps(plane.normal.z), z)
+          ),
+          _mm_set1_ps(plane.distance)
+        );
+
+        culled = _mm_or_ps(culled, _mm_cmplt_ps(distance, negativeRadius));
+      }
+
+      return ~_mm_movemask_ps(culled) & 0xF;
+    }
+
+    void Gm_ComputeSphereVisibilitySSE(const Frustum& frustum, const BoundsStreams& bounds, u32* masks, u32 total) {
+      u32 i = 0;
+
+      for (; i + 32 <= total; i += 32) {
+        u32 word = 0;
+
+        for (u32 j = 0; j < 32; j += 4) {
+          word |= computeVisibilityBitsSSE(frustum, bounds, i + j) << j;
+        }
+
+        masks[i / 32] = word;
+      }
+
+      if (i < total) {
+        masks[i / 32] = computeVisibilityWordScalar(frustum, bounds, i, total);
+      }
+    }
+
+    /**
+     * Returns an 8-bit mask of which of 8 spheres are visible,
+     * given plane coefficients broadcast across 8 lanes.
+     */
+    GAMMA_TARGET_AVX2 inline static u32 computeVisibilityBitsAVX2(const __m256 (&planes)[6][4], const BoundsStreams& bounds, u32 offset) {
+      __m256 x = _mm256_loadu_ps(&bounds.centerX[offset]);
+      __m256 y = _mm256_loadu_ps(&bounds.centerY[offset]);
+      __m256 z = _mm256_loadu_ps(&bounds.centerZ[offset]);
+      __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&bounds.radius[offset]));
+      __m256 culled = _mm256_setzero_ps();
+
+      for (u32 p = 0; p < 6; p++) {
+        __m256 distance = _mm256_add_ps(
+          _mm256_add_ps(
+            _mm256_add_ps(
+              _mm256_mul_ps(planes[p][0], x),
+              _mm256_mul_ps(planes[p][1], y)
+            ),
+            _mm256_mul_ps(planes[p][2], z)
+          ),
+          planes[p][3]
+        );
+
+        culled = _mm256_or_ps(culled, _mm256_cmp_ps(distance, negativeRadius, _CMP_LT_OQ));
+      }
+
+      return ~_mm256_movemask_ps(culled) & 0xFF;
+    }
+
+    GAMMA_TARGET_AVX2 void Gm_ComputeSphereVisibilityAVX2(const Frustum& frustum, const BoundsStreams& bounds, u32* masks, u32 total) {
+      __m256 planes[6][4];
+
+      for (u32 p = 0; p < 6; p++) {
+        auto& plane = frustum.planes[p];
+
+        planes[p][0] = _mm256_set1_ps(plane.normal.x);
+        planes[p][1] = _mm256_set1_ps(plane.normal.y);
+        planes[p][2] = _mm256_set1_ps(plane.normal.z);
+        planes[p][3] = _mm256_set1_ps(plane.distance);
+      }
+
+      u32 i = 0;
+
+      for (; i + 32 <= total; i += 32) {
+        masks[i / 32] = (
+          computeVisibilityBitsAVX2(planes, bounds, i) |
+          computeVisibilityBitsAVX2(planes, bounds, i + 8) << 8 |
+          computeVisibilityBitsAVX2(planes, bounds, i + 16) << 16 |
+          computeVisibilityBitsAVX2(planes, bounds, i + 24) << 24
+        );
+      }
+
+      _mm256_zeroupper();
+
+      if (i < total) {
+        masks[i / 32] = computeVisibilityWordScalar(frustum, bounds, i, total);
+      }
+    }
+
+    void Gm_ComputeSphereSlackSSE(const Frustum& frustum, const BoundsStreams& bounds, float* slack, u32 total) {
+      u32 i = 0;
+
+      for (; i + 4 <= total; i += 4) {
+        __m128 x = _mm_loadu_ps(&bounds.centerX[i]);
+        __m128 y = _mm_loadu_ps(&bounds.centerY[i]);
+        __m128 z = _mm_loadu_ps(&bounds.centerZ[i]);
+        __m128 minimum = _mm_set1_ps(FLT_MAX);
+
+        for (u32 p = 0; p < 6; p++) {
+          auto& plane = frustum.planes[p];
+
+          __m128 distance = _mm_add_ps(
+            _mm_add_ps(
+              _mm_add_ps(
+                _mm_mul_ps(_mm_set1_ps(plane.normal.x), x),
+                _mm_mul_ps(_mm_set1_ps(plane.normal.y), y)
+              ),
+              _mm_mul_ps(_mm_set1_ps(plane.normal.z), z)
+            ),
+            _mm_set1_ps(plane.distance)
+          );
+
+          minimum = _mm_min_ps(distance, minimum);
+        }
+
+        _mm_storeu_ps(&slack[i], _mm_add_ps(minimum, _mm_loadu_ps(&bounds.radius[i])));
+      }
+
+      computeSlackScalar(frustum, bounds, slack, i, total);
+    }
+
+    GAMMA_TARGET_AVX2 void Gm_ComputeSphereSlackAVX2(const Frustum& frustum, const BoundsStreams& bounds, float* slack, u32 total) {
+      __m256 planes[6][4];
+
+      for (u32 p = 0; p < 6; p++) {
+        auto& plane = frustum.planes[p];
+
+        planes[p][0] = _mm256_set1_ps(plane.normal.x);
+        planes[p][1] = _mm256_set1_ps(plane.normal.y);
+        planes[p][2] = _mm256_set1_ps(plane.normal.z);
+        planes[p][3] = _mm256_set1_ps(plane.distance);
+      }
+
+      u32 i = 0;
+
+      for (; i + 8 <= total; i += 8) {
+        __m256 x = _mm256_loadu_ps(&bounds.centerX[i]);
+        __m256 y = _mm256_loadu_ps(&bounds.centerY[i]);
+        __m256 z = _mm256_loadu_ps(&bounds.centerZ[i]);
+        __m256 minimum = _mm256_set1_ps(FLT_MAX);
+
+        for (u32 p = 0; p < 6; p++) {
+          __m256 distance = _mm256_add_ps(
+            _mm256_add_ps(
+              _mm256_add_ps(
+                _mm256_mul_ps(planes[p][0], x),
+                _mm256_mul_ps(planes[p][1], y)
+              ),
+              _mm256_mul_ps(planes[p][2], z)
+            ),
+            planes[p][3]
+          );
+
+          minimum = _mm256_min_ps(distance, minimum);
+        }
+
+        _mm256_storeu_ps(&slack[i], _mm256_add_ps(minimum, _mm256_loadu_ps(&bounds.radius[i])));
+      }
+
+      _mm256_zeroupper();
+
+      computeSlackScalar(frustum, bounds, slack, i, total);
+    }
+  #else
+    void Gm_ComputeSphereSlackSSE(const Frustum& frustum, const BoundsStreams& bounds, float* slack, u32 total) {
+      Gm_ComputeSphereSlackScalar(frustum, bounds, slack, total);
+    }
+
+    void Gm_ComputeSphereSlackAVX2(const Frustum& frustum, const BoundsStreams& bounds, float* slack, u32 total) {
+      Gm_ComputeSphereSlackScalar(frustum, bounds, slack, total);
+    }
+
+    void Gm_ComputeSphereVisibilitySSE(const Frustum& frustum, const BoundsStreams& bounds, u32* masks, u32 total) {
+      Gm_ComputeSphereVisibilityScalar(frustum, bounds, masks, total);
+    }
+
+    void Gm_ComputeSphereVisibilityAVX2(const Frustum& frustum, const BoundsStreams& bounds, u32* masks, u32 total) {
+      Gm_ComputeSphereVisibilityScalar(frustum, bounds, masks, total);
+    }
+  #endif
+}
\ No newline at end of file
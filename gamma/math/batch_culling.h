@@ -0,0 +1,91 @@
+#pragma once
+
+#include "math/frustum.h"
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * BoundsStreams
+   * -------------
+   *
+   * Structure-of-arrays bounding spheres for a set of objects,
+   * with one stream per center component and the radius. Used
+   * to cull objects in bulk, several spheres at a time.
+   */
+  struct BoundsStreams {
+    float* centerX = nullptr;
+    float* centerY = nullptr;
+    float* centerZ = nullptr;
+    float* radius = nullptr;
+  };
+
+  /**
+   * Returns the number of u32 words needed to store one
+   * visibility bit for each of a given number of spheres.
+   */
+  inline u32 Gm_GetVisibilityMaskSize(u32 total) {
+    return (total + 31) / 32;
+  }
+
+  /**
+   * Tests spheres [0, total) against all six planes of a frustum,
+   * setting bit (i % 32) of masks[i / 32] for each visible sphere
+   * i and clearing it otherwise. Equivalent to:
+   *
+   *   frustum.isSphereVisible(center, radius)
+   *
+   * for each sphere. Dispatches to the widest kernel supported
+   * by the CPU.
+   */
+  void Gm_ComputeSphereVisibility(const Frustum& frustum, const BoundsStreams& bounds, u32* masks, u32 total);
+
+  /**
+   * Writes the slack of spheres [0, total) against a frustum:
+   * the distance by which each sphere clears the frustum plane
+   * it's closest to being culled by. Spheres with negative
+   * slack are outside the frustum. Equivalent to:
+   *
+   *   min(dot(plane.normal, center) + plane.distance) + radius
+   *
+   * over the six planes, for each sphere. Dispatches to the
+   * widest kernel supported by the CPU.
+   */
+  void Gm_ComputeSphereSlack(const Frustum& frustum, const BoundsStreams& bounds, float* slack, u32 total);
+
+  /**
+   * Sets the visibility bits of spheres [0, total) which are
+   * within a range of a point, as with a point light, and
+   * clears them otherwise.
+   */
+  void Gm_ComputeSphereProximity(const Vec3f& origin, float range, const BoundsStreams& bounds, u32* masks, u32 total);
+
+  /**
+   * Returns the half angle, in radians, of the cone lit by a
+   * spot light with a given field of view in degrees, matching
+   * the cone edge in the spot light shader. Fields of view
+   * past 180 degrees have half angles past PI / 2, with cones
+   * reaching behind the light.
+   */
+  float Gm_GetSpotLightHalfAngle(float fov);
+
+  /**
+   * Sets the visibility bits of spheres [0, total) which touch
+   * a cone, as with a spot light, and clears them otherwise.
+   * The cone has its apex at the origin, extends a range along
+   * a unit direction, and has a half angle in radians. Spheres
+   * are culled when they're past the range, outside the cone's
+   * side, or (for half angles up to PI / 2) behind the apex.
+   */
+  void Gm_ComputeSphereConeVisibility(const Vec3f& origin, const Vec3f& direction, float halfAngle, float range, const BoundsStreams& bounds, u32* masks, u32 total);
+
+  /**
+   * Individual kernels, exposed for benchmarking and for
+   * verifying SIMD kernels against the scalar one.
+   */
+  void Gm_ComputeSphereVisibilityScalar(const Frustum& frustum, const BoundsStreams& bounds, u32* masks, u32 total);
+  void Gm_ComputeSphereVisibilitySSE(const Frustum& frustum, const BoundsStreams& bounds, u32* masks, u32 total);
+  void Gm_ComputeSphereVisibilityAVX2(const Frustum& frustum, const BoundsStreams& bounds, u32* masks, u32 total);
+  void Gm_ComputeSphereSlackScalar(const Frustum& frustum, const BoundsStreams& bounds, float* slack, u32 total);
+  void Gm_ComputeSphereSlackSSE(const Frustum& frustum, const BoundsStreams& bounds, float* slack, u32 total);
+  void Gm_ComputeSphereSlackAVX2(const Frustum& frustum, const BoundsStreams& bounds, float* slack, u32 total);
+}
\ No newline at end of file
@@ -0,0 +1,362 @@
+#include <cmath>
+
+#include "math/batch_transforms.h"
+#include "math/simd.h"
+#include "math/trigonometry.h"
+
+namespace Gamma {
+  /**
+   * Computes the sines and cosines of a batch of half-angles,
+   * which are needed to build rotation quaternions.
+   */
+  inline static void computeHalfAngles(const float* angles, float* sines, float* cosines, u32 total) {
+    if (Gm_IsFastTrigonometryEnabled()) {
+      for (u32 i = 0; i < total; i++) {
+        Gm_SinCos(angles[i] * 0.5f, sines[i], cosines[i]);
+      }
+    } else {
+      for (u32 i = 0; i < total; i++) {
+        float halfAngle = angles[i] * 0.5f;
+
+        sines[i] = sinf(halfAngle);
+        cosines[i] = cosf(halfAngle);
+      }
+    }
+  }
+
+  void Gm_ComputeTransformMatrices(const TransformStreams& streams, Matrix4f* matrices, u32 start, u32 end) {
+    switch (Gm_GetSimdLevel()) {
+      case SimdLevel::AVX2:
+        Gm_ComputeTransformMatricesAVX2(streams, matrices, start, end);
+        break;
+      case SimdLevel::SSE:
+        Gm_ComputeTransformMatricesSSE(streams, matrices, start, end);
+        break;
+      default:
+        Gm_ComputeTransformMatricesScalar(streams, matrices, start, end);
+        break;
+    }
+  }
+
+  /**
+   * Builds the rotation quaternion (roll * pitch * yaw) for an
+   * object, as in Matrix4f::rotation(), and writes out its
+   * transposed transformation matrix.
+   */
+  void Gm_ComputeTransformMatrix(const Vec3f& position, const Vec3f& scale, const Vec3f& rotation, Matrix4f& matrix) {
+    float sx, cx, sy, cy, sz, cz;
+
+    computeHalfAngles(&rotation.x, &sx, &cx, 1);
+    computeHalfAngles(&rotation.y, &sy, &cy, 1);
+    computeHalfAngles(&rotation.z, &sz, &cz, 1);
+
+    // roll * pitch
+    float aw = cz * cx;
+    float ax = cz * sx;
+    float ay = sz * sx;
+    float az = sz * cx;
+
+    // (roll * pitch) * yaw
+    Quaternion q = {
+      aw * cy - ay * sy,
+      ax * cy - az * sy,
+      aw * sy + ay * cy,
+      ax * sy + az * cy
+    };
+
+    Gm_ComputeTransformMatrix(position, scale, q, matrix);
+  }
+
+  /**
+   * Writes out the rotation matrix of a quaternion with each
+   * column multiplied by its scale factor, followed by the
+   * translation column.
+   */
+  void Gm_ComputeTransformMatrix(const Vec3f& position, const Vec3f& scale, const Quaternion& rotation, Matrix4f& matrix) {
+    float w = rotation.w;
+    float x = rotation.x;
+    float y = rotation.y;
+    float z = rotation.z;
+
+    float x2 = x + x;
+    float y2 = y + y;
+    float z2 = z + z;
+    float xx = x * x2;
+    float yy = y * y2;
+    float zz = z * z2;
+    float xy = x * y2;
+    float xz = x * z2;
+    float yz = y * z2;
+    float wx = w * x2;
+    float wy = w * y2;
+    float wz = w * z2;
+
+    float* m = matrix.m;
+
+    m[0] = (1.0f - (yy + zz)) * scale.x;
+    m[1] = (xy + wz) * scale.x;
+    m[2] = (xz - wy) * scale.x;
+    m[3] = 0.0f;
+
+    m[4] = (xy - wz) * scale.y;
+    m[5] = (1.0f - (xx + zz)) * scale.y;
+    m[6] = (yz + wx) * scale.y;
+    m[7] = 0.0f;
+
+    m[8] = (xz + wy) * scale.z;
+    m[9] = (yz - wx) * scale.z;
+    m[10] = (1.0f - (xx + yy)) * scale.z;
+    m[11] = 0.0f;
+
+    m[12] = position.x;
+    m[13] = position.y;
+    m[14] = position.z;
+    m[15] = 1.0f;
+  }
+
+  void Gm_ComputeTransformMatricesScalar(const TransformStreams& streams, Matrix4f* matrices, u32 start, u32 end) {
+    for (u32 i = start; i < end; i++) {
+      Gm_ComputeTransformMatrix(
+        Vec3f(streams.positionX[i], streams.positionY[i], streams.positionZ[i]),
+        Vec3f(streams.scaleX[i], streams.scaleY[i], streams.scaleZ[i]),
+        Vec3f(streams.rotationX[i], streams.rotationY[i], streams.rotationZ[i]),
+        matrices[i]
+      );
+    }
+  }
+
+  #if GAMMA_SIMD_X86
+    /**
+     * Transposes 4 column vectors of 4 objects each, and stores
+     * them at a given float offset in 4 consecutive matrices.
+     */
+    inline static void storeColumnsSSE(Matrix4f* matrices, u32 offset, __m128 a, __m128 b, __m128 c, __m128 d) {
+      _MM_TRANSPOSE4_PS(a, b, c, d);
+
+      _mm_storeu_ps(&matrices[0].m[offset], a);
+      _mm_storeu_ps(&matrices[1].m[offset], b);
+      _mm_storeu_ps(&matrices[2].m[offset], c);
+      _mm_storeu_ps(&matrices[3].m[offset], d);
+    }
+
+    /**
+     * Computes the sines and cosines of 4 half-angles.
+     */
+    inline static void computeHalfAnglesSSE(const float* angles, __m128& sines, __m128& cosines) {
+      if (Gm_IsFastTrigonometryEnabled()) {
+        Gm_SinCosSSE(_mm_mul_ps(_mm_loadu_ps(angles), _mm_set1_ps(0.5f)), sines, cosines);
+      } else {
+        alignas(16) float s[4];
+        alignas(16) float c[4];
+
+        computeHalfAngles(angles, s, c, 4);
+
+        sines = _mm_load_ps(s);
+        cosines = _mm_load_ps(c);
+      }
+    }
+
+    void Gm_ComputeTransformMatricesSSE(const TransformStreams& streams, Matrix4f* matrices, u32 start, u32 end) {
+      const __m128 one = _mm_set1_ps(1.0f);
+      const __m128 zero = _mm_setzero_ps();
+      u32 i = start;
+
+      for (; i + 4 <= end; i += 4) {
+        __m128 sx, cx, sy, cy, sz, cz;
+
+        computeHalfAnglesSSE(&streams.rotationX[i], sx, cx);
+        computeHalfAnglesSSE(&streams.rotationY[i], sy, cy);
+        computeHalfAnglesSSE(&streams.rotationZ[i], sz, cz);
+
+        // roll * pitch
+        __m128 aw = _mm_mul_ps(cz, cx);
+        __m128 ax = _mm_mul_ps(cz, sx);
+        __m128 ay = _mm_mul_ps(sz, sx);
+        __m128 az = _mm_mul_ps(sz, cx);
+
+        // (roll * pitch) * yaw
+        __m128 w = _mm_sub_ps(_mm_mul_ps(aw, cy), _mm_mul_ps(ay, sy));
+        __m128 x = _mm_sub_ps(_mm_mul_ps(ax, cy), _mm_mul_ps(az, sy));
+        __m128 y = _mm_add_ps(_mm_mul_ps(aw, sy), _mm_mul_ps(ay, cy));
+        __m128 z = _mm_add_ps(_mm_mul_ps(ax, sy), _mm_mul_ps(az, cy));
+
+        __m128 x2 = _mm_add_ps(x, x);
+        __m128 y2 = _mm_add_ps(y, y);
+        __m128 z2 = _mm_add_ps(z, z);
+        __m128 xx = _mm_mul_ps(x, x2);
+        __m128 yy = _mm_mul_ps(y, y2);
+        __m128 zz = _mm_mul_ps(z, z2);
+        __m128 xy = _mm_mul_ps(x, y2);
+        __m128 xz = _mm_mul_ps(x, z2);
+        __m128 yz = _mm_mul_ps(y, z2);
+        __m128 wx = _mm_mul_ps(w, x2);
+        __m128 wy = _mm_mul_ps(w, y2);
+        __m128 wz = _mm_mul_ps(w, z2);
+
+        __m128 scaleX = _mm_loadu_ps(&streams.scaleX[i]);
+        __m128 scaleY = _mm_loadu_ps(&streams.scaleY[i]);
+        __m128 scaleZ = _mm_loadu_ps(&streams.scaleZ[i]);
+
+        storeColumnsSSE(&matrices[i], 0,
+          _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), scaleX),
+          _mm_mul_ps(_mm_add_ps(xy, wz), scaleX),
+          _mm_mul_ps(_mm_sub_ps(xz, wy), scaleX),
+          zero
+        );
+
+        storeColumnsSSE(&matrices[i], 4,
+          _mm_mul_ps(_mm_sub_ps(xy, wz), scaleY),
+          _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), scaleY),
+          _mm_mul_ps(_mm_add_ps(yz, wx), scaleY),
+          zero
+        );
+
+        storeColumnsSSE(&matrices[i], 8,
+          _mm_mul_ps(_mm_add_ps(xz, wy), scaleZ),
+          _mm_mul_ps(_mm_sub_ps(yz, wx), scaleZ),
+          _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), scaleZ),
+          zero
+        );
+
+        storeColumnsSSE(&matrices[i], 12,
+          _mm_loadu_ps(&streams.positionX[i]),
+          _mm_loadu_ps(&streams.positionY[i]),
+          _mm_loadu_ps(&streams.positionZ[i]),
+          one
+        );
+      }
+
+      Gm_ComputeTransformMatricesScalar(streams, matrices, i, end);
+    }
+
+    /**
+     * Transposes 8 column vectors of 8 objects each (two columns
+     * per object), and stores them at a given float offset in 8
+     * consecutive matrices.
+     */
+    GAMMA_TARGET_AVX2 inline static void storeColumnPairsAVX2(Matrix4f* matrices, u32 offset, __m256 r0, __m256 r1, __m256 r2, __m256 r3, __m256 r4, __m256 r5, __m256 r6, __m256 r7) {
+      __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+      __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+      __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+      __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+      __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+      __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+      __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+      __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+
+      __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+      __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+      __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+      __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+      __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+      __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+      __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+      __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+      _mm256_storeu_ps(&matrices[0].m[offset], _mm256_permute2f128_ps(s0, s4, 0x20));
+      _mm256_storeu_ps(&matrices[1].m[offset], _mm256_permute2f128_ps(s1, s5, 0x20));
+      _mm256_storeu_ps(&matrices[2].m[offset], _mm256_permute2f128_ps(s2, s6, 0x20));
+      _mm256_storeu_ps(&matrices[3].m[offset], _mm256_permute2f128_ps(s3, s7, 0x20));
+      _mm256_storeu_ps(&matrices[4].m[offset], _mm256_permute2f128_ps(s0, s4, 0x31));
+      _mm256_storeu_ps(&matrices[5].m[offset], _mm256_permute2f128_ps(s1, s5, 0x31));
+      _mm256_storeu_ps(&matrices[6].m[offset], _mm256_permute2f128_ps(s2, s6, 0x31));
+      _mm256_storeu_ps(&matrices[7].m[offset], _mm256_permute2f128_ps(s3, s7, 0x31));
+    }
+
+    /**
+     * Computes the sines and cosines of 8 half-angles.
+     */
+    GAMMA_TARGET_AVX2 inline static void computeHalfAnglesAVX2(const float* angles, __m256& sines, __m256& cosines) {
+      if (Gm_IsFastTrigonometryEnabled()) {
+        Gm_SinCosAVX2(_mm256_mul_ps(_mm256_loadu_ps(angles), _mm256_set1_ps(0.5f)), sines, cosines);
+      } else {
+        alignas(32) float s[8];
+        alignas(32) float c[8];
+
+        computeHalfAngles(angles, s, c, 8);
+
+        sines = _mm256_load_ps(s);
+        cosines = _mm256_load_ps(c);
+      }
+    }
+
+    GAMMA_TARGET_AVX2 void Gm_ComputeTransformMatricesAVX2(const TransformStreams& streams, Matrix4f* matrices, u32 start, u32 end) {
+      const __m256 one = _mm256_set1_ps(1.0f);
+      const __m256 zero = _mm256_setzero_ps();
+      u32 i = start;
+
+      for (; i + 8 <= end; i += 8) {
+        __m256 sx, cx, sy, cy, sz, cz;
+
+        computeHalfAnglesAVX2(&streams.rotationX[i], sx, cx);
+        computeHalfAnglesAVX2(&streams.rotationY[i], sy, cy);
+        computeHalfAnglesAVX2(&streams.rotationZ[i], sz, cz);
+
+        // roll * pitch
+        __m256 aw = _mm256_mul_ps(cz, cx);
+        __m256 ax = _mm256_mul_ps(cz, sx);
+        __m256 ay = _mm256_mul_ps(sz, sx);
+        __m256 az = _mm256_mul_ps(sz, cx);
+
+        // (roll * pitch) * yaw
+        __m256 w = _mm256_sub_ps(_mm256_mul_ps(aw, cy), _mm256_mul_ps(ay, sy));
+        __m256 x = _mm256_sub_ps(_mm256_mul_ps(ax, cy), _mm256_mul_ps(az, sy));
+        __m256 y = _mm256_add_ps(_mm256_mul_ps(aw, sy), _mm256_mul_ps(ay, cy));
+        __m256 z = _mm256_add_ps(_mm256_mul_ps(ax, sy), _mm256_mul_ps(az, cy));
+
+        __m256 x2 = _mm256_add_ps(x, x);
+        __m256 y2 = _mm256_add_ps(y, y);
+        __m256 z2 = _mm256_add_ps(z, z);
+        __m256 xx = _mm256_mul_ps(x, x2);
+        __m256 yy = _mm256_mul_ps(y, y2);
+        __m256 zz = _mm256_mul_ps(z, z2);
+        __m256 xy = _mm256_mul_ps(x, y2);
+        __m256 xz = _mm256_mul_ps(x, z2);
+        __m256 yz = _mm256_mul_ps(y, z2);
+        __m256 wx = _mm256_mul_ps(w, x2);
+        __m256 wy = _mm256_mul_ps(w, y2);
+        __m256 wz = _mm256_mul_ps(w, z2);
+
+        __m256 scaleX = _mm256_loadu_ps(&streams.scaleX[i]);
+        __m256 scaleY = _mm256_loadu_ps(&streams.scaleY[i]);
+        __m256 scaleZ = _mm256_loadu_ps(&streams.scaleZ[i]);
+
+        // Columns 0 and 1 (m[0] - m[7])
+        storeColumnPairsAVX2(&matrices[i], 0,
+          _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), scaleX),
+          _mm256_mul_ps(_mm256_add_ps(xy, wz), scaleX),
+          _mm256_mul_ps(_mm256_sub_ps(xz, wy), scaleX),
+          zero,
+          _mm256_mul_ps(_mm256_sub_ps(xy, wz), scaleY),
+          _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), scaleY),
+          _mm256_mul_ps(_mm256_add_ps(yz, wx), scaleY),
+          zero
+        );
+
+        // Columns 2 and 3 (m[8] - m[15])
+        storeColumnPairsAVX2(&matrices[i], 8,
+          _mm256_mul_ps(_mm256_add_ps(xz, wy), scaleZ),
+          _mm256_mul_ps(_mm256_sub_ps(yz, wx), scaleZ),
+          _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), scaleZ),
+          zero,
+          _mm256_loadu_ps(&streams.positionX[i]),
+          _mm256_loadu_ps(&streams.positionY[i]),
+          _mm256_loadu_ps(&streams.positionZ[i]),
+          one
+        );
+      }
+
+      _mm256_zeroupper();
+
+      Gm_ComputeTransformMatricesScalar(streams, matrices, i, end);
+    }
+  #else
+    void Gm_ComputeTransformMatricesSSE(const TransformStreams& streams, Matrix4f* matrices, u32 start, u32 end) {
+      Gm_ComputeTransformMatricesScalar(streams, matrices, start, end);
+    }
+
+    void Gm_ComputeTransformMatricesAVX2(const TransformStreams& streams, Matrix4f* matrices, u32 start, u32 end) {
+      Gm_ComputeTransformMatricesScalar(streams, matrices, start, end);
+    }
+  #endif
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "math/matrix.h"
+#include "math/Quaternion.h"
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * TransformStreams
+   * ----------------
+   *
+   * Structure-of-arrays transform data for a set of objects,
+   * with one stream per position, scale and rotation component.
+   * Used to compute instance matrices in bulk, several objects
+   * at a time.
+   */
+  struct TransformStreams {
+    float* positionX = nullptr;
+    float* positionY = nullptr;
+    float* positionZ = nullptr;
+    float* scaleX = nullptr;
+    float* scaleY = nullptr;
+    float* scaleZ = nullptr;
+    float* rotationX = nullptr;
+    float* rotationY = nullptr;
+    float* rotationZ = nullptr;
+  };
+
+  /**
+   * Computes a single transposed (column-major) transformation
+   * matrix, equivalent to:
+   *
+   *   Matrix4f::transformation(position, scale, rotation).transpose()
+   *
+   * without building intermediate scale/rotation matrices.
+   */
+  void Gm_ComputeTransformMatrix(const Vec3f& position, const Vec3f& scale, const Vec3f& rotation, Matrix4f& matrix);
+  void Gm_ComputeTransformMatrix(const Vec3f& position, const Vec3f& scale, const Quaternion& rotation, Matrix4f& matrix);
+
+  /**
+   * Computes transposed (column-major) transformation matrices
+   * for streams [start, end), equivalent to:
+   *
+   *   Matrix4f::transformation(position, scale, rotation).transpose()
+   *
+   * Dispatches to the widest kernel supported by the CPU.
+   * Rotation sines and cosines are computed with Gm_SinCos(),
+   * unless disabled with Gm_SetFastTrigonometry().
+   */
+  void Gm_ComputeTransformMatrices(const TransformStreams& streams, Matrix4f* matrices, u32 start, u32 end);
+
+  /**
+   * Individual kernels, exposed for benchmarking and for
+   * verifying SIMD kernels against the scalar one. All kernels
+   * share the same order of operations, so their results match.
+   */
+  void Gm_ComputeTransformMatricesScalar(const TransformStreams& streams, Matrix4f* matrices, u32 start, u32 end);
+  void Gm_ComputeTransformMatricesSSE(const TransformStreams& streams, Matrix4f* matrices, u32 start, u32 end);
+  void Gm_ComputeTransformMatricesAVX2(const TransformStreams& streams, Matrix4f* matrices, u32 start, u32 end);
+}
@@ -0,0 +1,54 @@
+#include <cmath>
+
+#include "math/frustum.h"
+
+namespace Gamma {
+  /**
+   * Frustum
+   * -------
+   */
+
+  /**
+   * Extracts the frustum planes from a (row-major) projection
+   * or view-projection matrix, with each plane in the space the
+   * matrix transforms from. Planes are normalized, so plane
+   * distances can be compared against sphere radii.
+   */
+  Frustum Frustum::fromMatrix(const Matrix4f& matrix) {
+    auto& m = matrix.m;
+    Frustum frustum;
+
+    // Left/right, bottom/top and near/far planes are formed
+    // by adding and subtracting the x, y and z rows from the
+    // w row respectively
+    for (u32 i = 0; i < 6; i++) {
+      u32 row = (i / 2) * 4;
+      float sign = i % 2 == 0 ? 1.0f : -1.0f;
+      auto& plane = frustum.planes[i];
+
+      plane.normal.x = m[12] + m[row] * sign;
+      plane.normal.y = m[13] + m[row + 1] * sign;
+      plane.normal.z = m[14] + m[row + 2] * sign;
+      plane.distance = m[15] + m[row + 3] * sign;
+
+      float length = plane.normal.magnitude();
+
+      plane.normal /= length;
+      plane.distance /= length;
+    }
+
+    return frustum;
+  }
+
+  bool Frustum::isSphereVisible(const Vec3f& center, float radius) const {
+    for (u32 i = 0; i < 6; i++) {
+      auto& plane = planes[i];
+
+      if (Vec3f::dot(plane.normal, center) + plane.distance < -radius) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+}
\ No newline at end of file
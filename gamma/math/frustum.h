@@ -0,0 +1,33 @@
+#pragma once
+
+#include "math/matrix.h"
+#include "math/vector.h"
+
+namespace Gamma {
+  /**
+   * FrustumPlane
+   * ------------
+   *
+   * A plane with a unit normal facing into the frustum, such
+   * that dot(normal, point) + distance >= 0 for points inside.
+   */
+  struct FrustumPlane {
+    Vec3f normal;
+    float distance = 0.0f;
+  };
+
+  /**
+   * Frustum
+   * -------
+   *
+   * The six planes enclosing a view volume, in the order
+   * left, right, bottom, top, near, far.
+   */
+  struct Frustum {
+    FrustumPlane planes[6];
+
+    static Frustum fromMatrix(const Matrix4f& matrix);
+
+    bool isSphereVisible(const Vec3f& center, float radius) const;
+  };
+}
\ No newline at end of file
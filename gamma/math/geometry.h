@@ -9,4 +9,18 @@ namespace Gamma {
     Vec3f tangent;
     Vec2f uv;
   };
+
+  /**
+   * Bounds
+   * ------
+   *
+   * The axis-aligned bounding box of a set of points,
+   * and a bounding sphere centered on the box.
+   */
+  struct Bounds {
+    Vec3f min;
+    Vec3f max;
+    Vec3f center;
+    float radius = 0.0f;
+  };
 }
\ No newline at end of file
@@ -5,8 +5,47 @@
 #include "math/matrix.h"
 #include "math/orientation.h"
 #include "math/Quaternion.h"
+#include "math/simd.h"
 
 namespace Gamma {
+  #if GAMMA_SIMD_X86
+    /**
+     * Shuffles the lanes of a single vector.
+     */
+    #define SWIZZLE(vector, x, y, z, w) _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(w, z, y, x))
+
+    /**
+     * Multiplies two 2x2 matrices, each stored as a row-major
+     * vector: A * B.
+     */
+    inline static __m128 multiply2x2(__m128 a, __m128 b) {
+      return _mm_add_ps(
+        _mm_mul_ps(a, SWIZZLE(b, 0, 3, 0, 3)),
+        _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1))
+      );
+    }
+
+    /**
+     * Multiplies the adjugate of a 2x2 matrix by another: A# * B.
+     */
+    inline static __m128 multiplyAdjugate2x2(__m128 a, __m128 b) {
+      return _mm_sub_ps(
+        _mm_mul_ps(SWIZZLE(a, 3, 3, 0, 0), b),
+        _mm_mul_ps(SWIZZLE(a, 1, 1, 2, 2), SWIZZLE(b, 2, 3, 0, 1))
+      );
+    }
+
+    /**
+     * Multiplies a 2x2 matrix by the adjugate of another: A * B#.
+     */
+    inline static __m128 multiplyByAdjugate2x2(__m128 a, __m128 b) {
+      return _mm_sub_ps(
+        _mm_mul_ps(a, SWIZZLE(b, 3, 0, 3, 0)),
+        _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1))
+      );
+    }
+  #endif
+
   /**
    * Matrix4f
    * -------
@@ -48,53 +87,79 @@ namespace Gamma {
     return rotation * translation;
   }
 
+  /**
+   * Inverts the matrix block-wise, as four 2x2 sub-matrices,
+   * which needs far fewer operations than cofactor expansion
+   * once the 2x2 products are done four lanes at a time.
+   *
+   * @source https://lxjk.github.io/2017/09/03/Fast-4x4-Matrix-Inverse-with-SSE-SIMD-Explained.html
+   */
   Matrix4f Matrix4f::inverse() const {
-    float A2323 = m[10] * m[15] - m[11] * m[14];
-    float A1323 = m[9] * m[15] - m[11] * m[13];
-    float A1223 = m[9] * m[14] - m[10] * m[13];
-    float A0323 = m[8] * m[15] - m[11] * m[12];
-    float A0223 = m[8] * m[14] - m[10] * m[12];
-    float A0123 = m[8] * m[13] - m[9] * m[12];
-    float A2313 = m[6] * m[15] - m[7] * m[14];
-    float A1313 = m[5] * m[15] - m[7] * m[13];
-    float A1213 = m[5] * m[14] - m[6] * m[13];
-    float A2312 = m[6] * m[11] - m[7] * m[10];
-    float A1312 = m[5] * m[11] - m[7] * m[9];
-    float A1212 = m[5] * m[10] - m[6] * m[9];
-    float A0313 = m[4] * m[15] - m[7] * m[12];
-    float A0213 = m[4] * m[14] - m[6] * m[12];
-    float A0312 = m[4] * m[11] - m[7] * m[8];
-    float A0212 = m[4] * m[10] - m[6] * m[8];
-    float A0113 = m[4] * m[13] - m[5] * m[12];
-    float A0112 = m[4] * m[9] - m[5] * m[8];
-
-    float determinant = 1.0f / (
-      m[0] * (m[5] * A2323 - m[6] * A1323 + m[7] * A1223) -
-      m[1] * (m[4] * A2323 - m[6] * A0323 + m[7] * A0223) +
-      m[2] * (m[4] * A1323 - m[5] * A0323 + m[7] * A0123) -
-      m[3] * (m[4] * A1223 - m[5] * A0223 + m[6] * A0123)
-    );
-
-    Matrix4f inverse;
-
-    inverse.m[0] = determinant *  (m[5] * A2323 - m[6] * A1323 + m[7] * A1223);
-    inverse.m[1] = determinant * -(m[1] * A2323 - m[2] * A1323 + m[3] * A1223);
-    inverse.m[2] = determinant *  (m[1] * A2313 - m[2] * A1313 + m[3] * A1213);
-    inverse.m[3] = determinant * -(m[1] * A2312 - m[2] * A1312 + m[3] * A1212);
-    inverse.m[4] = determinant * -(m[4] * A2323 - m[6] * A0323 + m[7] * A0223);
-    inverse.m[5] = determinant *  (m[0] * A2323 - m[2] * A0323 + m[3] * A0223);
-    inverse.m[6] = determinant * -(m[0] * A2313 - m[2] * A0313 + m[3] * A0213);
-    inverse.m[7] = determinant *  (m[0] * A2312 - m[2] * A0312 + m[3] * A0212);
-    inverse.m[8] = determinant *  (m[4] * A1323 - m[5] * A0323 + m[7] * A0123);
-    inverse.m[9] = determinant * -(m[0] * A1323 - m[1] * A0323 + m[3] * A0123);
-    inverse.m[10] = determinant *  (m[0] * A1313 - m[1] * A0313 + m[3] * A0113);
-    inverse.m[11] = determinant * -(m[0] * A1312 - m[1] * A0312 + m[3] * A0112);
-    inverse.m[12] = determinant * -(m[4] * A1223 - m[5] * A0223 + m[6] * A0123);
-    inverse.m[13] = determinant *  (m[0] * A1223 - m[1] * A0223 + m[2] * A0123);
-    inverse.m[14] = determinant * -(m[0] * A1213 - m[1] * A0213 + m[2] * A0113);
-    inverse.m[15] = determinant *  (m[0] * A1212 - m[1] * A0212 + m[2] * A0112);
-
-    return inverse;
+    #if GAMMA_SIMD_X86
+      __m128 row0 = _mm_loadu_ps(&m[0]);
+      __m128 row1 = _mm_loadu_ps(&m[4]);
+      __m128 row2 = _mm_loadu_ps(&m[8]);
+      __m128 row3 = _mm_loadu_ps(&m[12]);
+
+      // Sub-matrices, as | A B |
+      //                  | C D |
+      __m128 A = _mm_movelh_ps(row0, row1);
+      __m128 B = _mm_movehl_ps(row1, row0);
+      __m128 C = _mm_movelh_ps(row2, row3);
+      __m128 D = _mm_movehl_ps(row3, row2);
+
+      // Sub-matrix determinants, as (|A|, |B|, |C|, |D|)
+      __m128 determinants = _mm_sub_ps(
+        _mm_mul_ps(_mm_shuffle_ps(row0, row2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(row1, row3, _MM_SHUFFLE(3, 1, 3, 1))),
+        _mm_mul_ps(_mm_shuffle_ps(row0, row2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(row1, row3, _MM_SHUFFLE(2, 0, 2, 0)))
+      );
+
+      __m128 determinantA = SWIZZLE(determinants, 0, 0, 0, 0);
+      __m128 determinantB = SWIZZLE(determinants, 1, 1, 1, 1);
+      __m128 determinantC = SWIZZLE(determinants, 2, 2, 2, 2);
+      __m128 determinantD = SWIZZLE(determinants, 3, 3, 3, 3);
+
+      // The inverse is 1/|M| * | X Y |, with each block
+      //                        | Z W |
+      // computed as its adjugate
+      __m128 DC = multiplyAdjugate2x2(D, C);
+      __m128 AB = multiplyAdjugate2x2(A, B);
+      __m128 X = _mm_sub_ps(_mm_mul_ps(determinantD, A), multiply2x2(B, DC));
+      __m128 W = _mm_sub_ps(_mm_mul_ps(determinantA, D), multiply2x2(C, AB));
+      __m128 Y = _mm_sub_ps(_mm_mul_ps(determinantB, C), multiplyByAdjugate2x2(D, AB));
+      __m128 Z = _mm_sub_ps(_mm_mul_ps(determinantC, B), multiplyByAdjugate2x2(A, DC));
+
+      // |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+      __m128 trace = _mm_mul_ps(AB, SWIZZLE(DC, 0, 2, 1, 3));
+
+      trace = _mm_add_ps(trace, SWIZZLE(trace, 2, 3, 0, 1));
+      trace = _mm_add_ps(trace, SWIZZLE(trace, 1, 0, 3, 2));
+
+      __m128 determinant = _mm_sub_ps(
+        _mm_add_ps(_mm_mul_ps(determinantA, determinantD), _mm_mul_ps(determinantB, determinantC)),
+        trace
+      );
+
+      // Fold the adjugates' signs into the reciprocal
+      // determinant, and their shuffles into the stores
+      __m128 inverseDeterminant = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), determinant);
+
+      X = _mm_mul_ps(X, inverseDeterminant);
+      Y = _mm_mul_ps(Y, inverseDeterminant);
+      Z = _mm_mul_ps(Z, inverseDeterminant);
+      W = _mm_mul_ps(W, inverseDeterminant);
+
+      Matrix4f inverse;
+
+      _mm_storeu_ps(&inverse.m[0], _mm_shuffle_ps(X, Y, _MM_SHUFFLE(1, 3, 1, 3)));
+      _mm_storeu_ps(&inverse.m[4], _mm_shuffle_ps(X, Y, _MM_SHUFFLE(0, 2, 0, 2)));
+      _mm_storeu_ps(&inverse.m[8], _mm_shuffle_ps(Z, W, _MM_SHUFFLE(1, 3, 1, 3)));
+      _mm_storeu_ps(&inverse.m[12], _mm_shuffle_ps(Z, W, _MM_SHUFFLE(0, 2, 0, 2)));
+
+      return inverse;
+    #else
+      return Gm_InvertMatrixScalar(*this);
+    #endif
   }
 
   Matrix4f Matrix4f::orthographic(float top, float bottom, float left, float right, float near, float far) {
@@ -175,6 +240,33 @@ namespace Gamma {
     return m_transform;
   }
 
+  /**
+   * Builds a transformation matrix directly from a rotation
+   * quaternion, writing only the affine 3x4 terms, rather than
+   * multiplying separate rotation and scale matrices.
+   */
+  Matrix4f Matrix4f::transformation(const Vec3f& translation, const Vec3f& scale, const Quaternion& rotation) {
+    float x2 = rotation.x + rotation.x;
+    float y2 = rotation.y + rotation.y;
+    float z2 = rotation.z + rotation.z;
+    float xx = rotation.x * x2;
+    float yy = rotation.y * y2;
+    float zz = rotation.z * z2;
+    float xy = rotation.x * y2;
+    float xz = rotation.x * z2;
+    float yz = rotation.y * z2;
+    float wx = rotation.w * x2;
+    float wy = rotation.w * y2;
+    float wz = rotation.w * z2;
+
+    return {
+      (1.0f - (yy + zz)) * scale.x, (xy - wz) * scale.y, (xz + wy) * scale.z, translation.x,
+      (xy + wz) * scale.x, (1.0f - (xx + zz)) * scale.y, (yz - wx) * scale.z, translation.y,
+      (xz - wy) * scale.x, (yz + wx) * scale.y, (1.0f - (xx + yy)) * scale.z, translation.z,
+      0.0f, 0.0f, 0.0f, 1.0f
+    };
+  }
+
   Matrix4f Matrix4f::translation(const Vec3f& translation) {
     return {
       1.0f, 0.0f, 0.0f, translation.x,
@@ -185,12 +277,24 @@ namespace Gamma {
   }
 
   Matrix4f Matrix4f::transpose() const {
-    return {
-      m[0], m[4], m[8], m[12],
-      m[1], m[5], m[9], m[13],
-      m[2], m[6], m[10], m[14],
-      m[3], m[7], m[11], m[15]
-    };
+    #if GAMMA_SIMD_X86
+      __m128 row0 = _mm_loadu_ps(&m[0]);
+      __m128 row1 = _mm_loadu_ps(&m[4]);
+      __m128 row2 = _mm_loadu_ps(&m[8]);
+      __m128 row3 = _mm_loadu_ps(&m[12]);
+      Matrix4f transposed;
+
+      _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+      _mm_storeu_ps(&transposed.m[0], row0);
+      _mm_storeu_ps(&transposed.m[4], row1);
+      _mm_storeu_ps(&transposed.m[8], row2);
+      _mm_storeu_ps(&transposed.m[12], row3);
+
+      return transposed;
+    #else
+      return Gm_TransposeMatrixScalar(*this);
+    #endif
   }
 
   void Matrix4f::debug() const {
@@ -201,7 +305,117 @@ namespace Gamma {
     printf("\n");
   }
 
+  /**
+   * Multiplies each row of the matrix by the other matrix's
+   * rows, four columns at a time. Terms are summed in the same
+   * order as Gm_MultiplyMatricesScalar(), so results match.
+   */
   Matrix4f Matrix4f::operator*(const Matrix4f& matrix) const {
+    #if GAMMA_SIMD_X86
+      __m128 row0 = _mm_loadu_ps(&matrix.m[0]);
+      __m128 row1 = _mm_loadu_ps(&matrix.m[4]);
+      __m128 row2 = _mm_loadu_ps(&matrix.m[8]);
+      __m128 row3 = _mm_loadu_ps(&matrix.m[12]);
+      Matrix4f product;
+
+      for (u32 r = 0; r < 4; r++) {
+        const float* row = &m[r * 4];
+        __m128 value = _mm_mul_ps(_mm_set1_ps(row[0]), row0);
+
+        value = _mm_add_ps(value, _mm_mul_ps(_mm_set1_ps(row[1]), row1));
+        value = _mm_add_ps(value, _mm_mul_ps(_mm_set1_ps(row[2]), row2));
+        value = _mm_add_ps(value, _mm_mul_ps(_mm_set1_ps(row[3]), row3));
+
+        _mm_storeu_ps(&product.m[r * 4], value);
+      }
+
+      return product;
+    #else
+      return Gm_MultiplyMatricesScalar(*this, matrix);
+    #endif
+  }
+
+  /**
+   * Multiplies each row by the vector, and then transposes the
+   * products so they can be summed four rows at a time. Terms
+   * are summed in the same order as Gm_TransformVectorScalar(),
+   * so results match.
+   */
+  Vec4f Matrix4f::operator*(const Vec3f& vector) const {
+    #if GAMMA_SIMD_X86
+      __m128 v = _mm_setr_ps(vector.x, vector.y, vector.z, 1.0f);
+      __m128 x = _mm_mul_ps(_mm_loadu_ps(&m[0]), v);
+      __m128 y = _mm_mul_ps(_mm_loadu_ps(&m[4]), v);
+      __m128 z = _mm_mul_ps(_mm_loadu_ps(&m[8]), v);
+      __m128 w = _mm_mul_ps(_mm_loadu_ps(&m[12]), v);
+      Vec4f result;
+
+      _MM_TRANSPOSE4_PS(x, y, z, w);
+
+      _mm_storeu_ps(&result.x, _mm_add_ps(_mm_add_ps(_mm_add_ps(x, y), z), w));
+
+      return result;
+    #else
+      return Gm_TransformVectorScalar(*this, vector);
+    #endif
+  }
+
+  /**
+   * Scalar reference implementations
+   * --------------------------------
+   */
+  Matrix4f Gm_InvertMatrixScalar(const Matrix4f& matrix) {
+    auto& m = matrix.m;
+
+    float A2323 = m[10] * m[15] - m[11] * m[14];
+    float A1323 = m[9] * m[15] - m[11] * m[13];
+    float A1223 = m[9] * m[14] - m[10] * m[13];
+    float A0323 = m[8] * m[15] - m[11] * m[12];
+    float A0223 = m[8] * m[14] - m[10] * m[12];
+    float A0123 = m[8] * m[13] - m[9] * m[12];
+    float A2313 = m[6] * m[15] - m[7] * m[14];
+    float A1313 = m[5] * m[15] - m[7] * m[13];
+    float A1213 = m[5] * m[14] - m[6] * m[13];
+    float A2312 = m[6] * m[11] - m[7] * m[10];
+    float A1312 = m[5] * m[11] - m[7] * m[9];
+    float A1212 = m[5] * m[10] - m[6] * m[9];
+    float A0313 = m[4] * m[15] - m[7] * m[12];
+    float A0213 = m[4] * m[14] - m[6] * m[12];
+    float A0312 = m[4] * m[11] - m[7] * m[8];
+    float A0212 = m[4] * m[10] - m[6] * m[8];
+    float A0113 = m[4] * m[13] - m[5] * m[12];
+    float A0112 = m[4] * m[9] - m[5] * m[8];
+
+    float determinant = 1.0f / (
+      m[0] * (m[5] * A2323 - m[6] * A1323 + m[7] * A1223) -
+      m[1] * (m[4] * A2323 - m[6] * A0323 + m[7] * A0223) +
+      m[2] * (m[4] * A1323 - m[5] * A0323 + m[7] * A0123) -
+      m[3] * (m[4] * A1223 - m[5] * A0223 + m[6] * A0123)
+    );
+
+    Matrix4f inverse;
+
+    inverse.m[0] = determinant *  (m[5] * A2323 - m[6] * A1323 + m[7] * A1223);
+    inverse.m[1] = determinant * -(m[1] * A2323 - m[2] * A1323 + m[3] * A1223);
+    inverse.m[2] = determinant *  (m[1] * A2313 - m[2] * A1313 + m[3] * A1213);
+    inverse.m[3] = determinant * -(m[1] * A2312 - m[2] * A1312 + m[3] * A1212);
+    inverse.m[4] = determinant * -(m[4] * A2323 - m[6] * A0323 + m[7] * A0223);
+    inverse.m[5] = determinant *  (m[0] * A2323 - m[2] * A0323 + m[3] * A0223);
+    inverse.m[6] = determinant * -(m[0] * A2313 - m[2] * A0313 + m[3] * A0213);
+    inverse.m[7] = determinant *  (m[0] * A2312 - m[2] * A0312 + m[3] * A0212);
+    inverse.m[8] = determinant *  (m[4] * A1323 - m[5] * A0323 + m[7] * A0123);
+    inverse.m[9] = determinant * -(m[0] * A1323 - m[1] * A0323 + m[3] * A0123);
+    inverse.m[10] = determinant *  (m[0] * A1313 - m[1] * A0313 + m[3] * A0113);
+    inverse.m[11] = determinant * -(m[0] * A1312 - m[1] * A0312 + m[3] * A0112);
+    inverse.m[12] = determinant * -(m[4] * A1223 - m[5] * A0223 + m[6] * A0123);
+    inverse.m[13] = determinant *  (m[0] * A1223 - m[1] * A0223 + m[2] * A0123);
+    inverse.m[14] = determinant * -(m[0] * A1213 - m[1] * A0213 + m[2] * A0113);
+    inverse.m[15] = determinant *  (m[0] * A1212 - m[1] * A0212 + m[2] * A0112);
+
+    return inverse;
+  }
+
+  Matrix4f Gm_MultiplyMatricesScalar(const Matrix4f& a, const Matrix4f& b) {
     Matrix4f product;
 
     for (int r = 0; r < 4; r++) {
@@ -209,7 +423,7 @@ namespace Gamma {
         float& value = product.m[r * 4 + c] = 0;
 
         for (int n = 0; n < 4; n++) {
-          value += m[r * 4 + n] * matrix.m[n * 4 + c];
+          value += a.m[r * 4 + n] * b.m[n * 4 + c];
         }
       }
     }
@@ -217,7 +431,8 @@ namespace Gamma {
     return product;
   }
 
-  Vec4f Matrix4f::operator*(const Vec3f& vector) const {
+  Vec4f Gm_TransformVectorScalar(const Matrix4f& matrix, const Vec3f& vector) {
+    auto& m = matrix.m;
     float x = vector.x;
     float y = vector.y;
     float z = vector.z;
@@ -230,4 +445,37 @@ namespace Gamma {
       x * m[12] + y * m[13] + z * m[14] + w * m[15]
     );
   }
+
+  Matrix4f Gm_TransposeMatrixScalar(const Matrix4f& matrix) {
+    auto& m = matrix.m;
+
+    return {
+      m[0], m[4], m[8], m[12],
+      m[1], m[5], m[9], m[13],
+      m[2], m[6], m[10], m[14],
+      m[3], m[7], m[11], m[15]
+    };
+  }
+
+  /**
+   * Matrix4x3f
+   * ----------
+   */
+  Matrix4x3f Matrix4x3f::fromMatrix4f(const Matrix4f& matrix) {
+    return {
+      matrix.m[0], matrix.m[1], matrix.m[2],
+      matrix.m[4], matrix.m[5], matrix.m[6],
+      matrix.m[8], matrix.m[9], matrix.m[10],
+      matrix.m[12], matrix.m[13], matrix.m[14]
+    };
+  }
+
+  Matrix4f Matrix4x3f::toMatrix4f() const {
+    return {
+      m[0], m[1], m[2], 0.0f,
+      m[3], m[4], m[5], 0.0f,
+      m[6], m[7], m[8], 0.0f,
+      m[9], m[10], m[11], 1.0f
+    };
+  }
 }
\ No newline at end of file
@@ -6,6 +6,8 @@
 #include "system/type_aliases.h"
 
 namespace Gamma {
+  struct Quaternion;
+
   struct Matrix4f {
     float m[16] = { 0.0f };
 
@@ -17,6 +19,7 @@ namespace Gamma {
     static Matrix4f rotation(const Orientation& orientation);
     static Matrix4f scale(const Vec3f& scale);
     static Matrix4f transformation(const Vec3f& translation, const Vec3f& scale, const Vec3f& rotation);
+    static Matrix4f transformation(const Vec3f& translation, const Vec3f& scale, const Quaternion& rotation);
     static Matrix4f translation(const Vec3f& translation);
 
     Matrix4f operator*(const Matrix4f& matrix) const;
@@ -26,4 +29,36 @@ namespace Gamma {
     Matrix4f inverse() const;
     Matrix4f transpose() const;
   };
+
+  /**
+   * Scalar reference implementations of the SIMD Matrix4f
+   * operations, for verifying SIMD results and for benchmarks.
+   * Products, transposes and vector transforms match the SIMD
+   * results exactly; inverses are computed differently, so only
+   * match to within rounding error.
+   */
+  Matrix4f Gm_InvertMatrixScalar(const Matrix4f& matrix);
+  Matrix4f Gm_MultiplyMatricesScalar(const Matrix4f& a, const Matrix4f& b);
+  Vec4f Gm_TransformVectorScalar(const Matrix4f& matrix, const Vec3f& vector);
+  Matrix4f Gm_TransposeMatrixScalar(const Matrix4f& matrix);
+
+  /**
+   * Matrix4x3f
+   * ----------
+   *
+   * A compact affine transformation matrix, storing the first
+   * three rows of each column of a transposed (column-major)
+   * Matrix4f. The omitted row is always (0, 0, 0, 1) for
+   * transformation matrices, so 4x3 matrices take up 48 bytes
+   * rather than 64.
+   *
+   * Matches the layout of a GLSL mat4x3.
+   */
+  struct Matrix4x3f {
+    float m[12] = { 0.0f };
+
+    static Matrix4x3f fromMatrix4f(const Matrix4f& matrix);
+
+    Matrix4f toMatrix4f() const;
+  };
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "math/simd.h"
+
+#if GAMMA_SIMD_X86 && defined(_MSC_VER)
+  #include <intrin.h>
+#endif
+
+namespace Gamma {
+  static SimdLevel detectSimdLevel() {
+    #if GAMMA_SIMD_X86 && defined(_MSC_VER)
+      int info[4];
+
+      __cpuid(info, 0);
+
+      int totalLeaves = info[0];
+
+      __cpuid(info, 1);
+
+      bool hasSse2 = (info[3] & (1 << 26)) != 0;
+      bool hasOsxsave = (info[2] & (1 << 27)) != 0;
+      bool hasAvx = (info[2] & (1 << 28)) != 0;
+      bool hasAvx2 = false;
+
+      if (totalLeaves >= 7) {
+        __cpuidex(info, 7, 0);
+
+        hasAvx2 = (info[1] & (1 << 5)) != 0;
+      }
+
+      // AVX registers are only usable if the OS saves
+      // their state on context switches
+      bool osSavesAvxState = hasOsxsave && (_xgetbv(0) & 0x6) == 0x6;
+
+      if (hasAvx && hasAvx2 && osSavesAvxState) {
+        return SimdLevel::AVX2;
+      }
+
+      return hasSse2 ? SimdLevel::SSE : SimdLevel::SCALAR;
+    #elif GAMMA_SIMD_X86
+      __builtin_cpu_init();
+
+      if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+      }
+
+      return __builtin_cpu_supports("sse2") ? SimdLevel::SSE : SimdLevel::SCALAR;
+    #else
+      return SimdLevel::SCALAR;
+    #endif
+  }
+
+  static SimdLevel detectedSimdLevel = detectSimdLevel();
+  static SimdLevel activeSimdLevel = detectedSimdLevel;
+
+  SimdLevel Gm_GetSimdLevel() {
+    return activeSimdLevel;
+  }
+
+  const char* Gm_GetSimdLevelName(SimdLevel level) {
+    switch (level) {
+      case SimdLevel::AVX2:
+        return "AVX2";
+      case SimdLevel::SSE:
+        return "SSE";
+      default:
+        return "Scalar";
+    }
+  }
+
+  void Gm_SetSimdLevel(SimdLevel level) {
+    activeSimdLevel = level > detectedSimdLevel ? detectedSimdLevel : level;
+  }
+}
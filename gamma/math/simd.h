@@ -0,0 +1,51 @@
+#pragma once
+
+#include "system/type_aliases.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+  #define GAMMA_SIMD_X86 1
+  #include <immintrin.h>
+#else
+  #define GAMMA_SIMD_X86 0
+#endif
+
+/**
+ * Marks a function as using AVX2 instructions. MSVC allows
+ * AVX intrinsics in any function, whereas GCC/Clang need them
+ * to be compiled with an explicit target.
+ */
+#if GAMMA_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+  #define GAMMA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+  #define GAMMA_TARGET_AVX2
+#endif
+
+namespace Gamma {
+  /**
+   * SimdLevel
+   * ---------
+   *
+   * The widest instruction set available to batch kernels,
+   * in ascending order of width.
+   */
+  enum class SimdLevel {
+    SCALAR,
+    // SSE2
+    SSE,
+    AVX2
+  };
+
+  /**
+   * Returns the SimdLevel batch kernels should dispatch to.
+   * The CPU is queried once, at startup.
+   */
+  SimdLevel Gm_GetSimdLevel();
+  const char* Gm_GetSimdLevelName(SimdLevel level);
+
+  /**
+   * Overrides the detected SimdLevel, e.g. to compare kernels
+   * in benchmarks. Levels beyond what the CPU supports are
+   * clamped to the detected level.
+   */
+  void Gm_SetSimdLevel(SimdLevel level);
+}
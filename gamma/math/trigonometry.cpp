@@ -0,0 +1,13 @@
+#include "math/trigonometry.h"
+
+namespace Gamma {
+  static bool isFastTrigonometryEnabled = true;
+
+  bool Gm_IsFastTrigonometryEnabled() {
+    return isFastTrigonometryEnabled;
+  }
+
+  void Gm_SetFastTrigonometry(bool enabled) {
+    isFastTrigonometryEnabled = enabled;
+  }
+}
\ No newline at end of file
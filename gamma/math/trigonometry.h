@@ -0,0 +1,132 @@
+#pragma once
+
+#include "math/simd.h"
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * Constants for Gm_SinCos(). Angles are reduced by the
+   * nearest multiple of pi/2, with pi/2 split into three parts
+   * so that multiples of the first two parts are exact.
+   *
+   * @source Cephes Math Library (sinf.c)
+   */
+  constexpr static float SINCOS_TWO_OVER_PI = 0.636619772367581343f;
+  constexpr static float SINCOS_HALF_PI_A = 1.5703125f;
+  constexpr static float SINCOS_HALF_PI_B = 4.837512969970703125e-4f;
+  constexpr static float SINCOS_HALF_PI_C = 7.54978995489188216e-8f;
+  /**
+   * Adding and subtracting 1.5 * 2^23 rounds a float to the
+   * nearest integer, without needing SSE4.1 rounding.
+   */
+  constexpr static float SINCOS_ROUNDING_BIAS = 12582912.0f;
+  /**
+   * Minimax polynomial coefficients for sin(x) and cos(x)
+   * over [-pi/4, pi/4].
+   */
+  constexpr static float SINCOS_S1 = -1.6666654611e-1f;
+  constexpr static float SINCOS_S2 = 8.3321608736e-3f;
+  constexpr static float SINCOS_S3 = -1.9515295891e-4f;
+  constexpr static float SINCOS_C1 = 4.166664568298827e-2f;
+  constexpr static float SINCOS_C2 = -1.388731625493765e-3f;
+  constexpr static float SINCOS_C3 = 2.443315711809948e-5f;
+
+  /**
+   * Gm_SinCos()
+   * -----------
+   *
+   * Computes the sine and cosine of an angle together, with a
+   * minimax polynomial over the angle's reduced quadrant. The
+   * result is within 1e-7 of the exact sine and cosine for
+   * angles within +/-8192 radians (sinf()/cosf() are within
+   * 3.3e-8), and within 1e-6 for angles within +/-1e5, as
+   * range reduction loses precision with larger angles.
+   *
+   * The SSE/AVX2 versions compute 4/8 angles at a time, and
+   * share the same order of operations, so their results
+   * match the scalar version exactly.
+   */
+  inline void Gm_SinCos(float angle, float& sine, float& cosine) {
+    float j = (angle * SINCOS_TWO_OVER_PI + SINCOS_ROUNDING_BIAS) - SINCOS_ROUNDING_BIAS;
+    float x = ((angle - j * SINCOS_HALF_PI_A) - j * SINCOS_HALF_PI_B) - j * SINCOS_HALF_PI_C;
+    float x2 = x * x;
+    float s = x + x * x2 * (SINCOS_S1 + x2 * (SINCOS_S2 + x2 * SINCOS_S3));
+    float c = (1.0f - 0.5f * x2) + x2 * x2 * (SINCOS_C1 + x2 * (SINCOS_C2 + x2 * SINCOS_C3));
+    u32 quadrant = (u32)(s32)j & 3;
+
+    // Quadrants 1 and 3 swap sine and cosine, and sine
+    // is negated in quadrants 2 and 3, cosine in 1 and 2.
+    // Signs are applied by multiplying rather than branching,
+    // since quadrants are unpredictable.
+    float sineSign = 1.0f - (float)(quadrant & 2);
+    float cosineSign = 1.0f - (float)((quadrant + 1) & 2);
+
+    sine = (quadrant & 1 ? c : s) * sineSign;
+    cosine = (quadrant & 1 ? s : c) * cosineSign;
+  }
+
+  #if GAMMA_SIMD_X86
+    inline void Gm_SinCosSSE(__m128 angle, __m128& sine, __m128& cosine) {
+      const __m128 bias = _mm_set1_ps(SINCOS_ROUNDING_BIAS);
+      __m128 j = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(angle, _mm_set1_ps(SINCOS_TWO_OVER_PI)), bias), bias);
+      __m128 x = _mm_sub_ps(angle, _mm_mul_ps(j, _mm_set1_ps(SINCOS_HALF_PI_A)));
+
+      x = _mm_sub_ps(x, _mm_mul_ps(j, _mm_set1_ps(SINCOS_HALF_PI_B)));
+      x = _mm_sub_ps(x, _mm_mul_ps(j, _mm_set1_ps(SINCOS_HALF_PI_C)));
+
+      __m128 x2 = _mm_mul_ps(x, x);
+      __m128 s = _mm_add_ps(_mm_mul_ps(x2, _mm_set1_ps(SINCOS_S3)), _mm_set1_ps(SINCOS_S2));
+      __m128 c = _mm_add_ps(_mm_mul_ps(x2, _mm_set1_ps(SINCOS_C3)), _mm_set1_ps(SINCOS_C2));
+
+      s = _mm_add_ps(_mm_mul_ps(x2, s), _mm_set1_ps(SINCOS_S1));
+      s = _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(x, x2), s));
+      c = _mm_add_ps(_mm_mul_ps(x2, c), _mm_set1_ps(SINCOS_C1));
+      c = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), x2)), _mm_mul_ps(_mm_mul_ps(x2, x2), c));
+
+      __m128i quadrant = _mm_cvttps_epi32(j);
+      __m128i one = _mm_set1_epi32(1);
+      __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+      __m128 sineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+      __m128 cosineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), _mm_set1_epi32(2)), 30));
+
+      sine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s)), sineSign);
+      cosine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c)), cosineSign);
+    }
+
+    GAMMA_TARGET_AVX2 inline void Gm_SinCosAVX2(__m256 angle, __m256& sine, __m256& cosine) {
+      const __m256 bias = _mm256_set1_ps(SINCOS_ROUNDING_BIAS);
+      __m256 j = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(angle, _mm256_set1_ps(SINCOS_TWO_OVER_PI)), bias), bias);
+      __m256 x = _mm256_sub_ps(angle, _mm256_mul_ps(j, _mm256_set1_ps(SINCOS_HALF_PI_A)));
+
+      x = _mm256_sub_ps(x, _mm256_mul_ps(j, _mm256_set1_ps(SINCOS_HALF_PI_B)));
+      x = _mm256_sub_ps(x, _mm256_mul_ps(j, _mm256_set1_ps(SINCOS_HALF_PI_C)));
+
+      __m256 x2 = _mm256_mul_ps(x, x);
+      __m256 s = _mm256_add_ps(_mm256_mul_ps(x2, _mm256_set1_ps(SINCOS_S3)), _mm256_set1_ps(SINCOS_S2));
+      __m256 c = _mm256_add_ps(_mm256_mul_ps(x2, _mm256_set1_ps(SINCOS_C3)), _mm256_set1_ps(SINCOS_C2));
+
+      s = _mm256_add_ps(_mm256_mul_ps(x2, s), _mm256_set1_ps(SINCOS_S1));
+      s = _mm256_add_ps(x, _mm256_mul_ps(_mm256_mul_ps(x, x2), s));
+      c = _mm256_add_ps(_mm256_mul_ps(x2, c), _mm256_set1_ps(SINCOS_C1));
+      c = _mm256_add_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(_mm256_set1_ps(0.5f), x2)), _mm256_mul_ps(_mm256_mul_ps(x2, x2), c));
+
+      __m256i quadrant = _mm256_cvttps_epi32(j);
+      __m256i one = _mm256_set1_epi32(1);
+      __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one));
+      __m256 sineSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(2)), 30));
+      __m256 cosineSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, one), _mm256_set1_epi32(2)), 30));
+
+      sine = _mm256_xor_ps(_mm256_blendv_ps(s, c, swap), sineSign);
+      cosine = _mm256_xor_ps(_mm256_blendv_ps(c, s, swap), cosineSign);
+    }
+  #endif
+
+  /**
+   * Selects whether rotations in transform construction use
+   * Gm_SinCos() (the default), or sinf()/cosf(). Applies to
+   * Quaternion::fromAxisAngle(), and to the transform matrix
+   * kernels in batch_transforms.h.
+   */
+  bool Gm_IsFastTrigonometryEnabled();
+  void Gm_SetFastTrigonometry(bool enabled);
+}
\ No newline at end of file
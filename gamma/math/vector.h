@@ -1,44 +1,53 @@
 #pragma once
 
+#include <cmath>
+
 namespace Gamma {
   struct Vec2f {
-    Vec2f() {};
-    Vec2f(float f): x(f), y(f) {};
-    Vec2f(float x, float y) : x(x), y(y) {};
+    constexpr Vec2f() {};
+    constexpr Vec2f(float f): x(f), y(f) {};
+    constexpr Vec2f(float x, float y) : x(x), y(y) {};
 
     float x = 0.0f;
     float y = 0.0f;
   };
 
+  /**
+   * Vec3f
+   * -----
+   *
+   * Core operations are defined inline below, so they can be
+   * inlined into hot loops in any translation unit.
+   */
   struct Vec3f : Vec2f {
-    Vec3f() {};
-    Vec3f(float f) : Vec2f(f, f), z(f) {};
-    Vec3f(float x, float y, float z) : Vec2f(x, y), z(z) {};
+    constexpr Vec3f() {};
+    constexpr Vec3f(float f) : Vec2f(f, f), z(f) {};
+    constexpr Vec3f(float x, float y, float z) : Vec2f(x, y), z(z) {};
 
     float z = 0.0f;
 
-    static Vec3f cross(const Vec3f& v1, const Vec3f& v2);
-    static float dot(const Vec3f& v1, const Vec3f& v2);
-    static Vec3f lerp(const Vec3f& v1, const Vec3f& v2, float alpha);
-
-    bool operator==(const Vec3f& vector) const;
-    Vec3f operator+(const Vec3f& vector) const;
-    void operator+=(const Vec3f& vector);
-    Vec3f operator-(const Vec3f& vector) const;
-    void operator-=(const Vec3f& vector);
-    Vec3f operator*(float scalar) const;
-    Vec3f operator*(const Vec3f& vector) const;
-    void operator*=(float scalar);
-    void operator*=(const Vec3f& vector);
-    Vec3f operator/(float divisor) const;
-    void operator/=(float divisor);
+    constexpr static Vec3f cross(const Vec3f& v1, const Vec3f& v2);
+    constexpr static float dot(const Vec3f& v1, const Vec3f& v2);
+    constexpr static Vec3f lerp(const Vec3f& v1, const Vec3f& v2, float alpha);
+
+    constexpr bool operator==(const Vec3f& vector) const;
+    constexpr Vec3f operator+(const Vec3f& vector) const;
+    constexpr void operator+=(const Vec3f& vector);
+    constexpr Vec3f operator-(const Vec3f& vector) const;
+    constexpr void operator-=(const Vec3f& vector);
+    constexpr Vec3f operator*(float scalar) const;
+    constexpr Vec3f operator*(const Vec3f& vector) const;
+    constexpr void operator*=(float scalar);
+    constexpr void operator*=(const Vec3f& vector);
+    constexpr Vec3f operator/(float divisor) const;
+    constexpr void operator/=(float divisor);
 
     void debug() const;
-    Vec3f gl() const;
-    Vec3f invert() const;
-    float magnitude() const;
-    Vec3f unit() const;
-    Vec3f xz() const;
+    constexpr Vec3f gl() const;
+    constexpr Vec3f invert() const;
+    inline float magnitude() const;
+    inline Vec3f unit() const;
+    constexpr Vec3f xz() const;
   };
 
   struct Vec4f {
@@ -47,11 +56,145 @@ namespace Gamma {
     float z = 0.0f;
     float w = 0.0f;
 
-    Vec4f() {};
-    Vec4f(float f) : x(f), y(f), z(f), w(f) {};
-    Vec4f(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {};
+    constexpr Vec4f() {};
+    constexpr Vec4f(float f) : x(f), y(f), z(f), w(f) {};
+    constexpr Vec4f(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {};
 
-    Vec3f homogenize() const;
-    Vec3f toVec3f() const;
+    constexpr Vec3f homogenize() const;
+    constexpr Vec3f toVec3f() const;
   };
+
+  /**
+   * Vec3f
+   * -----
+   */
+  constexpr bool Vec3f::operator==(const Vec3f& vector) const {
+    return x == vector.x && y == vector.y && z == vector.z;
+  }
+
+  constexpr Vec3f Vec3f::operator+(const Vec3f& vector) const {
+    return {
+      x + vector.x,
+      y + vector.y,
+      z + vector.z
+    };
+  }
+
+  constexpr void Vec3f::operator+=(const Vec3f& vector) {
+    x += vector.x;
+    y += vector.y;
+    z += vector.z;
+  }
+
+  constexpr Vec3f Vec3f::operator-(const Vec3f& vector) const {
+    return {
+      x - vector.x,
+      y - vector.y,
+      z - vector.z
+    };
+  }
+
+  constexpr void Vec3f::operator-=(const Vec3f& vector) {
+    x -= vector.x;
+    y -= vector.y;
+    z -= vector.z;
+  }
+
+  constexpr Vec3f Vec3f::operator*(float scalar) const {
+    return {
+      x * scalar,
+      y * scalar,
+      z * scalar
+    };
+  }
+
+  constexpr Vec3f Vec3f::operator*(const Vec3f& vector) const {
+    return {
+      x * vector.x,
+      y * vector.y,
+      z * vector.z
+    };
+  }
+
+  constexpr void Vec3f::operator*=(float scalar) {
+    *this = *this * scalar;
+  }
+
+  constexpr void Vec3f::operator*=(const Vec3f& vector) {
+    *this = *this * vector;
+  }
+
+  constexpr Vec3f Vec3f::operator/(float divisor) const {
+    return {
+      x / divisor,
+      y / divisor,
+      z / divisor
+    };
+  }
+
+  constexpr void Vec3f::operator/=(float divisor) {
+    x /= divisor;
+    y /= divisor;
+    z /= divisor;
+  }
+
+  constexpr Vec3f Vec3f::cross(const Vec3f& v1, const Vec3f& v2) {
+    return {
+      v1.y * v2.z - v1.z * v2.y,
+      v1.z * v2.x - v1.x * v2.z,
+      v1.x * v2.y - v1.y * v2.x
+    };
+  }
+
+  constexpr float Vec3f::dot(const Vec3f& v1, const Vec3f& v2) {
+    return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+  }
+
+  constexpr Vec3f Vec3f::gl() const {
+    return *this * Vec3f(1.0f, 1.0f, -1.0f);
+  }
+
+  constexpr Vec3f Vec3f::invert() const {
+    return *this * -1.0f;
+  }
+
+  // Same as Gm_Lerpf() per component
+  constexpr Vec3f Vec3f::lerp(const Vec3f& v1, const Vec3f& v2, float alpha) {
+    return Vec3f(
+      v1.x + (v2.x - v1.x) * alpha,
+      v1.y + (v2.y - v1.y) * alpha,
+      v1.z + (v2.z - v1.z) * alpha
+    );
+  }
+
+  inline float Vec3f::magnitude() const {
+    return sqrtf(x * x + y * y + z * z);
+  }
+
+  inline Vec3f Vec3f::unit() const {
+    float m = magnitude();
+
+    return {
+      x / m,
+      y / m,
+      z / m
+    };
+  }
+
+  constexpr Vec3f Vec3f::xz() const {
+    return *this * Vec3f(1.0f, 0.0f, 1.0f);
+  }
+
+  /**
+   * Vec4f
+   * -----
+   */
+  constexpr Vec3f Vec4f::homogenize() const {
+    return Vec3f(x / w, y / w, z / w);
+  }
+
+  // @todo rename xyz()
+  constexpr Vec3f Vec4f::toVec3f() const {
+    return Vec3f(x, y, z);
+  }
 }
\ No newline at end of file
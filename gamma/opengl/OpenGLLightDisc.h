@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "math/plane.h"
+#include "system/camera.h"
 #include "system/entities.h"
 #include "system/traits.h"
 #include "system/type_aliases.h"
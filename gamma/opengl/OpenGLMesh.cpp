@@ -56,18 +56,25 @@ namespace Gamma {
     glEnableVertexAttribArray(GLAttribute::VERTEX_UV);
     glVertexAttribPointer(GLAttribute::VERTEX_UV, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, uv));
 
+    allocateInstanceBuffers();
+
     // Define color attributes
     glBindBuffer(GL_ARRAY_BUFFER, buffers[GLBuffer::COLOR]);
     glEnableVertexAttribArray(GLAttribute::MODEL_COLOR);
     glVertexAttribIPointer(GLAttribute::MODEL_COLOR, 1, GL_UNSIGNED_INT, sizeof(pVec4), (void*)0);
     glVertexAttribDivisor(GLAttribute::MODEL_COLOR, 1);
 
-    // Define matrix attributes
+    // Define matrix attributes. AFFINE matrices only provide
+    // the first three components of each column; the shaders
+    // restore the last row (see utils/instancing.glsl).
+    u32 matrixSize = mesh->objects.getMatrixSize();
+    u32 columnSize = mesh->objects.getMatrixFormat() == MatrixFormat::AFFINE ? 3 : 4;
+
     glBindBuffer(GL_ARRAY_BUFFER, buffers[GLBuffer::MATRIX]);
 
     for (u32 i = 0; i < 4; i++) {
       glEnableVertexAttribArray(GLAttribute::MODEL_MATRIX + i);
-      glVertexAttribPointer(GLAttribute::MODEL_MATRIX + i, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix4f), (void*)(i * 4 * sizeof(float)));
+      glVertexAttribPointer(GLAttribute::MODEL_MATRIX + i, columnSize, GL_FLOAT, GL_FALSE, matrixSize, (void*)(i * columnSize * sizeof(float)));
       glVertexAttribDivisor(GLAttribute::MODEL_MATRIX + i, 1);
     }
   }
@@ -76,6 +83,24 @@ namespace Gamma {
     // @todo
   }
 
+  /**
+   * Allocates instance buffers for the full capacity of the
+   * object pool, so changed instance data can be uploaded in
+   * place. Vertex attribute bindings refer to the buffers rather
+   * than their storage, so they survive reallocation.
+   */
+  void OpenGLMesh::allocateInstanceBuffers() {
+    auto& objects = sourceMesh->objects;
+
+    instanceCapacity = objects.max();
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[GLBuffer::COLOR]);
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(pVec4), nullptr, GL_DYNAMIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[GLBuffer::MATRIX]);
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * objects.getMatrixSize(), nullptr, GL_DYNAMIC_DRAW);
+  }
+
   void OpenGLMesh::checkAndLoadTexture(const std::string& path, OpenGLTexture*& texture, GLenum unit) {
     #if GAMMA_DEVELOPER_MODE
       if (texture != nullptr && texture->getPath() != path) {
@@ -105,7 +130,7 @@ namespace Gamma {
     return sourceMesh->id;
   }
 
-  u16 OpenGLMesh::getObjectCount() const {
+  u32 OpenGLMesh::getObjectCount() const {
     return sourceMesh->objects.totalActive();
   }
 
@@ -125,14 +150,14 @@ namespace Gamma {
     return sourceMesh->type == type;
   }
 
-  // @todo provide a parameter to render total visible vs. total active
-  void OpenGLMesh::render(GLenum primitiveMode, bool useLowestLevelOfDetail) {
+  /**
+   * Binds textures and geometry for rendering the mesh's
+   * instances, re-buffering its vertices if they've been
+   * transformed on the CPU.
+   */
+  void OpenGLMesh::prepareToRender() {
     auto& mesh = *sourceMesh;
 
-    if (mesh.objects.totalVisible() == 0 || mesh.disabled) {
-      return;
-    }
-
     if (mesh.type != MeshType::REFRACTIVE) {
       // Don't bind textures for refractive objects, since in
       // the refractive geometry frag shader we need to read
@@ -154,20 +179,20 @@ namespace Gamma {
       glBufferData(GL_ARRAY_BUFFER, transformedVertices.size() * sizeof(Vertex), transformedVertices.data(), GL_DYNAMIC_DRAW);
     }
 
-    if (!hasCreatedInstanceBuffers || mesh.type != MeshType::PARTICLE_SYSTEM) {
-      // Buffer instance colors/matrices
-      glBindBuffer(GL_ARRAY_BUFFER, buffers[GLBuffer::COLOR]);
-      glBufferData(GL_ARRAY_BUFFER, mesh.objects.totalVisible() * sizeof(pVec4), mesh.objects.getColors(), GL_DYNAMIC_DRAW);
+    // Bind VAO/EBO
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+  }
 
-      glBindBuffer(GL_ARRAY_BUFFER, buffers[GLBuffer::MATRIX]);
-      glBufferData(GL_ARRAY_BUFFER, mesh.objects.totalVisible() * sizeof(Matrix4f), mesh.objects.getMatrices(), GL_DYNAMIC_DRAW);
+  // @todo provide a parameter to render total visible vs. total active
+  void OpenGLMesh::render(GLenum primitiveMode, bool useLowestLevelOfDetail) {
+    auto& mesh = *sourceMesh;
 
-      hasCreatedInstanceBuffers = true;
+    if (mesh.objects.totalVisible() == 0 || mesh.disabled) {
+      return;
     }
 
-    // Bind VAO/EBO and draw instances
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    prepareToRender();
 
     if (mesh.lods.size() > 0) {
       if (useLowestLevelOfDetail) {
@@ -177,14 +202,16 @@ namespace Gamma {
         glDrawElementsInstanced(primitiveMode, lod.elementCount, GL_UNSIGNED_INT, (void*)(lod.elementOffset * sizeof(u32)), mesh.objects.totalVisible());
       } else {
         // Generate draw commands for mesh instances at each
-        // level of detail, and dispatch them all together
-        //
-        // @todo preallocate draw commands array
-        auto* commands = new GlDrawElementsIndirectCommand[mesh.lods.size()];
+        // level of detail with any instances, and dispatch
+        // them all together
+        drawCommands.clear();
 
-        for (u32 i = 0; i < mesh.lods.size(); i++) {
-          auto& command = commands[i];
-          auto& lod = mesh.lods[i];
+        for (auto& lod : mesh.lods) {
+          if (lod.instanceCount == 0) {
+            continue;
+          }
+
+          GlDrawElementsIndirectCommand command;
 
           command.count = lod.elementCount;
           command.firstIndex = lod.elementOffset;
@@ -194,13 +221,15 @@ namespace Gamma {
           // this may need to change if we revise the way mesh
           // data is stored/use glMultiDraw more broadly
           command.baseVertex = 0;
-        }
 
-        Gm_BufferDrawElementsIndirectCommands(commands, 2);
+          drawCommands.push_back(command);
+        }
 
-        glMultiDrawElementsIndirect(primitiveMode, GL_UNSIGNED_INT, 0, 2, 0);
+        if (drawCommands.size() > 0) {
+          Gm_BufferDrawElementsIndirectCommands(drawCommands.data(), (u32)drawCommands.size());
 
-        delete[] commands;
+          glMultiDrawElementsIndirect(primitiveMode, GL_UNSIGNED_INT, 0, (GLsizei)drawCommands.size(), 0);
+        }
       }
     } else if (mesh.type == MeshType::PARTICLE_SYSTEM) {
       // @todo description
@@ -213,4 +242,95 @@ namespace Gamma {
       glDrawElementsInstanced(primitiveMode, mesh.faceElements.size(), GL_UNSIGNED_INT, (void*)0, mesh.objects.totalVisible());
     }
   }
+
+  /**
+   * Renders the mesh's active instances whose bits are set in
+   * a set of caster visibility masks, at the lowest level of
+   * detail, for shadow maps. Casters needn't be visible to the
+   * camera, so they're tested across all active objects rather
+   * than the visible range. Each contiguous run of casters is
+   * drawn with its own indirect draw command.
+   */
+  void OpenGLMesh::renderCasters(GLenum primitiveMode, const u32* casterMasks) {
+    auto& mesh = *sourceMesh;
+    u32 total = mesh.objects.totalActive();
+
+    if (total == 0 || mesh.disabled) {
+      return;
+    }
+
+    if (mesh.type == MeshType::PARTICLE_SYSTEM) {
+      render(primitiveMode, true);
+
+      return;
+    }
+
+    u32 elementOffset = 0;
+    u32 elementCount = (u32)mesh.faceElements.size();
+
+    if (mesh.lods.size() > 0) {
+      elementOffset = mesh.lods.back().elementOffset;
+      elementCount = mesh.lods.back().elementCount;
+    }
+
+    drawCommands.clear();
+
+    u32 runStart = 0;
+    bool isInRun = false;
+
+    for (u32 i = 0; i < total; i++) {
+      u32 mask = casterMasks[i >> 5];
+
+      // Skip over whole words of casters/non-casters
+      // which don't end or start a run
+      if ((i & 31) == 0 && i + 32 <= total && mask == (isInRun ? 0xFFFFFFFF : 0)) {
+        i += 31;
+
+        continue;
+      }
+
+      bool isCaster = (mask >> (i & 31)) & 1;
+
+      if (isCaster && !isInRun) {
+        runStart = i;
+        isInRun = true;
+      } else if (!isCaster && isInRun) {
+        drawCommands.push_back({ elementCount, i - runStart, elementOffset, 0, runStart });
+
+        isInRun = false;
+      }
+    }
+
+    if (isInRun) {
+      drawCommands.push_back({ elementCount, total - runStart, elementOffset, 0, runStart });
+    }
+
+    if (drawCommands.size() == 0) {
+      return;
+    }
+
+    prepareToRender();
+
+    Gm_BufferDrawElementsIndirectCommands(drawCommands.data(), (u32)drawCommands.size());
+
+    glMultiDrawElementsIndirect(primitiveMode, GL_UNSIGNED_INT, 0, (GLsizei)drawCommands.size(), 0);
+  }
+
+  /**
+   * Uploads the object matrices and colors which have changed
+   * since the last upload. Returns the number of bytes uploaded.
+   *
+   * Instance buffers are only reallocated when the object pool
+   * has been resized, which marks all of its objects dirty.
+   */
+  u32 OpenGLMesh::uploadInstanceData() {
+    if (instanceCapacity != sourceMesh->objects.max()) {
+      allocateInstanceBuffers();
+    }
+
+    return sourceMesh->objects.uploadDirtyRanges([&](PoolBuffer buffer, u32 byteOffset, u32 byteLength, const void* data) {
+      glBindBuffer(GL_ARRAY_BUFFER, buffers[buffer == PoolBuffer::MATRICES ? GLBuffer::MATRIX : GLBuffer::COLOR]);
+      glBufferSubData(GL_ARRAY_BUFFER, byteOffset, byteLength, data);
+    });
+  }
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
+#include "opengl/indirect_buffer.h"
 #include "opengl/OpenGLTexture.h"
 #include "system/entities.h"
 #include "system/type_aliases.h"
@@ -13,12 +15,14 @@ namespace Gamma {
     ~OpenGLMesh();
 
     u16 getId() const;
-    u16 getObjectCount() const;
+    u32 getObjectCount() const;
     const Mesh* getSourceMesh() const;
     bool hasNormalMap() const;
     bool hasTexture() const;
     bool isMeshType(MeshType type) const;
     void render(GLenum primitiveMode, bool useLowestLevelOfDetail = false);
+    void renderCasters(GLenum primitiveMode, const u32* casterMasks);
+    u32 uploadInstanceData();
 
   private:
     const Mesh* sourceMesh = nullptr;
@@ -32,11 +36,23 @@ namespace Gamma {
      */
     GLuint buffers[3];
     GLuint ebo;
+    /**
+     * The number of objects the instance buffers are allocated
+     * for, tracking the capacity of the source mesh's pool.
+     */
+    u32 instanceCapacity = 0;
+    /**
+     * Indirect draw commands for each level of detail with
+     * any instances, or each run of shadow casters, reused
+     * between renders.
+     */
+    std::vector<GlDrawElementsIndirectCommand> drawCommands;
     OpenGLTexture* glTexture = nullptr;
     OpenGLTexture* glNormalMap = nullptr;
     OpenGLTexture* glSpecularityMap = nullptr;
-    bool hasCreatedInstanceBuffers = false;
 
+    void allocateInstanceBuffers();
     void checkAndLoadTexture(const std::string& path, OpenGLTexture*& texture, GLenum unit);
+    void prepareToRender();
   };
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <map>
 
@@ -9,9 +10,11 @@
 
 #include "opengl/errors.h"
 #include "opengl/indirect_buffer.h"
+#include "opengl/light_cluster_buffers.h"
 #include "opengl/OpenGLRenderer.h"
 #include "opengl/OpenGLScreenQuad.h"
 #include "opengl/renderer_setup.h"
+#include "math/batch_culling.h"
 #include "math/utilities.h"
 #include "system/camera.h"
 #include "system/console.h"
@@ -67,6 +70,7 @@ namespace Gamma {
 
     // Initialize global buffers
     Gm_InitDrawIndirectBuffer();
+    Gm_InitLightClusterBuffers();
 
     // Initialize screen texture
     glGenTextures(1, &screenTexture);
@@ -128,6 +132,7 @@ namespace Gamma {
   void OpenGLRenderer::destroy() {
     Gm_DestroyRendererResources(buffers, shaders);
     Gm_DestroyDrawIndirectBuffer();
+    Gm_DestroyLightClusterBuffers();
 
     lightDisc.destroy();
 
@@ -139,6 +144,8 @@ namespace Gamma {
   void OpenGLRenderer::render() {
     auto& scene = gmContext->scene;
 
+    uploadInstanceData();
+
     // @todo consider moving this out of render() and
     // initializing probes before the rendering loop
     if (
@@ -156,8 +163,8 @@ namespace Gamma {
       Gm_DisableFlags(GammaFlags::RENDER_GLOBAL_ILLUMINATION);
 
       handleSettingsChanges();
-      initializeRendererContext();
       initializeLightArrays();
+      initializeRendererContext();
 
       for (auto& [ name, position ] : scene.probeMap) {
         createAndRenderProbe(name, position);
@@ -177,8 +184,8 @@ namespace Gamma {
     }
 
     handleSettingsChanges();
-    initializeRendererContext();
     initializeLightArrays();
+    initializeRendererContext();
     renderToAccumulationBuffer();
     renderPostEffects();
 
@@ -262,14 +269,9 @@ namespace Gamma {
 
     // Camera projection/view/inverse matrices
     ctx.activeCamera = &gmContext->scene.camera;
-    ctx.matProjection = Matrix4f::glPerspective(internalResolution, ctx.activeCamera->fov, 1.0f, 10000.0f).transpose();
+    ctx.matProjection = Gm_GetCameraProjectionMatrix(*ctx.activeCamera, internalResolution).transpose();
     ctx.matPreviousView = ctx.matView;
-
-    ctx.matView = (
-      ctx.activeCamera->rotation.toMatrix4f() *
-      // Matrix4f::rotation(ctx.activeCamera->orientation) *
-      Matrix4f::translation(ctx.activeCamera->position.invert().gl())
-    ).transpose();
+    ctx.matView = Gm_GetCameraViewMatrix(*ctx.activeCamera).transpose();
 
     if (frameFlags.useStableTemporalSampling) {
       ctx.matPreviousView = ctx.matView;
@@ -278,6 +280,10 @@ namespace Gamma {
     ctx.matInverseProjection = ctx.matProjection.inverse();
     ctx.matInverseView = ctx.matView.inverse();
 
+    // Directional shadow cascades, shared by the shadow map
+    // and shadowcaster lighting passes
+    initializeDirectionalCascades(internalResolution);
+
     // Track special object types
     ctx.hasEmissiveObjects = false;
     ctx.hasReflectiveObjects = false;
@@ -299,6 +305,21 @@ namespace Gamma {
     }
   }
 
+  /**
+   * Builds the shadow cascades of each directional shadowcaster
+   * for the active camera. Must follow initializeLightArrays().
+   */
+  void OpenGLRenderer::initializeDirectionalCascades(const Area<u32>& resolution) {
+    auto& camera = *ctx.activeCamera;
+    auto& settings = gmContext->scene.shadowCascades;
+
+    ctx.directionalCascades.resize(ctx.directionalShadowcasters.size());
+
+    for (u32 i = 0; i < ctx.directionalShadowcasters.size(); i++) {
+      ctx.directionalCascades[i].build(settings, ctx.directionalShadowcasters[i]->direction, camera, resolution);
+    }
+  }
+
   /**
    * @todo description
    */
@@ -380,7 +401,14 @@ namespace Gamma {
       renderDirectionalShadowcasters();
     }
 
-    if (ctx.spotLights.size() > 0) {
+    bool shouldRenderClusteredLights = (
+      Gm_IsFlagEnabled(GammaFlags::RENDER_CLUSTERED_LIGHTS) &&
+      (ctx.spotLights.size() > 0 || ctx.pointLights.size() > 0)
+    );
+
+    if (shouldRenderClusteredLights) {
+      renderClusteredLights();
+    } else if (ctx.spotLights.size() > 0) {
       renderSpotLights();
     }
 
@@ -388,7 +416,7 @@ namespace Gamma {
       renderSpotShadowcasters();
     }
 
-    if (ctx.pointLights.size() > 0) {
+    if (!shouldRenderClusteredLights && ctx.pointLights.size() > 0) {
       renderPointLights();
     }
 
@@ -556,7 +584,6 @@ namespace Gamma {
    * @todo description
    */
   void OpenGLRenderer::renderDirectionalShadowMaps() {
-    auto& camera = *ctx.activeCamera;
     auto& shader = shaders.shadowLightView;
 
     shader.use();
@@ -565,15 +592,15 @@ namespace Gamma {
 
     for (u32 mapIndex = 0; mapIndex < glDirectionalShadowMaps.size(); mapIndex++) {
       auto& glShadowMap = *glDirectionalShadowMaps[mapIndex];
-      auto& light = *ctx.directionalShadowcasters[mapIndex];
+      auto& cascades = ctx.directionalCascades[mapIndex];
 
       glShadowMap.buffer.write();
 
-      for (u32 cascade = 0; cascade < 3; cascade++) {
+      for (u32 cascade = 0; cascade < cascades.size(); cascade++) {
         glShadowMap.buffer.writeToAttachment(cascade);
-        Matrix4f matLightViewProjection = Gm_CreateCascadedLightViewProjectionMatrixGL(cascade, light.direction, camera);
+        auto& casterFrustum = cascades[cascade].casterFrustum;
 
-        shader.setMatrix4f("matLightViewProjection", matLightViewProjection);
+        shader.setMatrix4f("matLightViewProjection", cascades[cascade].matLightViewProjection);
 
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -582,14 +609,23 @@ namespace Gamma {
         for (auto* glMesh : glMeshes) {
           auto* sourceMesh = glMesh->getSourceMesh();
           auto& foliage = sourceMesh->foliage;
+          auto& objects = sourceMesh->objects;
+
+          if (!sourceMesh->canCastShadows || sourceMesh->maxCascade < cascade) {
+            continue;
+          }
+
+          // Only draw the objects within the cascade's caster
+          // volume, whether or not they're visible to the camera
+          casterMasks.resize(Gm_GetVisibilityMaskSize(objects.totalActive()));
+
+          Gm_ComputeSphereVisibility(casterFrustum, objects.getBounds(), casterMasks.data(), objects.totalActive());
 
           shader.setInt("foliage.type", foliage.type);
           shader.setFloat("foliage.speed", foliage.speed);
           shader.setBool("hasTexture", glMesh->hasTexture());
 
-          if (sourceMesh->canCastShadows && sourceMesh->maxCascade >= cascade) {
-            glMesh->render(ctx.primitiveMode, true);
-          }
+          glMesh->renderCasters(ctx.primitiveMode, casterMasks.data());
         }
       }
     }
@@ -600,6 +636,7 @@ namespace Gamma {
    */
   void OpenGLRenderer::renderSpotShadowMaps() {
     auto& shader = shaders.shadowLightView;
+    Matrix4f invertZ = Matrix4f::scale(Vec3f(1.0f, 1.0f, -1.0f));
 
     shader.use();
     shader.setInt("meshTexture", 0);
@@ -615,6 +652,8 @@ namespace Gamma {
       Matrix4f matLightProjection = Matrix4f::glPerspective({ 1024, 1024 }, 120.0f, 1.0f, light.radius);
       Matrix4f matLightView = Matrix4f::lookAt(light.position.gl(), light.direction.invert().gl(), Vec3f(0.0f, 1.0f, 0.0f));
       Matrix4f matLightViewProjection = (matLightProjection * matLightView).transpose();
+      Frustum lightFrustum = Frustum::fromMatrix(matLightProjection * matLightView * invertZ);
+      float coneHalfAngle = Gm_GetSpotLightHalfAngle(light.fov);
 
       glShadowMap.buffer.write();
 
@@ -630,13 +669,31 @@ namespace Gamma {
         // @todo check foliage behavior for correctness
         auto& foliage = sourceMesh->foliage;
 
+        auto& objects = sourceMesh->objects;
+        u32 total = objects.totalActive();
+        u32 totalWords = Gm_GetVisibilityMaskSize(total);
+
+        if (!sourceMesh->canCastShadows) {
+          continue;
+        }
+
+        // Only draw objects inside both the shadow map
+        // frustum and the light cone
+        casterMasks.resize(totalWords);
+        rangeMasks.resize(totalWords);
+
+        Gm_ComputeSphereVisibility(lightFrustum, objects.getBounds(), casterMasks.data(), total);
+        Gm_ComputeSphereConeVisibility(light.position, light.direction.unit(), coneHalfAngle, light.radius, objects.getBounds(), rangeMasks.data(), total);
+
+        for (u32 i = 0; i < totalWords; i++) {
+          casterMasks[i] &= rangeMasks[i];
+        }
+
         shader.setInt("foliage.type", foliage.type);
         shader.setFloat("foliage.speed", foliage.speed);
         shader.setBool("hasTexture", glMesh->hasTexture());
 
-        if (sourceMesh->canCastShadows) {
-          glMesh->render(ctx.primitiveMode, true);
-        }
+        glMesh->renderCasters(ctx.primitiveMode, casterMasks.data());
       }
 
       glShadowMap.isRendered = true;
@@ -649,6 +706,8 @@ namespace Gamma {
   void OpenGLRenderer::renderPointShadowMaps() {
     auto& shader = shaders.pointShadowcasterView;
 
+    Matrix4f invertZ = Matrix4f::scale(Vec3f(1.0f, 1.0f, -1.0f));
+
     shader.use();
 
     for (u32 mapIndex = 0; mapIndex < glPointShadowMaps.size(); mapIndex++) {
@@ -663,6 +722,8 @@ namespace Gamma {
 
       glClear(GL_DEPTH_BUFFER_BIT);
 
+      Frustum faceFrustums[6];
+
       for (u32 i = 0; i < 6; i++) {
         auto& direction = CUBE_MAP_DIRECTIONS[i];
         auto& upDirection = CUBE_MAP_UP_DIRECTIONS[i];
@@ -672,6 +733,8 @@ namespace Gamma {
         Matrix4f matLightView = Matrix4f::lookAt(light.position.gl(), direction, upDirection);
         Matrix4f lightMatrix = (matLightProjection * matLightView).transpose();
 
+        faceFrustums[i] = Frustum::fromMatrix(matLightProjection * matLightView * invertZ);
+
         shader.setMatrix4f("lightMatrices[" + std::to_string(i) + "]", lightMatrix);
       }
 
@@ -683,11 +746,46 @@ namespace Gamma {
       // @todo allow specific meshes to be associated with point lights + rendered to shadow maps
       for (auto* glMesh : glMeshes) {
         auto* sourceMesh = glMesh->getSourceMesh();
+        auto& objects = sourceMesh->objects;
+        u32 total = objects.totalActive();
+        u32 totalWords = Gm_GetVisibilityMaskSize(total);
+        u32 activeFaces = 0;
 
         // @todo handle foliage (requires point shadowcaster view shader updates)
 
-        if (sourceMesh->canCastShadows) {
-          glMesh->render(ctx.primitiveMode, true);
+        if (!sourceMesh->canCastShadows) {
+          continue;
+        }
+
+        // Only draw objects within the light's radius, and only
+        // into the cube faces any of those objects overlap
+        rangeMasks.resize(totalWords);
+        faceMasks.resize(totalWords);
+        casterMasks.assign(totalWords, 0);
+
+        Gm_ComputeSphereProximity(light.position, light.radius, objects.getBounds(), rangeMasks.data(), total);
+
+        for (u32 face = 0; face < 6; face++) {
+          u32 faceWords = 0;
+
+          Gm_ComputeSphereVisibility(faceFrustums[face], objects.getBounds(), faceMasks.data(), total);
+
+          for (u32 i = 0; i < totalWords; i++) {
+            u32 word = faceMasks[i] & rangeMasks[i];
+
+            casterMasks[i] |= word;
+            faceWords |= word;
+          }
+
+          if (faceWords != 0) {
+            activeFaces |= 1 << face;
+          }
+        }
+
+        if (activeFaces != 0) {
+          shader.setInt("activeFaces", activeFaces);
+
+          glMesh->renderCasters(ctx.primitiveMode, casterMasks.data());
         }
       }
 
@@ -770,6 +868,7 @@ namespace Gamma {
     for (u32 i = 0; i < ctx.directionalShadowcasters.size(); i++) {
       auto& glShadowMap = *glDirectionalShadowMaps[i];
       auto& light = *glShadowMap.light;
+      auto& cascades = ctx.directionalCascades[i];
 
       glShadowMap.buffer.read();
 
@@ -780,9 +879,15 @@ namespace Gamma {
       shader.setInt("texShadowMaps[0]", 3);
       shader.setInt("texShadowMaps[1]", 4);
       shader.setInt("texShadowMaps[2]", 5);
-      shader.setMatrix4f("lightMatrices[0]", Gm_CreateCascadedLightViewProjectionMatrixGL(0, light.direction, camera));
-      shader.setMatrix4f("lightMatrices[1]", Gm_CreateCascadedLightViewProjectionMatrixGL(1, light.direction, camera));
-      shader.setMatrix4f("lightMatrices[2]", Gm_CreateCascadedLightViewProjectionMatrixGL(2, light.direction, camera));
+      shader.setInt("totalCascades", cascades.size());
+
+      for (u32 cascade = 0; cascade < cascades.size(); cascade++) {
+        std::string index = std::to_string(cascade);
+
+        shader.setMatrix4f("lightMatrices[" + index + "]", cascades[cascade].matLightViewProjection);
+        shader.setFloat("cascadeDepths[" + index + "]", cascades[cascade].farDepth);
+      }
+
       shader.setVec3f("cameraPosition", camera.position);
       shader.setMatrix4f("matInverseProjection", ctx.matInverseProjection);
       shader.setMatrix4f("matInverseView", ctx.matInverseView);
@@ -859,6 +964,33 @@ namespace Gamma {
     lightDisc.draw(ctx.pointLights, internalResolution, *ctx.activeCamera);
   }
 
+  /**
+   * Renders all point and spot lights in one full-screen pass,
+   * with each fragment only shading the lights binned into its
+   * cluster, rather than drawing a light disc per light.
+   */
+  void OpenGLRenderer::renderClusteredLights() {
+    auto& camera = *ctx.activeCamera;
+    auto& shader = shaders.clusteredLights;
+
+    lightClusters.build(camera, internalResolution, ctx.pointLights, ctx.spotLights);
+
+    Gm_BufferLightClusters(lightClusters);
+
+    shader.use();
+    shader.setVec4f("transform", FULL_SCREEN_TRANSFORM);
+    shader.setInt("texColorAndDepth", 0);
+    shader.setInt("texNormalAndEmissivity", 1);
+    shader.setVec3f("cameraPosition", camera.position);
+    shader.setMatrix4f("matInverseProjection", ctx.matInverseProjection);
+    shader.setMatrix4f("matInverseView", ctx.matInverseView);
+    shader.setFloat("cameraNearPlane", CAMERA_NEAR_PLANE);
+    shader.setFloat("cameraFarPlane", CAMERA_FAR_PLANE);
+    shader.setInt("totalPointLights", lightClusters.totalPointLights());
+
+    OpenGLScreenQuad::render();
+  }
+
   /**
    * @todo description
    */
@@ -1459,6 +1591,8 @@ namespace Gamma {
       ctx.matInverseProjection = ctx.matProjection.inverse();
       ctx.matInverseView = ctx.matView.inverse();
 
+      initializeDirectionalCascades({ 1024, 1024 });
+
       renderToAccumulationBuffer();
 
       ctx.accumulationSource->read();
@@ -1521,4 +1655,16 @@ namespace Gamma {
     ctx.accumulationSource = ctx.accumulationTarget;
     ctx.accumulationTarget = source;
   }
+
+  /**
+   * Uploads changed object matrices/colors for all meshes once
+   * per frame, ahead of any render passes which use them.
+   */
+  void OpenGLRenderer::uploadInstanceData() {
+    stats.instanceBytesUploaded = 0;
+
+    for (auto* glMesh : glMeshes) {
+      stats.instanceBytesUploaded += glMesh->uploadInstanceData();
+    }
+  }
 }
\ No newline at end of file
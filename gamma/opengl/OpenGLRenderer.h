@@ -12,7 +12,9 @@
 #include "opengl/shader.h"
 #include "opengl/shadowmaps.h"
 #include "system/AbstractRenderer.h"
+#include "system/CascadeSet.h"
 #include "system/entities.h"
+#include "system/LightClusters.h"
 #include "system/type_aliases.h"
 
 namespace Gamma {
@@ -34,6 +36,7 @@ namespace Gamma {
     OpenGLShader directionalLight;
     OpenGLShader spotLight;
     OpenGLShader pointLight;
+    OpenGLShader clusteredLights;
     OpenGLShader indirectLight;
     OpenGLShader indirectLightComposite;
     OpenGLShader skybox;
@@ -70,6 +73,9 @@ namespace Gamma {
     std::vector<Light*> directionalShadowcasters;
     std::vector<Light*> spotLights;
     std::vector<Light*> spotShadowcasters;
+    // Shadow cascades of each directional shadowcaster,
+    // built once per frame for the active camera
+    std::vector<CascadeSet> directionalCascades;
     Camera* activeCamera = nullptr;
     Matrix4f matProjection;
     Matrix4f matInverseProjection;
@@ -112,6 +118,20 @@ namespace Gamma {
     std::vector<OpenGLPointShadowMap*> glPointShadowMaps;
     std::vector<OpenGLSpotShadowMap*> glSpotShadowMaps;
     std::map<std::string, OpenGLCubeMap*> glProbes;
+    /**
+     * Caster visibility bits for the mesh being rendered
+     * to a shadow map, reused across meshes and lights.
+     * Range/face bits are intermediate tests combined
+     * into the caster bits for point and spot lights.
+     */
+    std::vector<u32> casterMasks;
+    std::vector<u32> rangeMasks;
+    std::vector<u32> faceMasks;
+    /**
+     * Point and spot lights binned by view space cluster,
+     * for rendering them in a single clustered lighting pass.
+     */
+    LightClusters lightClusters;
     bool areProbesRendered = false;
 
     struct PostShaders {
@@ -129,6 +149,7 @@ namespace Gamma {
     void renderSpotLights();
     void renderSpotShadowcasters();
     void renderPointLights();
+    void renderClusteredLights();
     void renderPointShadowcasters();
     void copyEmissiveObjects();
     void renderIndirectLight();
@@ -142,10 +163,12 @@ namespace Gamma {
 
     void createAndRenderProbe(const std::string& name, const Vec3f& position);
     void handleSettingsChanges();
+    void initializeDirectionalCascades(const Area<u32>& resolution);
     void initializeRendererContext();
     void initializeLightArrays();
     void renderSurfaceToScreen(SDL_Surface* surface, u32 x, u32 y, const Vec3f& color, const Vec4f& background);
     void renderToAccumulationBuffer();
     void swapAccumulationBuffers();
+    void uploadInstanceData();
   };
 }
\ No newline at end of file
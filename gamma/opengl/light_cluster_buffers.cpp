@@ -0,0 +1,62 @@
+#include "opengl/light_cluster_buffers.h"
+
+#include "glew.h"
+
+namespace Gamma {
+  /**
+   * Shader storage buffer binding points for clustered
+   * lighting, matching clustered-lights.frag.glsl.
+   */
+  constexpr static GLuint LIGHTS_BINDING = 0;
+  constexpr static GLuint CLUSTERS_BINDING = 1;
+  constexpr static GLuint LIGHT_INDICES_BINDING = 2;
+
+  GLuint glLightClusterBuffers[3] = { 0, 0, 0 };
+  GLsizeiptr lightClusterBufferCapacities[3] = { 0, 0, 0 };
+
+  /**
+   * Uploads a buffer's data, only reallocating the buffer store
+   * when the data outgrows it. The store is never empty, since
+   * binding an empty buffer is an error.
+   */
+  static void bufferStorage(u8 index, GLuint binding, const void* data, GLsizeiptr size) {
+    GLuint buffer = glLightClusterBuffers[index];
+    GLsizeiptr& capacity = lightClusterBufferCapacities[index];
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+
+    if (capacity == 0 || size > capacity) {
+      capacity = size > 0 ? size : sizeof(u32);
+
+      glBufferData(GL_SHADER_STORAGE_BUFFER, capacity, nullptr, GL_DYNAMIC_DRAW);
+    }
+
+    if (size > 0) {
+      glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+  }
+
+  void Gm_InitLightClusterBuffers() {
+    glGenBuffers(3, glLightClusterBuffers);
+  }
+
+  void Gm_BufferLightClusters(const LightClusters& lightClusters) {
+    auto& lights = lightClusters.getLights();
+    auto& clusters = lightClusters.getClusters();
+    auto& lightIndices = lightClusters.getLightIndices();
+
+    bufferStorage(0, LIGHTS_BINDING, lights.data(), lights.size() * sizeof(ClusterLight));
+    bufferStorage(1, CLUSTERS_BINDING, clusters.data(), clusters.size() * sizeof(LightCluster));
+    bufferStorage(2, LIGHT_INDICES_BINDING, lightIndices.data(), lightIndices.size() * sizeof(u32));
+  }
+
+  void Gm_DestroyLightClusterBuffers() {
+    glDeleteBuffers(3, glLightClusterBuffers);
+
+    for (u8 i = 0; i < 3; i++) {
+      lightClusterBufferCapacities[i] = 0;
+    }
+  }
+}
\ No newline at end of file
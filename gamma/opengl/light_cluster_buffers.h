@@ -0,0 +1,9 @@
+#pragma once
+
+#include "system/LightClusters.h"
+
+namespace Gamma {
+  void Gm_InitLightClusterBuffers();
+  void Gm_BufferLightClusters(const LightClusters& lightClusters);
+  void Gm_DestroyLightClusterBuffers();
+}
\ No newline at end of file
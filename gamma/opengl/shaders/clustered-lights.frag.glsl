@@ -0,0 +1,163 @@
+#version 460 core
+
+// Cluster grid dimensions, matching LightClusters.h
+#define CLUSTERS_X 16
+#define CLUSTERS_Y 9
+#define CLUSTERS_Z 24
+
+struct Light {
+  vec3 position;
+  float radius;
+  vec3 color;
+  float power;
+  vec3 direction;
+  float fov;
+};
+
+struct Cluster {
+  uint offset;
+  uint count;
+};
+
+layout (std430, binding = 0) readonly buffer Lights {
+  Light lights[];
+};
+
+layout (std430, binding = 1) readonly buffer Clusters {
+  Cluster clusters[];
+};
+
+layout (std430, binding = 2) readonly buffer LightIndices {
+  uint lightIndices[];
+};
+
+uniform sampler2D texColorAndDepth;
+uniform sampler2D texNormalAndEmissivity;
+uniform vec3 cameraPosition;
+uniform mat4 matInverseProjection;
+uniform mat4 matInverseView;
+uniform float cameraNearPlane;
+uniform float cameraFarPlane;
+uniform int totalPointLights;
+
+noperspective in vec2 fragUv;
+
+layout (location = 0) out vec4 out_colorAndDepth;
+
+#include "utils/conversion.glsl";
+
+/**
+ * Returns the index of the cluster containing a fragment,
+ * with depth slices spaced exponentially between the near
+ * and far planes.
+ */
+uint getClusterIndex(vec2 frag_uv, float depth) {
+  vec4 view_position = matInverseProjection * vec4(frag_uv * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+  float view_depth = -view_position.z / view_position.w;
+  float slice = floor(log(view_depth / cameraNearPlane) / log(cameraFarPlane / cameraNearPlane) * CLUSTERS_Z);
+  uvec3 cluster = uvec3(
+    clamp(floor(frag_uv * vec2(CLUSTERS_X, CLUSTERS_Y)), vec2(0.0), vec2(CLUSTERS_X - 1, CLUSTERS_Y - 1)),
+    clamp(slice, 0.0, CLUSTERS_Z - 1)
+  );
+
+  return cluster.z * CLUSTERS_X * CLUSTERS_Y + cluster.y * CLUSTERS_X + cluster.x;
+}
+
+/**
+ * Returns the light a point light contributes to a surface,
+ * following inline/point-light.glsl.
+ */
+vec3 getPointLightColor(Light light, vec3 position, vec3 normal, vec3 color) {
+  vec3 surface_to_light = light.position - position;
+  float light_distance = length(surface_to_light);
+
+  if (light_distance > light.radius) {
+    return vec3(0.0);
+  }
+
+  vec3 normalized_surface_to_light = surface_to_light / light_distance;
+  vec3 normalized_surface_to_camera = normalize(cameraPosition - position);
+  vec3 half_vector = normalize(normalized_surface_to_light + normalized_surface_to_camera);
+  float incidence = max(dot(normalized_surface_to_light, normal), 0.0);
+  float attenuation = pow(1.0 / light_distance, 2);
+  float specularity = pow(max(dot(half_vector, normal), 0.0), 50);
+
+  // Define a non-linear light intensity fall-off toward the radius boundary
+  float hack_diffuse_radial_influence = (1.0 - pow(clamp(light_distance / light.radius, 0.0, 1.0), 2));
+  float hack_specular_radial_influence = (1.0 - pow(clamp(light_distance / light.radius, 0.0, 1.0), 10));
+  // Taper light intensity more softly to preserve light with distance
+  float hack_soft_tapering = (20.0 * (light_distance / light.radius));
+
+  vec3 radiant_flux = light.color * light.power * light.radius;
+  vec3 diffuse_term = color * radiant_flux * incidence * attenuation * hack_diffuse_radial_influence * hack_soft_tapering * (1.0 - specularity);
+  vec3 specular_term = 5.0 * radiant_flux * specularity * attenuation * hack_specular_radial_influence;
+
+  return diffuse_term + specular_term;
+}
+
+/**
+ * Returns the light a spot light contributes to a surface,
+ * following inline/spot-light.glsl.
+ */
+vec3 getSpotLightColor(Light light, vec3 position, vec3 normal, vec3 color) {
+  vec3 surface_to_light = light.position - position;
+  float light_distance = length(surface_to_light);
+
+  if (light_distance > light.radius) {
+    return vec3(0.0);
+  }
+
+  vec3 normalized_surface_to_light = surface_to_light / light_distance;
+  float fragment_alignment = dot(normalized_surface_to_light * -1, normalize(light.direction));
+  float cone_edge_alignment = 1.0 - (light.fov / 180.0);
+
+  if (fragment_alignment < cone_edge_alignment) {
+    return vec3(0.0);
+  }
+
+  float cone_edge_range = 1.0 - cone_edge_alignment;
+  float cone_edge_proximity = fragment_alignment - cone_edge_alignment;
+  float spot_factor = sqrt(cone_edge_proximity / cone_edge_range);
+
+  vec3 normalized_surface_to_camera = normalize(cameraPosition - position);
+  vec3 half_vector = normalize(normalized_surface_to_light + normalized_surface_to_camera);
+  float incidence = max(dot(normalized_surface_to_light, normal), 0.0);
+  float attenuation = pow(1.0 / light_distance, 2);
+  float specularity = pow(max(dot(half_vector, normal), 0.0), 50);
+
+  // Have light intensity 'fall off' toward radius boundary
+  float hack_radial_influence = max(1.0 - light_distance / light.radius, 0.0);
+  // Taper light intensity more softly to preserve light with distance
+  float hack_soft_tapering = (20.0 * (light_distance / light.radius));
+
+  vec3 radiant_flux = light.color * light.power * light.radius;
+  vec3 diffuse_term = color * radiant_flux * incidence * attenuation * hack_radial_influence * hack_soft_tapering * (1.0 - specularity);
+  vec3 specular_term = 5.0 * radiant_flux * specularity * attenuation;
+
+  return (diffuse_term + specular_term) * spot_factor;
+}
+
+void main() {
+  vec4 frag_color_and_depth = texture(texColorAndDepth, fragUv);
+  vec4 frag_normal_and_emissivity = texture(texNormalAndEmissivity, fragUv);
+  vec3 position = getWorldPosition(frag_color_and_depth.w, fragUv, matInverseProjection, matInverseView);
+  vec3 normal = frag_normal_and_emissivity.xyz;
+  vec3 color = frag_color_and_depth.rgb;
+  float emissivity = frag_normal_and_emissivity.w;
+  Cluster cluster = clusters[getClusterIndex(fragUv, frag_color_and_depth.w)];
+
+  vec3 accumulatedColor = vec3(0.0);
+
+  for (uint i = cluster.offset; i < cluster.offset + cluster.count; i++) {
+    uint lightIndex = lightIndices[i];
+
+    // Point lights come first, followed by spot lights
+    if (lightIndex < uint(totalPointLights)) {
+      accumulatedColor += getPointLightColor(lights[lightIndex], position, normal, color);
+    } else {
+      accumulatedColor += getSpotLightColor(lights[lightIndex], position, normal, color);
+    }
+  }
+
+  out_colorAndDepth = vec4(accumulatedColor * (1.0 - emissivity), frag_color_and_depth.w);
+}
\ No newline at end of file
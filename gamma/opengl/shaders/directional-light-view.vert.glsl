@@ -13,10 +13,13 @@ layout (location = 5) in mat4 modelMatrix;
 // out vec2 fragUv;
 
 #include "utils/gl.glsl";
+#include "utils/instancing.glsl";
 
 void main() {
+  mat4 model_matrix = getInstanceMatrix(modelMatrix);
+
   // @hack invert Z
-  gl_Position = matLightView * glVec4(modelMatrix * vec4(vertexPosition, 1.0));
+  gl_Position = matLightView * glVec4(model_matrix * vec4(vertexPosition, 1.0));
 
   // @todo once mesh textures are checked for alpha
   // fragUv = vertexUv;
@@ -23,23 +23,22 @@ uniform vec3 cameraPosition;
 uniform mat4 matInverseProjection;
 uniform mat4 matInverseView;
 uniform mat4 lightMatrices[3];
+uniform float cascadeDepths[3];
+uniform int totalCascades;
 uniform DirectionalLight light;
 
 noperspective in vec2 fragUv;
 
 layout (location = 0) out vec4 out_color_and_depth;
 
-const float cascade_depth_1 = 200.0;
-const float cascade_depth_2 = 600.0;
-
 #include "utils/gl.glsl";
 #include "utils/conversion.glsl";
 #include "utils/random.glsl";
 
 Cascade getCascadeByDepth(float linearized_depth) {
-  if (linearized_depth < cascade_depth_1) {
+  if (linearized_depth < cascadeDepths[0] || totalCascades == 1) {
     return Cascade(0, lightMatrices[0], 0.0002, 1000.0, 20.0);
-  } else if (linearized_depth < cascade_depth_2) {
+  } else if (linearized_depth < cascadeDepths[1] || totalCascades == 2) {
     return Cascade(1, lightMatrices[1], 0.0005, 750.0, 5.0);
   } else {
     return Cascade(2, lightMatrices[2], 0.0005, 500.0, 3.0);
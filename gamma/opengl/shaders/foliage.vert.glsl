@@ -18,6 +18,7 @@ out vec3 fragBitangent;
 out vec2 fragUv;
 
 #include "utils/gl.glsl";
+#include "utils/instancing.glsl";
 #include "utils/foliage.glsl";
 
 /**
@@ -46,9 +47,11 @@ vec3 unpack(uint color) {
 }
 
 void main() {
+  mat4 model_matrix = getInstanceMatrix(modelMatrix);
+
   // @hack invert Z
-  vec4 world_position = glVec4(modelMatrix * vec4(vertexPosition, 1.0));
-  mat3 normal_matrix = transpose(inverse(mat3(modelMatrix)));
+  vec4 world_position = glVec4(model_matrix * vec4(vertexPosition, 1.0));
+  mat3 normal_matrix = transpose(inverse(mat3(model_matrix)));
 
   // @todo make a utility for this
   switch (foliage.type) {
@@ -18,6 +18,7 @@ out vec3 fragBitangent;
 out vec2 fragUv;
 
 #include "utils/gl.glsl";
+#include "utils/instancing.glsl";
 
 /**
  * Returns a bitangent from potentially non-orthonormal
@@ -45,9 +46,11 @@ vec3 unpack(uint color) {
 }
 
 void main() {
+  mat4 model_matrix = getInstanceMatrix(modelMatrix);
+
   // @hack invert Z
-  vec4 world_position = glVec4(modelMatrix * vec4(vertexPosition, 1.0));
-  mat3 normal_matrix = transpose(inverse(mat3(modelMatrix)));
+  vec4 world_position = glVec4(model_matrix * vec4(vertexPosition, 1.0));
+  mat3 normal_matrix = transpose(inverse(mat3(model_matrix)));
 
   gl_Position = matProjection * matView * world_position;
 
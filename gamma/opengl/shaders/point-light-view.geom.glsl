@@ -1,6 +1,8 @@
 #version 460 core
 
 uniform mat4 lightMatrices[6];
+// Bit f is set if any objects being rendered overlap face f
+uniform int activeFaces;
 
 layout (triangles) in;
 layout (triangle_strip, max_vertices = 18) out;
@@ -9,6 +11,10 @@ out vec4 world_position;
 
 void main() {
   for (int f = 0; f < 6; f++) {
+    if ((activeFaces & (1 << f)) == 0) {
+      continue;
+    }
+
     gl_Layer = f;
 
     for (int v = 0; v < 3; v++) {
@@ -8,8 +8,11 @@ layout (location = 4) in uint modelColor;
 layout (location = 5) in mat4 modelMatrix;
 
 #include "utils/gl.glsl";
+#include "utils/instancing.glsl";
 
 void main() {
+  mat4 model_matrix = getInstanceMatrix(modelMatrix);
+
   // @hack invert Z
-  gl_Position = glVec4(modelMatrix * vec4(vertexPosition, 1.0));
+  gl_Position = glVec4(model_matrix * vec4(vertexPosition, 1.0));
 }
\ No newline at end of file
@@ -12,11 +12,14 @@ layout (location = 5) in mat4 modelMatrix;
 out vec2 fragUv;
 
 #include "utils/gl.glsl";
+#include "utils/instancing.glsl";
 #include "utils/foliage.glsl";
 
 void main() {
+  mat4 model_matrix = getInstanceMatrix(modelMatrix);
+
   // @hack invert Z
-  vec4 world_position = glVec4(modelMatrix * vec4(vertexPosition, 1.0));
+  vec4 world_position = glVec4(model_matrix * vec4(vertexPosition, 1.0));
 
   // @todo make a utility for this
   switch (foliage.type) {
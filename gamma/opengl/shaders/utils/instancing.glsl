@@ -0,0 +1,14 @@
+/**
+ * Returns the full model matrix for an instance. Instances
+ * using AFFINE matrices only provide the first three rows of
+ * each column, so the last row, which the vertex attributes
+ * otherwise fill in as (1, 1, 1, 1), is restored here.
+ */
+mat4 getInstanceMatrix(mat4 model_matrix) {
+  model_matrix[0][3] = 0.0;
+  model_matrix[1][3] = 0.0;
+  model_matrix[2][3] = 0.0;
+  model_matrix[3][3] = 1.0;
+
+  return model_matrix;
+}
\ No newline at end of file
@@ -1,10 +1,12 @@
 #pragma once
 
+#include "math/frustum.h"
 #include "math/matrix.h"
 #include "math/vector.h"
 #include "opengl/framebuffer.h"
 #include "opengl/shader.h"
 #include "system/camera.h"
+#include "system/CascadeSet.h"
 #include "system/entities.h"
 
 namespace Gamma {
@@ -30,6 +32,4 @@ namespace Gamma {
 
     OpenGLSpotShadowMap(const Light* light);
   };
-
-  Matrix4f Gm_CreateCascadedLightViewProjectionMatrixGL(u8 cascade, const Vec3f& lightDirection, const Camera& camera);
 }
\ No newline at end of file
@@ -23,6 +23,11 @@ namespace Gamma {
   struct RenderStats {
     u32 gpuMemoryTotal;
     u32 gpuMemoryUsed;
+    /**
+     * The number of bytes of object matrix/color data
+     * uploaded to the GPU during the last frame.
+     */
+    u32 instanceBytesUploaded = 0;
     bool isVSynced;
   };
 
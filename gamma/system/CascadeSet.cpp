@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "math/constants.h"
+#include "system/CascadeSet.h"
+
+namespace Gamma {
+  /**
+   * How far behind each cascade's bounding sphere its shadow
+   * map extends toward the light, so that casters outside the
+   * sphere still write their depths.
+   */
+  constexpr static float CASCADE_CASTER_DEPTH = 1000.0f;
+
+  const Cascade& CascadeSet::operator[](u32 index) const {
+    return cascades[index];
+  }
+
+  /**
+   * Builds the cascades of a directional light for a camera,
+   * given the resolution the camera's view is rendered at.
+   *
+   * @see https://alextardif.com/shadowmapping.html
+   */
+  void CascadeSet::build(const CascadeSettings& settings, const Vec3f& lightDirection, const Camera& camera, const Area<u32>& resolution) {
+    float splits[MAX_SHADOW_CASCADES + 1];
+    CascadeSettings clampedSettings = settings;
+
+    clampedSettings.totalCascades = std::max(1u, std::min(settings.totalCascades, MAX_SHADOW_CASCADES));
+
+    Gm_ComputeCascadeSplits(clampedSettings, splits);
+
+    totalCascades = clampedSettings.totalCascades;
+
+    float tanHalfFovY = tanf(camera.fov / 2.0f * DEGREES_TO_RADIANS);
+    float tanHalfFovX = tanHalfFovY * (float)resolution.width / (float)resolution.height;
+    float slope = sqrtf(tanHalfFovX * tanHalfFovX + tanHalfFovY * tanHalfFovY);
+
+    // The camera's view matrix is a rotation followed by a translation,
+    // so view space is rotated back into world space with the transposed
+    // rotation, in place of inverting the camera matrix
+    Matrix4f cameraRotation = camera.rotation.toMatrix4f();
+    Vec3f cameraForward = Vec3f(-cameraRotation.m[8], -cameraRotation.m[9], -cameraRotation.m[10]);
+    Vec3f cameraPosition = camera.position.gl();
+
+    // Light space axes, matching Matrix4f::lookAt(). Light space is
+    // a rotation, so it's also undone by transposing rather than
+    // inverting it.
+    bool isVerticalFacingLight = lightDirection == Vec3f(0, 1, 0) || lightDirection == Vec3f(0, -1, 0);
+    Vec3f topVector = isVerticalFacingLight ? Vec3f(0, 0, 1) : Vec3f(0, 1, 0);
+    Vec3f forward = lightDirection.invert().unit();
+    Vec3f right = Vec3f::cross(topVector, forward).unit();
+    Vec3f up = Vec3f::cross(forward, right).unit();
+
+    Matrix4f invertZ = Matrix4f::scale(Vec3f(1.0f, 1.0f, -1.0f));
+
+    for (u32 i = 0; i < totalCascades; i++) {
+      auto& cascade = cascades[i];
+      float nearDepth = splits[i];
+      float farDepth = splits[i + 1];
+
+      // The frustum slice's corners average out to a point on the
+      // view axis, halfway between its near and far planes. Its
+      // bounding sphere only depends on the slice's shape, and
+      // not on the camera's orientation, which keeps its radius
+      // (and with it the shadow map's texel size) stable.
+      float centerDepth = (nearDepth + farDepth) * 0.5f;
+      float nearCornerRadius = sqrtf(nearDepth * nearDepth * slope * slope + (centerDepth - nearDepth) * (centerDepth - nearDepth));
+      float farCornerRadius = sqrtf(farDepth * farDepth * slope * slope + (farDepth - centerDepth) * (farDepth - centerDepth));
+      float radius = std::max(nearCornerRadius, farCornerRadius);
+
+      Vec3f center = cameraPosition + cameraForward * centerDepth;
+
+      center.z *= -1.0f;
+
+      // Snap the center to the shadow map texel grid, to avoid
+      // warbling and other distortions when moving the camera
+      float texelsPerUnit = (float)DIRECTIONAL_SHADOW_MAP_SIZE / (radius * 2.0f);
+      float texelX = floorf(Vec3f::dot(right, center) * texelsPerUnit);
+      float texelY = floorf(Vec3f::dot(up, center) * texelsPerUnit);
+      float texelZ = Vec3f::dot(forward, center) * texelsPerUnit;
+
+      center = (right * texelX + up * texelY + forward * texelZ) / texelsPerUnit;
+
+      Matrix4f matProjection = Matrix4f::orthographic(radius, -radius, -radius, radius, -radius - CASCADE_CASTER_DEPTH, radius);
+      Matrix4f matView = Matrix4f::lookAt(center.gl(), lightDirection.invert().gl(), topVector);
+      Matrix4f matViewProjection = matProjection * matView;
+
+      cascade.matLightViewProjection = matViewProjection.transpose();
+      cascade.nearDepth = nearDepth;
+      cascade.farDepth = farDepth;
+
+      // Casters between the light and the cascade can still cast
+      // shadows into it, so remove the caster volume's near plane
+      cascade.casterFrustum = Frustum::fromMatrix(matViewProjection * invertZ);
+      cascade.casterFrustum.planes[4].normal = Vec3f(0.0f);
+      cascade.casterFrustum.planes[4].distance = FLT_MAX;
+    }
+  }
+
+  u32 CascadeSet::size() const {
+    return totalCascades;
+  }
+
+  /**
+   * Gm_ComputeCascadeSplits()
+   * -------------------------
+   *
+   * Writes the view depths bounding each cascade, with cascade
+   * i spanning [splits[i], splits[i + 1]]. Requires room for
+   * totalCascades + 1 splits.
+   */
+  void Gm_ComputeCascadeSplits(const CascadeSettings& settings, float* splits) {
+    u32 total = settings.totalCascades;
+    float nearDepth = settings.nearDepth;
+    float farDepth = settings.farDepth;
+
+    splits[0] = nearDepth;
+
+    for (u32 i = 1; i < total; i++) {
+      float ratio = (float)i / (float)total;
+      float logarithmicSplit = nearDepth * powf(farDepth / nearDepth, ratio);
+      float uniformSplit = nearDepth + (farDepth - nearDepth) * ratio;
+
+      splits[i] = settings.splitBlend * logarithmicSplit + (1.0f - settings.splitBlend) * uniformSplit;
+    }
+
+    splits[total] = farDepth;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "math/frustum.h"
+#include "math/matrix.h"
+#include "math/vector.h"
+#include "system/camera.h"
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * The maximum number of directional shadow cascades, matching
+   * the cascade attachments of a directional shadow map.
+   */
+  constexpr static u32 MAX_SHADOW_CASCADES = 3;
+
+  /**
+   * The width and height of each directional shadow map
+   * cascade, in texels.
+   */
+  constexpr static u32 DIRECTIONAL_SHADOW_MAP_SIZE = 2048;
+
+  /**
+   * CascadeSettings
+   * ---------------
+   *
+   * Controls how the view depth range covered by directional
+   * shadows is split into cascades. Split depths blend between
+   * logarithmic and uniform splits (the 'practical' split scheme),
+   * with a splitBlend of 1 being fully logarithmic.
+   */
+  struct CascadeSettings {
+    u32 totalCascades = MAX_SHADOW_CASCADES;
+    float nearDepth = 1.0f;
+    float farDepth = 1250.0f;
+    float splitBlend = 0.5f;
+  };
+
+  /**
+   * Cascade
+   * -------
+   *
+   * A single directional shadow cascade, covering the view
+   * depths [nearDepth, farDepth).
+   */
+  struct Cascade {
+    /**
+     * The transposed (GL) light view-projection matrix,
+     * which expects world positions with their Z axis
+     * inverted, like other GL matrices.
+     */
+    Matrix4f matLightViewProjection;
+    /**
+     * The world space volume containing the shadow casters
+     * of the cascade, extruded toward the light.
+     */
+    Frustum casterFrustum;
+    float nearDepth = 0.0f;
+    float farDepth = 0.0f;
+  };
+
+  /**
+   * CascadeSet
+   * ----------
+   *
+   * The shadow cascades of a directional light, built once
+   * per frame and shared by every pass drawing or sampling its
+   * shadow maps.
+   *
+   * Cascades are fit to bounding spheres around each slice of
+   * the camera frustum, which are computed in view space so
+   * their sizes don't change as the camera rotates, and their
+   * centers are snapped to the shadow map's texel grid. Shadows
+   * therefore don't shimmer as the camera moves or turns.
+   *
+   * Cascades don't depend on a renderer, and are built without
+   * any matrix inversions, so they can be checked on the CPU.
+   */
+  class CascadeSet {
+  public:
+    const Cascade& operator[](u32 index) const;
+
+    void build(const CascadeSettings& settings, const Vec3f& lightDirection, const Camera& camera, const Area<u32>& resolution);
+    u32 size() const;
+
+  private:
+    Cascade cascades[MAX_SHADOW_CASCADES];
+    u32 totalCascades = 0;
+  };
+
+  void Gm_ComputeCascadeSplits(const CascadeSettings& settings, float* splits);
+}
\ No newline at end of file
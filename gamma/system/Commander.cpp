@@ -19,7 +19,8 @@ namespace Gamma {
     { "skylight", "Indirect sky light", GammaFlags::RENDER_INDIRECT_SKY_LIGHT },
     { "dev buffers", "Dev buffers", GammaFlags::RENDER_DEV_BUFFERS },
     { "wireframe", "Wireframe mode", GammaFlags::WIREFRAME_MODE },
-    { "denoising", "Denoising", GammaFlags::ENABLE_DENOISING }
+    { "denoising", "Denoising", GammaFlags::ENABLE_DENOISING },
+    { "clustered lights", "Clustered lights", GammaFlags::RENDER_CLUSTERED_LIGHTS }
   };
 
   Commander::Commander() {
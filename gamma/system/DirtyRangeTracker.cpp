@@ -0,0 +1,97 @@
+#include "system/DirtyRangeTracker.h"
+
+#define BLOCK_SIZE 64
+#define BLOCKS_PER_WORD 64
+
+namespace Gamma {
+  /**
+   * DirtyRangeTracker
+   * -----------------
+   */
+  void DirtyRangeTracker::clear() {
+    if (!dirty) {
+      return;
+    }
+
+    for (auto& word : blockBits) {
+      word = 0;
+    }
+
+    dirty = false;
+  }
+
+  void DirtyRangeTracker::free() {
+    blockBits.clear();
+    blockBits.shrink_to_fit();
+
+    dirty = false;
+  }
+
+  /**
+   * Appends the coalesced dirty ranges to the provided list,
+   * clipping them to the first [limit] slots.
+   */
+  void DirtyRangeTracker::getRanges(u32 limit, std::vector<DirtyRange>& ranges) const {
+    if (!dirty) {
+      return;
+    }
+
+    u32 totalBlocks = (limit + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    bool isRangeOpen = false;
+    u32 rangeStart = 0;
+
+    for (u32 block = 0; block < totalBlocks; block++) {
+      bool isBlockDirty = (blockBits[block / BLOCKS_PER_WORD] >> (block % BLOCKS_PER_WORD)) & 1;
+
+      if (isBlockDirty && !isRangeOpen) {
+        rangeStart = block * BLOCK_SIZE;
+        isRangeOpen = true;
+      } else if (!isBlockDirty && isRangeOpen) {
+        ranges.push_back({ rangeStart, block * BLOCK_SIZE });
+
+        isRangeOpen = false;
+      }
+    }
+
+    if (isRangeOpen) {
+      ranges.push_back({ rangeStart, limit });
+    }
+  }
+
+  bool DirtyRangeTracker::isDirty() const {
+    return dirty;
+  }
+
+  void DirtyRangeTracker::mark(u32 index) {
+    u32 block = index / BLOCK_SIZE;
+
+    blockBits[block / BLOCKS_PER_WORD] |= 1ULL << (block % BLOCKS_PER_WORD);
+
+    dirty = true;
+  }
+
+  /**
+   * Marks slots [start, end) as dirty.
+   */
+  void DirtyRangeTracker::markRange(u32 start, u32 end) {
+    if (start >= end) {
+      return;
+    }
+
+    u32 lastBlock = (end - 1) / BLOCK_SIZE;
+
+    for (u32 block = start / BLOCK_SIZE; block <= lastBlock; block++) {
+      blockBits[block / BLOCKS_PER_WORD] |= 1ULL << (block % BLOCKS_PER_WORD);
+    }
+
+    dirty = true;
+  }
+
+  void DirtyRangeTracker::reserve(u32 size) {
+    u32 totalBlocks = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    blockBits.assign((totalBlocks + BLOCKS_PER_WORD - 1) / BLOCKS_PER_WORD, 0);
+
+    dirty = false;
+  }
+}
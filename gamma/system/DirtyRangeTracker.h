@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * DirtyRange
+   * ----------
+   *
+   * A range of slots [start, end) which have changed.
+   */
+  struct DirtyRange {
+    u32 start;
+    u32 end;
+  };
+
+  /**
+   * DirtyRangeTracker
+   * -----------------
+   *
+   * Tracks which slots of an array have changed since they
+   * were last cleared, at a granularity of 64-slot blocks.
+   * Dirty blocks are coalesced into contiguous ranges, so
+   * changed data can be uploaded in as few calls as possible.
+   */
+  class DirtyRangeTracker {
+  public:
+    void clear();
+    void free();
+    void getRanges(u32 limit, std::vector<DirtyRange>& ranges) const;
+    bool isDirty() const;
+    void mark(u32 index);
+    void markRange(u32 start, u32 end);
+    void reserve(u32 size);
+
+  private:
+    /**
+     * One bit per 64-slot block, 64 blocks per word.
+     */
+    std::vector<u64> blockBits;
+    bool dirty = false;
+  };
+}
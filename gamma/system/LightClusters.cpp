@@ -0,0 +1,425 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "math/batch_culling.h"
+#include "math/constants.h"
+#include "system/jobs.h"
+#include "system/LightClusters.h"
+
+namespace Gamma {
+  constexpr static u32 TILES_PER_SLICE = LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y;
+
+  /**
+   * The number of lights whose volumes are computed per job.
+   */
+  constexpr static u32 LIGHT_BATCH_SIZE = 256;
+
+  /**
+   * Returns whether a sphere intersects an axis-aligned box.
+   */
+  inline static bool isSphereTouchingBox(const Vec3f& center, float radius, const Vec3f& min, const Vec3f& max) {
+    float dx = std::max(std::max(min.x - center.x, center.x - max.x), 0.0f);
+    float dy = std::max(std::max(min.y - center.y, center.y - max.y), 0.0f);
+    float dz = std::max(std::max(min.z - center.z, center.z - max.z), 0.0f);
+
+    return dx * dx + dy * dy + dz * dz <= radius * radius;
+  }
+
+  /**
+   * Returns whether a sphere touches a spot light's cone, using
+   * the same test as Gm_ComputeSphereConeVisibility().
+   */
+  inline static bool isSphereTouchingCone(const Vec3f& center, float radius, const LightVolume& volume) {
+    Vec3f delta = center - volume.apex;
+    float limit = volume.range + radius;
+    float distanceSquared = Vec3f::dot(delta, delta);
+    float axial = Vec3f::dot(delta, volume.direction);
+    float lateral = sqrtf(std::max(distanceSquared - axial * axial, 0.0f));
+    float side = volume.coneCosine * lateral - volume.coneSine * axial;
+
+    // Cones wider than a hemisphere reach behind their apex
+    return volume.coneCosine < 0.0f
+      ? distanceSquared <= limit * limit && side <= radius
+      : axial >= -radius && axial <= limit && side <= radius;
+  }
+
+  /**
+   * Transforms a world space direction into view space,
+   * ignoring the view matrix's translation.
+   */
+  inline static Vec3f toViewDirection(const Matrix4f& view, const Vec3f& direction) {
+    auto& m = view.m;
+    Vec3f d = direction.gl();
+
+    return Vec3f(
+      m[0] * d.x + m[1] * d.y + m[2] * d.z,
+      m[4] * d.x + m[5] * d.y + m[6] * d.z,
+      m[8] * d.x + m[9] * d.y + m[10] * d.z
+    );
+  }
+
+  /**
+   * Returns the screen tile containing a normalized device
+   * coordinate, clamped to the tile grid.
+   */
+  inline static u32 getTile(float ndc, u32 totalTiles) {
+    float tile = floorf((ndc * 0.5f + 0.5f) * float(totalTiles));
+
+    return (u32)std::max(0.0f, std::min(tile, float(totalTiles - 1)));
+  }
+
+  /**
+   * Bins lights into the clusters of a depth slice, sorting the
+   * light indexes in the slice by cluster.
+   */
+  void LightClusters::binSlice(u32 slice) {
+    auto& pairs = slicePairs[slice];
+    auto& indices = sliceIndices[slice];
+    LightCluster* sliceClusters = &clusters[slice * TILES_PER_SLICE];
+
+    pairs.clear();
+
+    for (u32 lightIndex = 0; lightIndex < (u32)volumes.size(); lightIndex++) {
+      auto& volume = volumes[lightIndex];
+
+      if (!volume.isVisible || slice < volume.firstSlice || slice > volume.lastSlice) {
+        continue;
+      }
+
+      u32 minX, maxX, minY, maxY;
+
+      if (!getTileRange(volume, slice, minX, maxX, minY, maxY)) {
+        continue;
+      }
+
+      for (u32 y = minY; y <= maxY; y++) {
+        for (u32 x = minX; x <= maxX; x++) {
+          u32 tile = y * LIGHT_CLUSTERS_X + x;
+
+          if (intersectsClusterBounds(volume, slice * TILES_PER_SLICE + tile)) {
+            pairs.push_back(((u64)tile << 32) | lightIndex);
+          }
+        }
+      }
+    }
+
+    // Counting sort the slice's light indexes by cluster
+    for (u32 tile = 0; tile < TILES_PER_SLICE; tile++) {
+      sliceClusters[tile].count = 0;
+    }
+
+    for (auto pair : pairs) {
+      sliceClusters[pair >> 32].count++;
+    }
+
+    u32 offset = 0;
+
+    for (u32 tile = 0; tile < TILES_PER_SLICE; tile++) {
+      sliceClusters[tile].offset = offset;
+      offset += sliceClusters[tile].count;
+    }
+
+    indices.resize(pairs.size());
+
+    for (auto pair : pairs) {
+      auto& cluster = sliceClusters[pair >> 32];
+
+      indices[cluster.offset++] = (u32)pair;
+    }
+
+    // Restore the cluster offsets advanced by the sort
+    for (u32 tile = 0; tile < TILES_PER_SLICE; tile++) {
+      sliceClusters[tile].offset -= sliceClusters[tile].count;
+    }
+  }
+
+  /**
+   * Bins lights into clusters for a camera's current view.
+   * Point and spot lights are copied into getLights() in that
+   * order, and binned by their view space volumes.
+   */
+  void LightClusters::build(const Camera& camera, const Area<u32>& area, const std::vector<Light*>& pointLights, const std::vector<Light*>& spotLights) {
+    Matrix4f view = Gm_GetCameraViewMatrix(camera);
+    u32 totalLights = u32(pointLights.size() + spotLights.size());
+
+    totalPoints = (u32)pointLights.size();
+    tanHalfFovY = tanf(camera.fov * 0.5f * DEGREES_TO_RADIANS);
+    tanHalfFovX = tanHalfFovY * (float)area.width / (float)area.height;
+
+    // Slices are spaced exponentially between the near and
+    // far planes, so nearer slices are thinner
+    for (u32 z = 0; z <= LIGHT_CLUSTERS_Z; z++) {
+      sliceDepths[z] = CAMERA_NEAR_PLANE * powf(CAMERA_FAR_PLANE / CAMERA_NEAR_PLANE, float(z) / float(LIGHT_CLUSTERS_Z));
+    }
+
+    clusters.resize(TOTAL_LIGHT_CLUSTERS);
+    clusterBounds.resize(TOTAL_LIGHT_CLUSTERS);
+    sliceIndices.resize(LIGHT_CLUSTERS_Z);
+    slicePairs.resize(LIGHT_CLUSTERS_Z);
+    lights.resize(totalLights);
+    volumes.resize(totalLights);
+
+    computeClusterBounds();
+
+    Gm_ParallelFor(0, totalLights, LIGHT_BATCH_SIZE, [&](u32 start, u32 end) {
+      for (u32 i = start; i < end; i++) {
+        bool isSpotLight = i >= totalPoints;
+        auto& light = isSpotLight ? *spotLights[i - totalPoints] : *pointLights[i];
+
+        computeLightVolume(i, light, view, isSpotLight);
+      }
+    });
+
+    Gm_ParallelFor(0, LIGHT_CLUSTERS_Z, 1, [&](u32 start, u32 end) {
+      for (u32 z = start; z < end; z++) {
+        binSlice(z);
+      }
+    });
+
+    // Offset each slice's clusters by the lights binned into
+    // the slices before it, and gather the slices' indexes
+    u32 sliceOffset = 0;
+
+    for (u32 z = 0; z < LIGHT_CLUSTERS_Z; z++) {
+      LightCluster* sliceClusters = &clusters[z * TILES_PER_SLICE];
+
+      for (u32 tile = 0; tile < TILES_PER_SLICE; tile++) {
+        sliceClusters[tile].offset += sliceOffset;
+      }
+
+      sliceOffset += (u32)sliceIndices[z].size();
+    }
+
+    lightIndices.resize(sliceOffset);
+
+    Gm_ParallelFor(0, LIGHT_CLUSTERS_Z, 1, [&](u32 start, u32 end) {
+      for (u32 z = start; z < end; z++) {
+        auto& indices = sliceIndices[z];
+
+        if (indices.size() > 0) {
+          std::memcpy(&lightIndices[clusters[z * TILES_PER_SLICE].offset], indices.data(), indices.size() * sizeof(u32));
+        }
+      }
+    });
+  }
+
+  /**
+   * Computes the view space bounding box of each cluster, from
+   * its tile's edges at its slice's near and far depths. View
+   * space faces -Z, following the GL convention.
+   */
+  void LightClusters::computeClusterBounds() {
+    for (u32 z = 0; z < LIGHT_CLUSTERS_Z; z++) {
+      float nearDepth = sliceDepths[z];
+      float farDepth = sliceDepths[z + 1];
+
+      for (u32 y = 0; y < LIGHT_CLUSTERS_Y; y++) {
+        float bottom = (float(y) / float(LIGHT_CLUSTERS_Y) * 2.0f - 1.0f) * tanHalfFovY;
+        float top = (float(y + 1) / float(LIGHT_CLUSTERS_Y) * 2.0f - 1.0f) * tanHalfFovY;
+
+        for (u32 x = 0; x < LIGHT_CLUSTERS_X; x++) {
+          float left = (float(x) / float(LIGHT_CLUSTERS_X) * 2.0f - 1.0f) * tanHalfFovX;
+          float right = (float(x + 1) / float(LIGHT_CLUSTERS_X) * 2.0f - 1.0f) * tanHalfFovX;
+          auto& bounds = clusterBounds[getClusterIndex(x, y, z)];
+
+          bounds.min.x = std::min(left * nearDepth, left * farDepth);
+          bounds.max.x = std::max(right * nearDepth, right * farDepth);
+          bounds.min.y = std::min(bottom * nearDepth, bottom * farDepth);
+          bounds.max.y = std::max(top * nearDepth, top * farDepth);
+          bounds.min.z = -farDepth;
+          bounds.max.z = -nearDepth;
+        }
+      }
+    }
+  }
+
+  /**
+   * Copies a light into the uploaded light list, and computes
+   * its view space volume and the range of slices it spans.
+   */
+  void LightClusters::computeLightVolume(u32 lightIndex, const Light& light, const Matrix4f& view, bool isSpotLight) {
+    auto& clusterLight = lights[lightIndex];
+    auto& volume = volumes[lightIndex];
+    Vec4f position = view * light.position.gl();
+
+    clusterLight.position = light.position;
+    clusterLight.radius = light.radius;
+    clusterLight.color = light.color;
+    clusterLight.power = light.power;
+    clusterLight.direction = light.direction;
+    clusterLight.fov = light.fov;
+
+    volume.apex = Vec3f(position.x, position.y, position.z);
+    volume.range = light.radius;
+    volume.center = volume.apex;
+    volume.radius = light.radius;
+    volume.isSpotLight = isSpotLight;
+
+    if (isSpotLight) {
+      float halfAngle = Gm_GetSpotLightHalfAngle(light.fov);
+
+      volume.direction = toViewDirection(view, light.direction).unit();
+      volume.coneSine = sinf(halfAngle);
+      volume.coneCosine = cosf(halfAngle);
+
+      // Bound the cone with the smallest sphere containing
+      // its apex and the rim of its spherical cap. Cones wider
+      // than a hemisphere reach behind their apex, and keep
+      // the full sphere around it.
+      if (halfAngle <= PI / 4.0f) {
+        float radius = light.radius / (2.0f * volume.coneCosine);
+
+        volume.center = volume.apex + volume.direction * radius;
+        volume.radius = radius;
+      } else if (halfAngle <= HALF_PI) {
+        volume.center = volume.apex + volume.direction * (light.radius * volume.coneCosine);
+        volume.radius = light.radius * volume.coneSine;
+      }
+    }
+
+    auto& center = volume.center;
+    float nearDepth = -center.z - volume.radius;
+    float farDepth = -center.z + volume.radius;
+    // Distances (scaled by the planes' normal lengths) from
+    // the view frustum's side planes, which pass through the
+    // camera and face outward
+    float planeScaleX = sqrtf(1.0f + tanHalfFovX * tanHalfFovX);
+    float planeScaleY = sqrtf(1.0f + tanHalfFovY * tanHalfFovY);
+    float scaledRadiusX = volume.radius * planeScaleX;
+    float scaledRadiusY = volume.radius * planeScaleY;
+
+    volume.isVisible = (
+      farDepth >= CAMERA_NEAR_PLANE &&
+      nearDepth <= CAMERA_FAR_PLANE &&
+      -center.x + tanHalfFovX * center.z <= scaledRadiusX &&
+      center.x + tanHalfFovX * center.z <= scaledRadiusX &&
+      -center.y + tanHalfFovY * center.z <= scaledRadiusY &&
+      center.y + tanHalfFovY * center.z <= scaledRadiusY
+    );
+
+    // Widen the slice range by a slice on either side, since
+    // slice depths are rounded differently than getSlice()
+    volume.firstSlice = getSlice(nearDepth);
+    volume.lastSlice = std::min(getSlice(farDepth) + 1, LIGHT_CLUSTERS_Z - 1);
+
+    if (volume.firstSlice > 0) {
+      volume.firstSlice--;
+    }
+  }
+
+  const ClusterBounds& LightClusters::getClusterBounds(u32 clusterIndex) const {
+    return clusterBounds[clusterIndex];
+  }
+
+  u32 LightClusters::getClusterIndex(u32 x, u32 y, u32 z) const {
+    return z * TILES_PER_SLICE + y * LIGHT_CLUSTERS_X + x;
+  }
+
+  const std::vector<LightCluster>& LightClusters::getClusters() const {
+    return clusters;
+  }
+
+  const std::vector<u32>& LightClusters::getLightIndices() const {
+    return lightIndices;
+  }
+
+  const std::vector<ClusterLight>& LightClusters::getLights() const {
+    return lights;
+  }
+
+  /**
+   * Returns the depth slice containing a view depth, clamped
+   * to the slices between the near and far planes.
+   */
+  u32 LightClusters::getSlice(float depth) const {
+    if (depth <= CAMERA_NEAR_PLANE) {
+      return 0;
+    }
+
+    float slice = floorf(logf(depth / CAMERA_NEAR_PLANE) / logf(CAMERA_FAR_PLANE / CAMERA_NEAR_PLANE) * float(LIGHT_CLUSTERS_Z));
+
+    return (u32)std::min(slice, float(LIGHT_CLUSTERS_Z - 1));
+  }
+
+  /**
+   * Returns the range of screen tiles covered by a light's
+   * bounding box within a depth slice, or false if the box
+   * doesn't reach the slice. The range is conservative, so
+   * it includes every tile with a point of the light's volume
+   * in the slice.
+   */
+  bool LightClusters::getTileRange(const LightVolume& volume, u32 slice, u32& minX, u32& maxX, u32& minY, u32& maxY) const {
+    float nearDepth = std::max(sliceDepths[slice], -volume.center.z - volume.radius);
+    float farDepth = std::min(sliceDepths[slice + 1], -volume.center.z + volume.radius);
+
+    if (!volume.isVisible || nearDepth > farDepth) {
+      return false;
+    }
+
+    // Box edges are projected at both depths, so the tiles
+    // include the edges' projections at every depth between
+    float left = volume.center.x - volume.radius;
+    float right = volume.center.x + volume.radius;
+    float bottom = volume.center.y - volume.radius;
+    float top = volume.center.y + volume.radius;
+
+    minX = getTile(std::min(left / nearDepth, left / farDepth) / tanHalfFovX, LIGHT_CLUSTERS_X);
+    maxX = getTile(std::max(right / nearDepth, right / farDepth) / tanHalfFovX, LIGHT_CLUSTERS_X);
+    minY = getTile(std::min(bottom / nearDepth, bottom / farDepth) / tanHalfFovY, LIGHT_CLUSTERS_Y);
+    maxY = getTile(std::max(top / nearDepth, top / farDepth) / tanHalfFovY, LIGHT_CLUSTERS_Y);
+
+    return true;
+  }
+
+  /**
+   * Returns whether a light is binned into a cluster, by the
+   * same tests used when binning. Used to check binning against
+   * brute force tests of every light against every cluster.
+   */
+  bool LightClusters::intersectsCluster(u32 lightIndex, u32 clusterIndex) const {
+    auto& volume = volumes[lightIndex];
+    u32 slice = clusterIndex / TILES_PER_SLICE;
+    u32 tile = clusterIndex % TILES_PER_SLICE;
+    u32 x = tile % LIGHT_CLUSTERS_X;
+    u32 y = tile / LIGHT_CLUSTERS_X;
+    u32 minX, maxX, minY, maxY;
+
+    if (!getTileRange(volume, slice, minX, maxX, minY, maxY)) {
+      return false;
+    }
+
+    if (x < minX || x > maxX || y < minY || y > maxY) {
+      return false;
+    }
+
+    return intersectsClusterBounds(volume, clusterIndex);
+  }
+
+  /**
+   * Returns whether a light's volume touches a cluster's box.
+   * Spot lights are also tested against the cluster's bounding
+   * sphere, since cones only cover part of their bounding
+   * spheres.
+   */
+  bool LightClusters::intersectsClusterBounds(const LightVolume& volume, u32 clusterIndex) const {
+    auto& bounds = clusterBounds[clusterIndex];
+
+    if (!isSphereTouchingBox(volume.center, volume.radius, bounds.min, bounds.max)) {
+      return false;
+    }
+
+    if (volume.isSpotLight) {
+      Vec3f center = (bounds.min + bounds.max) * 0.5f;
+      Vec3f extent = (bounds.max - bounds.min) * 0.5f;
+
+      return isSphereTouchingCone(center, extent.magnitude(), volume);
+    }
+
+    return true;
+  }
+
+  u32 LightClusters::totalPointLights() const {
+    return totalPoints;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <vector>
+
+#include "math/vector.h"
+#include "system/camera.h"
+#include "system/entities.h"
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * Cluster grid dimensions: screen space tiles along X and Y,
+   * and exponentially spaced view depth slices along Z.
+   */
+  constexpr static u32 LIGHT_CLUSTERS_X = 16;
+  constexpr static u32 LIGHT_CLUSTERS_Y = 9;
+  constexpr static u32 LIGHT_CLUSTERS_Z = 24;
+  constexpr static u32 TOTAL_LIGHT_CLUSTERS = LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y * LIGHT_CLUSTERS_Z;
+
+  /**
+   * LightCluster
+   * ------------
+   *
+   * The range of a cluster's entries in the light index list
+   * of a LightClusters grid.
+   */
+  struct LightCluster {
+    u32 offset = 0;
+    u32 count = 0;
+  };
+
+  /**
+   * ClusterLight
+   * ------------
+   *
+   * A point or spot light as uploaded for clustered lighting,
+   * laid out like the Light struct in the lighting shaders.
+   */
+  struct ClusterLight {
+    Vec3f position;
+    float radius = 0.0f;
+    Vec3f color;
+    float power = 0.0f;
+    Vec3f direction;
+    float fov = 0.0f;
+  };
+
+  /**
+   * ClusterBounds
+   * -------------
+   *
+   * The view space bounding box of a cluster.
+   */
+  struct ClusterBounds {
+    Vec3f min;
+    Vec3f max;
+  };
+
+  /**
+   * LightVolume
+   * -----------
+   *
+   * The view space volume lit by a light. Point lights light a
+   * sphere, whereas spot lights light a cone, which is bounded
+   * by a sphere for coarse tests.
+   */
+  struct LightVolume {
+    Vec3f center;
+    float radius = 0.0f;
+    Vec3f apex;
+    float range = 0.0f;
+    Vec3f direction;
+    float coneSine = 0.0f;
+    float coneCosine = 0.0f;
+    u32 firstSlice = 0;
+    u32 lastSlice = 0;
+    bool isSpotLight = false;
+    bool isVisible = false;
+  };
+
+  /**
+   * LightClusters
+   * -------------
+   *
+   * Bins point and spot lights into a grid of view space
+   * clusters, for clustered lighting. Lights are binned across
+   * worker threads, with each worker taking its own depth
+   * slices, so no two workers ever write to the same cluster.
+   *
+   * Binning produces a compact list of light indexes, and a
+   * table of each cluster's offset and count into that list.
+   * Light indexes refer to getLights(), which has the point
+   * lights first, followed by the spot lights.
+   *
+   * Clusters don't depend on a renderer, so binning can be
+   * checked against intersectsCluster() for every light and
+   * cluster without a graphics context.
+   */
+  class LightClusters {
+  public:
+    void build(const Camera& camera, const Area<u32>& area, const std::vector<Light*>& pointLights, const std::vector<Light*>& spotLights);
+    const ClusterBounds& getClusterBounds(u32 clusterIndex) const;
+    u32 getClusterIndex(u32 x, u32 y, u32 z) const;
+    const std::vector<LightCluster>& getClusters() const;
+    const std::vector<u32>& getLightIndices() const;
+    const std::vector<ClusterLight>& getLights() const;
+    bool intersectsCluster(u32 lightIndex, u32 clusterIndex) const;
+    u32 totalPointLights() const;
+
+  private:
+    std::vector<LightCluster> clusters;
+    std::vector<ClusterBounds> clusterBounds;
+    std::vector<u32> lightIndices;
+    std::vector<ClusterLight> lights;
+    std::vector<LightVolume> volumes;
+    /**
+     * Light indexes binned into each depth slice, sorted by
+     * cluster, along with the (tile, light) pairs they're
+     * sorted from. Both are reused between builds.
+     */
+    std::vector<std::vector<u32>> sliceIndices;
+    std::vector<std::vector<u64>> slicePairs;
+    /**
+     * The view depths bounding each slice, with slice z
+     * spanning [sliceDepths[z], sliceDepths[z + 1]].
+     */
+    float sliceDepths[LIGHT_CLUSTERS_Z + 1];
+    float tanHalfFovX = 1.0f;
+    float tanHalfFovY = 1.0f;
+    u32 totalPoints = 0;
+
+    void binSlice(u32 slice);
+    void computeClusterBounds();
+    void computeLightVolume(u32 lightIndex, const Light& light, const Matrix4f& view, bool isSpotLight);
+    u32 getSlice(float depth) const;
+    bool getTileRange(const LightVolume& volume, u32 slice, u32& minX, u32& maxX, u32& minY, u32& maxY) const;
+    bool intersectsClusterBounds(const LightVolume& volume, u32 clusterIndex) const;
+  };
+}
\ No newline at end of file
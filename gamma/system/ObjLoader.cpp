@@ -1,35 +1,104 @@
-#include <map>
-#include <string>
-#include <iostream>
+#include <charconv>
+#include <cstring>
+#include <fstream>
 
+#include "system/console.h"
 #include "system/ObjLoader.h"
 
 namespace Gamma {
-  static std::string VERTEX_LABEL = "v";
-  static std::string TEXTURE_COORDINATE_LABEL = "vt";
-  static std::string NORMAL_LABEL = "vn";
-  static std::string FACE_LABEL = "f";
+  /**
+   * Marks texture coordinate/normal indexes which aren't
+   * defined for a face vertex.
+   */
+  constexpr static u32 UNDEFINED_INDEX = 0xFFFFFFFF;
 
-  ObjLoader::ObjLoader(const char* path) {
-    load(path);
+  inline static bool isSpace(char c) {
+    return c == ' ' || c == '\t';
+  }
 
-    while (isLoading) {
-      setChunkDelimiter(" ");
+  inline static bool isLineEnd(char c) {
+    return c == '\n' || c == '\r';
+  }
 
-      const std::string& label = readNextChunk();
+  inline static const char* skipSpaces(const char* cursor, const char* end) {
+    while (cursor < end && isSpace(*cursor)) {
+      cursor++;
+    }
 
-      if (label == VERTEX_LABEL) {
-        handleVertex();
-      } else if (label == TEXTURE_COORDINATE_LABEL) {
-        handleTextureCoordinate();
-      } else if (label == NORMAL_LABEL) {
-        handleNormal();
-      } else if (label == FACE_LABEL) {
-        handleFace();
-      }
+    return cursor;
+  }
 
-      nextLine();
+  inline static const char* skipToken(const char* cursor, const char* end) {
+    while (cursor < end && !isSpace(*cursor) && !isLineEnd(*cursor)) {
+      cursor++;
     }
+
+    return cursor;
+  }
+
+  inline static const char* skipLine(const char* cursor, const char* end) {
+    auto* lineEnd = (const char*)std::memchr(cursor, '\n', end - cursor);
+
+    return lineEnd != nullptr ? lineEnd + 1 : end;
+  }
+
+  /**
+   * Parses the next token on a line as a float. Malformed
+   * tokens are skipped, and parsed as 0.
+   */
+  inline static const char* parseFloat(const char* cursor, const char* end, float& value) {
+    cursor = skipSpaces(cursor, end);
+
+    // std::from_chars() doesn't accept explicit positive signs
+    if (cursor < end && *cursor == '+') {
+      cursor++;
+    }
+
+    auto result = std::from_chars(cursor, end, value);
+
+    if (result.ec != std::errc()) {
+      value = 0.0f;
+    }
+
+    return skipToken(result.ptr, end);
+  }
+
+  /**
+   * Parses a 1-based vertex, texture coordinate or normal index.
+   * Negative indexes are relative to the end of the respective
+   * list, as of the line being parsed.
+   */
+  inline static const char* parseIndex(const char* cursor, const char* end, u32 total, u32& index) {
+    s32 value = 0;
+    auto result = std::from_chars(cursor, end, value);
+
+    if (result.ec != std::errc() || value == 0) {
+      index = UNDEFINED_INDEX;
+    } else if (value > 0) {
+      index = (u32)(value - 1);
+    } else {
+      index = total + value;
+    }
+
+    return result.ptr;
+  }
+
+  ObjLoader::ObjLoader(const char* path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+    if (file.fail()) {
+      Console::log("[Gamma] ObjLoader failed to load file:", path);
+
+      return;
+    }
+
+    std::vector<char> source((size_t)file.tellg());
+
+    file.seekg(0);
+    file.read(source.data(), source.size());
+    file.close();
+
+    parse(source.data(), source.data() + source.size());
   }
 
   ObjLoader::~ObjLoader() {
@@ -39,37 +108,94 @@ namespace Gamma {
     faces.clear();
   }
 
-  void ObjLoader::handleFace() {
-    Face face;
+  /**
+   * Parses the vertices of a polygonal face, adding them as
+   * a fan of triangles around the first vertex.
+   */
+  const char* ObjLoader::handleFace(const char* cursor, const char* end) {
+    VertexData first = {};
+    VertexData previous = {};
+    VertexData next = {};
+    u32 total = 0;
+
+    cursor = skipSpaces(cursor, end);
+
+    while (cursor < end && !isLineEnd(*cursor) && *cursor != '#') {
+      cursor = parseVertexData(cursor, end, next);
 
-    face.v1 = parseVertexData(readNextChunk());
-    face.v2 = parseVertexData(readNextChunk());
-    face.v3 = parseVertexData(readNextChunk());
+      if (total == 0) {
+        first = next;
+      } else if (total >= 2) {
+        faces.push_back({ first, previous, next });
+      }
+
+      previous = next;
+      total++;
+
+      cursor = skipSpaces(cursor, end);
+    }
 
-    faces.push_back(face);
+    return cursor;
   }
 
-  void ObjLoader::handleNormal() {
-    float x = stof(readNextChunk());
-    float y = stof(readNextChunk());
-    float z = stof(readNextChunk());
+  const char* ObjLoader::handleNormal(const char* cursor, const char* end) {
+    float x, y, z;
+
+    cursor = parseFloat(cursor, end, x);
+    cursor = parseFloat(cursor, end, y);
+    cursor = parseFloat(cursor, end, z);
 
     normals.push_back({ x, y, z });
+
+    return cursor;
+  }
+
+  const char* ObjLoader::handleTextureCoordinate(const char* cursor, const char* end) {
+    float u, v;
+
+    cursor = parseFloat(cursor, end, u);
+    cursor = parseFloat(cursor, end, v);
+
+    textureCoordinates.push_back({ u, 1.f - v });
+
+    return cursor;
   }
 
-  void ObjLoader::handleVertex() {
-    float x = stof(readNextChunk());
-    float y = stof(readNextChunk());
-    float z = stof(readNextChunk());
+  const char* ObjLoader::handleVertex(const char* cursor, const char* end) {
+    float x, y, z;
+
+    cursor = parseFloat(cursor, end, x);
+    cursor = parseFloat(cursor, end, y);
+    cursor = parseFloat(cursor, end, z);
 
     vertices.push_back({ x, y, z });
+
+    return cursor;
   }
 
-  void ObjLoader::handleTextureCoordinate() {
-    float u = stof(readNextChunk());
-    float v = stof(readNextChunk());
+  /**
+   * Parses each line of an .obj file by its label. Lines
+   * with labels other than v/vt/vn/f (comments, objects,
+   * groups, materials, etc.) are skipped.
+   */
+  void ObjLoader::parse(const char* cursor, const char* end) {
+    while (cursor < end) {
+      cursor = skipSpaces(cursor, end);
+
+      if (end - cursor > 2 && cursor[0] == 'v') {
+        if (isSpace(cursor[1])) {
+          cursor = handleVertex(cursor + 2, end);
+        } else if (cursor[1] == 't' && isSpace(cursor[2])) {
+          cursor = handleTextureCoordinate(cursor + 3, end);
+        } else if (cursor[1] == 'n' && isSpace(cursor[2])) {
+          cursor = handleNormal(cursor + 3, end);
+        }
+      } else if (end - cursor > 1 && cursor[0] == 'f' && isSpace(cursor[1])) {
+        cursor = handleFace(cursor + 2, end);
+      }
 
-    textureCoordinates.push_back({ u, 1.f - v });
+      cursor = skipLine(cursor, end);
+    }
   }
 
   /**
@@ -86,37 +212,24 @@ namespace Gamma {
    * and vn the normal index, with respect to previously listed
    * vertex/texture coordinate/normal values.
    */
-  VertexData ObjLoader::parseVertexData(const std::string& chunk) {
-    VertexData vertexData;
-    int offset = 0;
-    int indexes[3];
-
-    for (int i = 0; i < 3; i++) {
-      int next = chunk.find("/", offset);
-      bool hasNext = next > -1;
-
-      if (next - offset == 0 || offset >= chunk.length()) {
-        // If the next '/' is immediately after the last,
-        // or we've reached the end of the chunk with
-        // cycles to spare, this type of vertex index isn't
-        // defined.
-        indexes[i] = -1;
-      } else {
-        // As long as characters are found in between the
-        // previous '/' and the next, or we still have extra
-        // characters in the chunk, attempt to parse the index.
-        int len = hasNext ? next : std::string::npos;
-
-        indexes[i] = stoi(chunk.substr(offset, len)) - 1;
+  const char* ObjLoader::parseVertexData(const char* cursor, const char* end, VertexData& vertexData) {
+    vertexData.textureCoordinateIndex = UNDEFINED_INDEX;
+    vertexData.normalIndex = UNDEFINED_INDEX;
+
+    cursor = parseIndex(cursor, end, (u32)vertices.size(), vertexData.vertexIndex);
+
+    if (cursor < end && *cursor == '/') {
+      cursor++;
+
+      if (cursor < end && *cursor != '/') {
+        cursor = parseIndex(cursor, end, (u32)textureCoordinates.size(), vertexData.textureCoordinateIndex);
       }
 
-      offset = hasNext ? next + 1 : chunk.length();
+      if (cursor < end && *cursor == '/') {
+        cursor = parseIndex(cursor + 1, end, (u32)normals.size(), vertexData.normalIndex);
+      }
     }
 
-    vertexData.vertexIndex = indexes[0];
-    vertexData.textureCoordinateIndex = indexes[1];
-    vertexData.normalIndex = indexes[2];
-
-    return vertexData;
+    return skipToken(cursor, end);
   }
 }
\ No newline at end of file
@@ -1,11 +1,8 @@
 #pragma once
 
-#include <map>
 #include <vector>
-#include <string>
 
 #include "math/vector.h"
-#include "system/AbstractLoader.h"
 #include "system/type_aliases.h"
 
 namespace Gamma {
@@ -42,11 +39,16 @@ namespace Gamma {
    * Opens and parses .obj files into an intermediate representation
    * for conversion into Model instances.
    *
+   * Files are read in a single bulk read, and parsed by scanning
+   * through them in place, without allocating per line or token.
+   * Polygons with more than three vertices are triangulated as
+   * triangle fans.
+   *
    * Usage:
    *
    *  ObjLoader modelObj("path/to/file.obj");
    */
-  class ObjLoader : public AbstractLoader {
+  class ObjLoader {
   public:
     std::vector<Vec3f> vertices;
     std::vector<Vec2f> textureCoordinates;
@@ -57,10 +59,11 @@ namespace Gamma {
     ~ObjLoader();
 
   private:
-    void handleFace();
-    void handleNormal();
-    void handleVertex();
-    void handleTextureCoordinate();
-    VertexData parseVertexData(const std::string& data);
+    const char* handleFace(const char* cursor, const char* end);
+    const char* handleNormal(const char* cursor, const char* end);
+    const char* handleTextureCoordinate(const char* cursor, const char* end);
+    const char* handleVertex(const char* cursor, const char* end);
+    void parse(const char* cursor, const char* end);
+    const char* parseVertexData(const char* cursor, const char* end, VertexData& vertexData);
   };
 }
\ No newline at end of file
@@ -1,11 +1,145 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
 #include "system/assert.h"
-#include "system/camera.h"
 #include "system/entities.h"
+#include "system/jobs.h"
+#include "system/memory.h"
 #include "system/ObjectPool.h"
 
-#define UNUSED_OBJECT_INDEX 0xffff
+#define UNUSED_OBJECT_INDEX 0xffffff
+#define SLOT_INDEX_MASK 0x00ffffff
+#define SLOT_GENERATION_SHIFT 24
+#define MAX_OBJECT_ID 0xffffff
 
 namespace Gamma {
+  /**
+   * The number of ID -> slot entries in each lookup table page.
+   * Pages are allocated lazily, so pools only pay for the IDs
+   * they actually hand out (4KB per 1024 IDs).
+   */
+  constexpr static u32 SLOT_PAGE_SIZE = 1024;
+
+  /**
+   * The number of streams in TransformStreams (3 position,
+   * 3 scale and 3 rotation components).
+   */
+  constexpr static u32 TOTAL_TRANSFORM_STREAMS = 9;
+
+  /**
+   * The number of streams in BoundsStreams (3 center
+   * components and the radius).
+   */
+  constexpr static u32 TOTAL_BOUNDS_STREAMS = 4;
+
+  /**
+   * The number of objects committed per worker thread batch.
+   */
+  constexpr static u32 COMMIT_BATCH_SIZE = 1024;
+
+  /**
+   * The number of matrices computed on the stack at a time
+   * before being packed into an AFFINE pool.
+   */
+  constexpr static u32 AFFINE_PACKING_BATCH_SIZE = 64;
+
+  /**
+   * The capacity pools grow to when they run out of space
+   * without any capacity reserved.
+   */
+  constexpr static u32 MIN_GROWTH_CAPACITY = 16;
+
+  /**
+   * Object indexes share the 24-bit slot index space with
+   * UNUSED_OBJECT_INDEX, which caps the size of a pool.
+   */
+  constexpr static u32 MAX_POOL_CAPACITY = UNUSED_OBJECT_INDEX;
+
+  /**
+   * The fraction of a coherently partitioned pool which can
+   * move between partitions before it's cheaper to retest
+   * every object than each moved object individually.
+   */
+  constexpr static u32 MAX_MOVED_OBJECTS_DIVISOR = 4;
+
+  /**
+   * The name of the user data column holding object
+   * orientations in pools using quaternion rotation.
+   */
+  constexpr static char ORIENTATION_COLUMN[] = "orientation";
+
+  /**
+   * Returns how far a sphere is from being culled by the
+   * nearest of a frustum's planes. Spheres with negative
+   * slack are outside the frustum.
+   */
+  inline static float getSphereSlack(const Frustum& frustum, const Vec3f& center, float radius) {
+    float slack = FLT_MAX;
+
+    for (u32 i = 0; i < 6; i++) {
+      auto& plane = frustum.planes[i];
+
+      slack = std::min(slack, Vec3f::dot(plane.normal, center) + plane.distance + radius);
+    }
+
+    return slack;
+  }
+
+  /**
+   * Returns the furthest that any point within a box could
+   * have moved relative to the planes of one frustum, when
+   * measured against another frustum instead. This bounds
+   * how much the slack of any sphere centered in the box
+   * can have changed between the two frusta.
+   */
+  static float getFrustumDrift(const Frustum& from, const Frustum& to, const Vec3f& min, const Vec3f& max) {
+    Vec3f center = (min + max) * 0.5f;
+    Vec3f extent = (max - min) * 0.5f;
+    float drift = 0.0f;
+
+    for (u32 i = 0; i < 6; i++) {
+      Vec3f normalDelta = to.planes[i].normal - from.planes[i].normal;
+      float distanceDelta = to.planes[i].distance - from.planes[i].distance;
+
+      float planeDrift = (
+        std::abs(Vec3f::dot(normalDelta, center) + distanceDelta) +
+        std::abs(normalDelta.x) * extent.x +
+        std::abs(normalDelta.y) * extent.y +
+        std::abs(normalDelta.z) * extent.z
+      );
+
+      drift = std::max(drift, planeDrift);
+    }
+
+    return drift;
+  }
+
+  inline static bool isSameFrustum(const Frustum& a, const Frustum& b) {
+    return std::memcmp(&a, &b, sizeof(Frustum)) == 0;
+  }
+
+  /**
+   * ObjectSpan
+   * ----------
+   */
+  Object& ObjectSpan::operator[](u32 index) const {
+    return first[index];
+  }
+
+  Object* ObjectSpan::begin() const {
+    return first;
+  }
+
+  Object* ObjectSpan::end() const {
+    return first + count;
+  }
+
+  u32 ObjectSpan::size() const {
+    return count;
+  }
+
   /**
    * ObjectPool
    * ----------
@@ -14,35 +148,243 @@ namespace Gamma {
     return objects[index];
   }
 
+  /**
+   * Allocates bounding sphere streams for the full capacity of
+   * the pool, padding each stream to a multiple of 8 floats so
+   * every stream starts on a 32-byte boundary.
+   */
+  void ObjectPool::allocateBounds() {
+    boundsStride = (maxObjects + 7) & ~7;
+    boundsData = (float*)Gm_AlignedAlloc((u64)boundsStride * TOTAL_BOUNDS_STREAMS * sizeof(float), 32);
+
+    assert(boundsData != nullptr, "Failed to allocate bounds streams for " + std::to_string(maxObjects) + " objects");
+
+    bounds.centerX = boundsData;
+    bounds.centerY = boundsData + boundsStride;
+    bounds.centerZ = boundsData + boundsStride * 2;
+    bounds.radius = boundsData + boundsStride * 3;
+  }
+
+  /**
+   * Allocates a user data column for the full capacity of
+   * the pool, with all entries zeroed.
+   */
+  void ObjectPool::allocateColumn(ObjectColumn& column) {
+    u64 size = (u64)maxObjects * column.elementSize;
+
+    column.data = new u8[size];
+
+    std::memset(column.data, 0, size);
+  }
+
+  /**
+   * Allocates transform streams for the full capacity of the
+   * pool, padding each stream to a multiple of 8 floats so every
+   * stream starts on a 32-byte boundary.
+   */
+  void ObjectPool::allocateTransformStreams() {
+    streamStride = (maxObjects + 7) & ~7;
+    streamData = (float*)Gm_AlignedAlloc((u64)streamStride * TOTAL_TRANSFORM_STREAMS * sizeof(float), 32);
+
+    assert(streamData != nullptr, "Failed to allocate transform streams for " + std::to_string(maxObjects) + " objects");
+
+    streams.positionX = streamData;
+    streams.positionY = streamData + streamStride;
+    streams.positionZ = streamData + streamStride * 2;
+    streams.scaleX = streamData + streamStride * 3;
+    streams.scaleY = streamData + streamStride * 4;
+    streams.scaleZ = streamData + streamStride * 5;
+    streams.rotationX = streamData + streamStride * 6;
+    streams.rotationY = streamData + streamStride * 7;
+    streams.rotationZ = streamData + streamStride * 8;
+  }
+
   Object* ObjectPool::begin() const {
     return objects;
   }
 
-  Object& ObjectPool::createObject() {
-    u16 id = runningId++;
+  /**
+   * Writes the matrices and colors of objects [start, end).
+   * Safe to run concurrently on disjoint ranges, since dirty
+   * ranges are marked separately.
+   */
+  void ObjectPool::commitBatch(u32 start, u32 end) {
+    if (usesTransformStreams) {
+      computeStreamMatrices(start, end);
+    } else if (rotationMode == RotationMode::QUATERNION) {
+      auto* orientations = getOrientations();
 
-    assert(max() > totalActive(), "Object Pool out of space: " + std::to_string(max()) + " objects allowed in this pool");
-    // @todo cycle through indices until an unoccupied slot is found
-    assert(indices[id] == UNUSED_OBJECT_INDEX, "Attempted to create an Object in an occupied slot");
+      for (u32 i = start; i < end; i++) {
+        auto& object = objects[i];
+        Matrix4f matrix;
 
-    // Retrieve and initialize object
-    u16 index = totalActiveObjects;
-    Object& object = objects[index];
+        Gm_ComputeTransformMatrix(object.position, object.scale, orientations[i], matrix);
 
-    object._record.id = id;
-    object._record.generation++;
+        setMatrix(i, matrix);
+      }
+    } else {
+      for (u32 i = start; i < end; i++) {
+        auto& object = objects[i];
+        Matrix4f matrix;
 
-    // Reset object matrix/color
-    matrices[index] = Matrix4f::identity();
-    colors[index] = pVec4(255, 255, 255);
+        Gm_ComputeTransformMatrix(object.position, object.scale, object.rotation, matrix);
 
-    // Enable object lookup by ID -> index
-    indices[id] = index;
+        setMatrix(i, matrix);
+      }
+    }
+
+    for (u32 i = start; i < end; i++) {
+      colors[i] = objects[i].color;
+    }
+
+    updateBounds(start, end);
+  }
+
+  u8* ObjectPool::createColumn(const std::string& name, u32 elementSize) {
+    for (auto& column : columns) {
+      assert(column.name != name, "Object Pool column '" + name + "' already exists");
+    }
+
+    ObjectColumn column;
+
+    column.name = name;
+    column.elementSize = elementSize;
+
+    if (maxObjects > 0) {
+      allocateColumn(column);
+    }
+
+    columns.push_back(column);
+
+    return column.data;
+  }
+
+  void ObjectPool::commitObjects() {
+    commitObjects(0, totalActiveObjects);
+  }
+
+  /**
+   * Commits objects [start, end) in one pass, writing their
+   * matrices and colors directly into the pool arrays rather
+   * than looking up each object by ID.
+   */
+  void ObjectPool::commitObjects(u32 start, u32 end) {
+    end = end > totalActiveObjects ? totalActiveObjects : end;
+
+    if (start >= end) {
+      return;
+    }
+
+    Gm_ParallelFor(start, end, COMMIT_BATCH_SIZE, [this](u32 batchStart, u32 batchEnd) {
+      commitBatch(batchStart, batchEnd);
+    });
+
+    onBoundsUpdated(start, end);
+
+    dirtyMatrices.markRange(start, end);
+    dirtyColors.markRange(start, end);
+  }
+
+  void ObjectPool::computeMatrices() {
+    computeMatrices(0, totalActiveObjects);
+  }
+
+  /**
+   * Recomputes the matrices of objects [start, end) from
+   * their transform streams.
+   */
+  void ObjectPool::computeMatrices(u32 start, u32 end) {
+    assert(usesTransformStreams, "computeMatrices() requires transform streams");
+
+    computeStreamMatrices(start, end);
+    updateBounds(start, end);
+    onBoundsUpdated(start, end);
+
+    dirtyMatrices.markRange(start, end);
+  }
+
+  /**
+   * Computes the matrices of objects [start, end) from their
+   * transform streams. AFFINE matrices are computed in small
+   * batches on the stack, and then packed into the pool.
+   */
+  void ObjectPool::computeStreamMatrices(u32 start, u32 end) {
+    if (matrixFormat == MatrixFormat::FULL) {
+      Gm_ComputeTransformMatrices(streams, matrices, start, end);
+
+      return;
+    }
+
+    Matrix4f batch[AFFINE_PACKING_BATCH_SIZE];
+
+    for (u32 batchStart = start; batchStart < end; batchStart += AFFINE_PACKING_BATCH_SIZE) {
+      u32 batchSize = end - batchStart < AFFINE_PACKING_BATCH_SIZE ? end - batchStart : AFFINE_PACKING_BATCH_SIZE;
+      TransformStreams batchStreams;
+
+      // Offset the streams so the batch starts at index 0
+      batchStreams.positionX = streams.positionX + batchStart;
+      batchStreams.positionY = streams.positionY + batchStart;
+      batchStreams.positionZ = streams.positionZ + batchStart;
+      batchStreams.scaleX = streams.scaleX + batchStart;
+      batchStreams.scaleY = streams.scaleY + batchStart;
+      batchStreams.scaleZ = streams.scaleZ + batchStart;
+      batchStreams.rotationX = streams.rotationX + batchStart;
+      batchStreams.rotationY = streams.rotationY + batchStart;
+      batchStreams.rotationZ = streams.rotationZ + batchStart;
+
+      Gm_ComputeTransformMatrices(batchStreams, batch, 0, batchSize);
+
+      for (u32 i = 0; i < batchSize; i++) {
+        affineMatrices[batchStart + i] = Matrix4x3f::fromMatrix4f(batch[i]);
+      }
+    }
+  }
+
+  Object& ObjectPool::createObject() {
+    if (totalActiveObjects == maxObjects) {
+      grow(totalActiveObjects + 1);
+    }
+
+    u32 index = totalActiveObjects;
+
+    initializeObject(index);
+    markDirty(index);
 
     totalActiveObjects++;
     totalVisibleObjects++;
 
-    return object;
+    coherence.isValid = false;
+
+    return objects[index];
+  }
+
+  /**
+   * Creates a number of objects at once, growing the pool
+   * at most once to fit them all.
+   */
+  ObjectSpan ObjectPool::createObjects(u32 total) {
+    assert((u64)totalActiveObjects + total <= MAX_POOL_CAPACITY, "Object Pool out of space: " + std::to_string(MAX_POOL_CAPACITY) + " objects allowed in this pool");
+
+    u32 start = totalActiveObjects;
+    u32 end = start + total;
+
+    if (end > maxObjects) {
+      grow(end);
+    }
+
+    for (u32 i = start; i < end; i++) {
+      initializeObject(i);
+    }
+
+    dirtyMatrices.markRange(start, end);
+    dirtyColors.markRange(start, end);
+
+    totalActiveObjects += total;
+    totalVisibleObjects += total;
+
+    coherence.isValid = false;
+
+    return { &objects[start], total };
   }
 
   Object* ObjectPool::end() const {
@@ -50,10 +392,13 @@ namespace Gamma {
   }
 
   void ObjectPool::free() {
-    for (u16 i = 0; i < USHRT_MAX; i++) {
-      indices[i] = UNUSED_OBJECT_INDEX;
+    for (auto* page : slotPages) {
+      delete[] page;
     }
 
+    slotPages.clear();
+    freeIds.clear();
+
     if (objects != nullptr) {
       delete[] objects;
     }
@@ -62,17 +407,68 @@ namespace Gamma {
       delete[] matrices;
     }
 
+    if (affineMatrices != nullptr) {
+      delete[] affineMatrices;
+    }
+
     if (colors != nullptr) {
       delete[] colors;
     }
 
+    if (streamData != nullptr) {
+      Gm_AlignedFree(streamData);
+    }
+
+    if (boundsData != nullptr) {
+      Gm_AlignedFree(boundsData);
+    }
+
+    for (auto& column : columns) {
+      delete[] column.data;
+
+      column.data = nullptr;
+    }
+
     objects = nullptr;
     matrices = nullptr;
+    affineMatrices = nullptr;
     colors = nullptr;
+    streamData = nullptr;
+    streams = TransformStreams();
+    streamStride = 0;
+    boundsData = nullptr;
+    bounds = BoundsStreams();
+    boundsStride = 0;
+
+    dirtyMatrices.free();
+    dirtyColors.free();
+    grid.free();
+    coherence = VisibilityCoherence();
+    changedBoundsIds.clear();
+    hasAllBoundsChanged = usesBoundsTracking;
+    lodsById.clear();
+    maxObjects = 0;
+    totalActiveObjects = 0;
+    totalVisibleObjects = 0;
+    runningId = 0;
+  }
+
+  u8* ObjectPool::findColumn(const std::string& name, u32 elementSize) const {
+    for (auto& column : columns) {
+      if (column.name == name) {
+        assert(column.elementSize == elementSize, "Object Pool column '" + name + "' accessed with the wrong type");
+
+        return column.data;
+      }
+    }
+
+    assert(false, "Object Pool column '" + name + "' not found");
+
+    return nullptr;
   }
 
-  Object* ObjectPool::getById(u16 objectId) const {
-    u16 index = indices[objectId];
+  Object* ObjectPool::getById(u32 objectId) const {
+    u32 index = getIndex(objectId);
 
     return index == UNUSED_OBJECT_INDEX ? nullptr : &objects[index];
   }
@@ -87,6 +483,14 @@ namespace Gamma {
     return object;
   }
 
+  Matrix4x3f* ObjectPool::getAffineMatrices() const {
+    return affineMatrices;
+  }
+
+  const BoundsStreams& ObjectPool::getBounds() const {
+    return bounds;
+  }
+
   pVec4* ObjectPool::getColors() const {
     return colors;
   }
@@ -95,147 +499,1227 @@ namespace Gamma {
     return matrices;
   }
 
-  u16 ObjectPool::max() const {
-    return maxObjects;
+  MatrixFormat ObjectPool::getMatrixFormat() const {
+    return matrixFormat;
   }
 
-  // @todo consolidate logic in partitionByDistance/partitionByVisibility
-  u16 ObjectPool::partitionByDistance(u16 start, float distance, const Vec3f& cameraPosition) {
-    u16 current = start;
-    u16 end = totalVisible();
-
-    while (end > current) {
-      float currentObjectDistance = (objects[current].position - cameraPosition).magnitude();
-
-      if (currentObjectDistance <= distance) {
-        current++;
-      } else {
-        float endObjectDistance;
+  /**
+   * Returns the size in bytes of each object matrix, as
+   * stored and uploaded.
+   */
+  u32 ObjectPool::getMatrixSize() const {
+    return matrixFormat == MatrixFormat::AFFINE ? sizeof(Matrix4x3f) : sizeof(Matrix4f);
+  }
 
-        do {
-          endObjectDistance = (objects[--end].position - cameraPosition).magnitude();
-        } while (endObjectDistance > distance && end > current);
+  /**
+   * Returns the orientations of the pool's objects, at the
+   * same indexes as the objects themselves. Only available
+   * to pools which have used quaternion rotation.
+   */
+  Quaternion* ObjectPool::getOrientations() const {
+    assert(hasOrientations, "Object Pool orientations require quaternion rotation");
 
-        if (current != end) {
-          swapObjects(current, end);
-        }
+    return getColumn<Quaternion>(ORIENTATION_COLUMN);
+  }
 
-        // @optimize we can increment 'current' here if endObjectDistance < distance
-        // to avoid recalculating the same distance on the next while loop cycle
-        // @todo test this out and make sure it works
-      }
+  /**
+   * Returns the position of the object at a given index,
+   * preferring its transform stream position when in use.
+   */
+  Vec3f ObjectPool::getPosition(u32 index) const {
+    if (usesTransformStreams) {
+      return Vec3f(streams.positionX[index], streams.positionY[index], streams.positionZ[index]);
     }
 
-    return current;
+    return objects[index].position;
   }
 
-  // @todo consolidate logic in partitionByDistance/partitionByVisibility
-  // @todo accept a distance threshold to avoid culling partially
-  // in-frame/partially out-of-frame objects
-  // @todo use camera FoV to determine dot product threshold
-  void ObjectPool::partitionByVisibility(const Camera& camera) {
-    u16 current = 0;
-    u16 end = totalActive();
-    Vec3f cameraDirection = camera.orientation.getDirection();
-
-    while (end > current) {
-      Vec3f objectUnitViewPosition = (objects[current].position - camera.position).unit();
+  RotationMode ObjectPool::getRotationMode() const {
+    return rotationMode;
+  }
 
-      if (Vec3f::dot(cameraDirection, objectUnitViewPosition) >= 0.7f) {
-        current++;
-      } else {
-        Vec3f endObjectUnitViewPosition;
+  const SpatialGrid& ObjectPool::getSpatialGrid() const {
+    return grid;
+  }
 
-        do {
-          endObjectUnitViewPosition = (objects[--end].position - camera.position).unit();
-        } while (Vec3f::dot(cameraDirection, endObjectUnitViewPosition) < 0.7f && end > current);
+  const TransformStreams& ObjectPool::getTransformStreams() const {
+    return streams;
+  }
 
-        if (current != end) {
-          swapObjects(current, end);
-        }
-      }
-    }
+  bool ObjectPool::hasSpatialGrid() const {
+    return usesSpatialGrid;
+  }
 
-    totalVisibleObjects = current;
+  bool ObjectPool::hasTransformStreams() const {
+    return usesTransformStreams;
   }
 
-  void ObjectPool::removeById(u16 objectId) {
-    u16 index = indices[objectId];
+  /**
+   * Returns the index of the object using a given ID,
+   * or UNUSED_OBJECT_INDEX if the ID is not in use.
+   */
+  u32 ObjectPool::getIndex(u32 objectId) const {
+    u32 page = objectId / SLOT_PAGE_SIZE;
 
-    if (index == UNUSED_OBJECT_INDEX) {
-      return;
+    if (page >= slotPages.size()) {
+      return UNUSED_OBJECT_INDEX;
     }
 
-    totalActiveObjects--;
-    totalVisibleObjects--;
+    return slotPages[page][objectId % SLOT_PAGE_SIZE] & SLOT_INDEX_MASK;
+  }
 
-    u16 lastIndex = totalActiveObjects;
+  /**
+   * Doubles the capacity of the pool (or more, to fit the
+   * minimum capacity), so the cost of growing is amortized
+   * over the objects created in the meantime.
+   */
+  void ObjectPool::grow(u32 minimumCapacity) {
+    assert(minimumCapacity <= MAX_POOL_CAPACITY, "Object Pool out of space: " + std::to_string(MAX_POOL_CAPACITY) + " objects allowed in this pool");
 
-    // Move last object/matrix/color into removed index
-    objects[index] = objects[lastIndex];
-    matrices[index] = matrices[lastIndex];
-    colors[index] = colors[lastIndex];
+    u64 capacity = (u64)maxObjects * 2;
 
-    // Update ID -> index lookup table
-    indices[objects[index]._record.id] = index;
-    indices[objectId] = UNUSED_OBJECT_INDEX;
-  }
+    if (capacity < MIN_GROWTH_CAPACITY) {
+      capacity = MIN_GROWTH_CAPACITY;
+    }
 
-  void ObjectPool::reset() {
-    for (u16 i = 0; i < totalActiveObjects; i++) {
-      indices[objects[i]._record.id] = UNUSED_OBJECT_INDEX;
+    if (capacity < minimumCapacity) {
+      capacity = minimumCapacity;
+    } else if (capacity > MAX_POOL_CAPACITY) {
+      capacity = MAX_POOL_CAPACITY;
     }
 
-    totalActiveObjects = 0;
-    totalVisibleObjects = 0;
-    runningId = 0;
+    resize((u32)capacity);
   }
 
-  void ObjectPool::reserve(u16 size) {
-    free();
+  /**
+   * Assigns an ID to the object at a given index, and resets
+   * its matrix/color/transform streams. Does not mark the
+   * object as dirty.
+   */
+  void ObjectPool::initializeObject(u32 index) {
+    u32 id = issueId();
 
-    maxObjects = size;
-    totalActiveObjects = 0;
-    totalVisibleObjects = 0;
-    objects = new Object[size];
-    matrices = new Matrix4f[size];
-    colors = new pVec4[size];
-  }
+    assert(getIndex(id) == UNUSED_OBJECT_INDEX, "Attempted to create an Object in an occupied slot");
 
-  void ObjectPool::showAll() {
-    totalVisibleObjects = totalActiveObjects;
-  }
+    Object& object = objects[index];
+    u32 slot = slotPages[id / SLOT_PAGE_SIZE][id % SLOT_PAGE_SIZE];
 
-  void ObjectPool::swapObjects(u16 indexA, u16 indexB) {
-    Object objectA = objects[indexA];
-    Matrix4f matrixA = matrices[indexA];
-    pVec4 colorA = colors[indexA];
+    object._record.id = id;
+    object._record.generation = slot >> SLOT_GENERATION_SHIFT;
 
-    objects[indexA] = objects[indexB];
-    matrices[indexA] = matrices[indexB];
-    colors[indexA] = colors[indexB];
+    // Reset object matrix/color
+    setMatrix(index, Matrix4f::identity());
+    colors[index] = pVec4(255, 255, 255);
 
-    objects[indexB] = objectA;
-    matrices[indexB] = matrixA;
-    colors[indexB] = colorA;
+    if (usesTransformStreams) {
+      setTransform(index, Vec3f(0.0f), Vec3f(1.0f), Vec3f(0.0f));
+    }
 
-    indices[objects[indexA]._record.id] = indexA;
-    indices[objects[indexB]._record.id] = indexB;
-  }
+    updateBounds(index, index + 1);
+    onBoundsUpdated(index, index + 1);
 
-  void ObjectPool::setColorById(u16 objectId, const pVec4& color) {
-    colors[indices[objectId]] = color;
-  }
+    for (auto& column : columns) {
+      std::memset(column.data + (u64)index * column.elementSize, 0, column.elementSize);
+    }
+
+    if (hasOrientations) {
+      getOrientations()[index] = { 1.0f, 0.0f, 0.0f, 0.0f };
+    }
+
+    // Enable object lookup by ID -> index
+    setIndex(id, index);
+  }
+
+  /**
+   * Hands out an ID for a new object, preferring IDs released
+   * by removed objects. Allocates a new lookup table page when
+   * a fresh ID crosses into an unallocated page.
+   */
+  u32 ObjectPool::issueId() {
+    if (freeIds.size() > 0) {
+      u32 id = freeIds.back();
+
+      freeIds.pop_back();
+
+      return id;
+    }
+
+    assert(runningId < MAX_OBJECT_ID, "Object Pool out of IDs");
+
+    u32 id = runningId++;
+
+    if (id / SLOT_PAGE_SIZE >= slotPages.size()) {
+      u32* page = new u32[SLOT_PAGE_SIZE];
+
+      for (u32 i = 0; i < SLOT_PAGE_SIZE; i++) {
+        page[i] = UNUSED_OBJECT_INDEX;
+      }
+
+      slotPages.push_back(page);
+    }
+
+    return id;
+  }
+
+  void ObjectPool::markDirty(u32 index) {
+    dirtyMatrices.mark(index);
+    dirtyColors.mark(index);
+  }
+
+  /**
+   * Copies the matrix at one index to another, in whichever
+   * format the pool uses.
+   */
+  void ObjectPool::moveMatrix(u32 fromIndex, u32 toIndex) {
+    if (matrixFormat == MatrixFormat::AFFINE) {
+      affineMatrices[toIndex] = affineMatrices[fromIndex];
+    } else {
+      matrices[toIndex] = matrices[fromIndex];
+    }
+  }
+
+  /**
+   * Moves the object at one index, along with its matrix, color
+   * and transform streams, to another index. Does not mark the
+   * object as dirty.
+   */
+  void ObjectPool::moveObject(u32 fromIndex, u32 toIndex) {
+    objects[toIndex] = objects[fromIndex];
+    colors[toIndex] = colors[fromIndex];
+
+    moveMatrix(fromIndex, toIndex);
+
+    if (usesTransformStreams) {
+      for (u32 i = 0; i < TOTAL_TRANSFORM_STREAMS; i++) {
+        float* stream = streamData + streamStride * i;
+
+        stream[toIndex] = stream[fromIndex];
+      }
+    }
+
+    for (u32 i = 0; i < TOTAL_BOUNDS_STREAMS; i++) {
+      float* stream = boundsData + boundsStride * i;
+
+      stream[toIndex] = stream[fromIndex];
+    }
+
+    for (auto& column : columns) {
+      u64 size = column.elementSize;
+
+      // Objects may be moved onto themselves in removeById()
+      std::memmove(column.data + toIndex * size, column.data + fromIndex * size, size);
+    }
+
+    setIndex(objects[toIndex]._record.id, toIndex);
+  }
+
+  /**
+   * Returns the index of an object in the pool, which is
+   * also the index of its entries in each user data column.
+   */
+  u32 ObjectPool::indexOf(const Object& object) const {
+    return (u32)(&object - objects);
+  }
+
+  u32 ObjectPool::max() const {
+    return maxObjects;
+  }
+
+  /**
+   * Updates whatever depends on the bounding spheres of objects
+   * [start, end) after they change: the spatial grid, the
+   * tracked bounds changes, and the objects a coherent partition
+   * needs to retest.
+   */
+  void ObjectPool::onBoundsUpdated(u32 start, u32 end) {
+    updateGrid(start, end);
+
+    if (usesBoundsTracking && !hasAllBoundsChanged) {
+      if (changedBoundsIds.size() + (end - start) > totalActiveObjects / MAX_MOVED_OBJECTS_DIVISOR) {
+        hasAllBoundsChanged = true;
+        changedBoundsIds.clear();
+      } else {
+        for (u32 i = start; i < end; i++) {
+          changedBoundsIds.push_back(objects[i]._record.id);
+        }
+      }
+    }
+
+    if (!usesCoherentPartitioning || !coherence.isValid) {
+      return;
+    }
+
+    if (coherence.movedIds.size() + (end - start) > totalActiveObjects / MAX_MOVED_OBJECTS_DIVISOR) {
+      // Retest everything on the next partition instead
+      coherence.isValid = false;
+      coherence.movedIds.clear();
+
+      return;
+    }
+
+    for (u32 i = start; i < end; i++) {
+      coherence.movedIds.push_back(objects[i]._record.id);
+    }
+  }
+
+  /**
+   * Updates the previous visibility partition for a new frustum.
+   * Objects whose slack against the reference frustum exceeds
+   * its drift from the new frustum can't have changed visibility,
+   * so only objects within the hysteresis band of the reference
+   * frustum's planes, and objects which have moved, are retested.
+   * Once the drift exceeds the band, every object is retested
+   * against the new frustum, which becomes the reference.
+   */
+  void ObjectPool::partitionByCoherentVisibility(const Frustum& frustum) {
+    if (
+      coherence.isValid &&
+      getFrustumDrift(coherence.referenceFrustum, frustum, coherence.min, coherence.max) > coherenceBand
+    ) {
+      coherence.isValid = false;
+    }
+
+    if (!coherence.isValid) {
+      retestCoherentVisibility(frustum);
+
+      return;
+    }
+
+    if (!isSameFrustum(frustum, coherence.lastFrustum)) {
+      for (auto id : coherence.boundaryIds) {
+        u32 index = getIndex(id);
+
+        if (index != UNUSED_OBJECT_INDEX) {
+          retestVisibility(index, frustum, true);
+        }
+      }
+    }
+
+    for (auto id : coherence.movedIds) {
+      u32 index = getIndex(id);
+
+      if (index == UNUSED_OBJECT_INDEX) {
+        continue;
+      }
+
+      // Moved objects near the reference frustum's planes join
+      // the boundary objects, and are retested from now on
+      Vec3f center(bounds.centerX[index], bounds.centerY[index], bounds.centerZ[index]);
+      float referenceSlack = getSphereSlack(coherence.referenceFrustum, center, bounds.radius[index]);
+      bool isBoundaryObject = std::abs(referenceSlack) <= coherenceBand;
+
+      if (isBoundaryObject) {
+        coherence.boundaryIds.push_back(id);
+      }
+
+      coherence.min = Vec3f(std::min(coherence.min.x, center.x), std::min(coherence.min.y, center.y), std::min(coherence.min.z, center.z));
+      coherence.max = Vec3f(std::max(coherence.max.x, center.x), std::max(coherence.max.y, center.y), std::max(coherence.max.z, center.z));
+
+      retestVisibility(index, frustum, isBoundaryObject);
+    }
+
+    coherence.movedIds.clear();
+    coherence.lastFrustum = frustum;
+
+    // Objects moving in and out of the band can be added
+    // repeatedly, so drop duplicates once the list grows
+    if (coherence.boundaryIds.size() > coherence.totalReferenceBoundaryIds * 2 + 64) {
+      std::sort(coherence.boundaryIds.begin(), coherence.boundaryIds.end());
+
+      coherence.boundaryIds.erase(
+        std::unique(coherence.boundaryIds.begin(), coherence.boundaryIds.end()),
+        coherence.boundaryIds.end()
+      );
+
+      coherence.totalReferenceBoundaryIds = (u32)coherence.boundaryIds.size();
+    }
+  }
+
+  // @todo consolidate logic in partitionByDistance/partitionByVisibility
+  /**
+   * Moves visible objects within a distance of the camera to
+   * the front of [start, totalVisible()), returning the end of
+   * the range of objects within the distance.
+   *
+   * Pools using coherent partitioning remember where each
+   * distance's range ended, and keep objects which were in it
+   * until they're more than the hysteresis band past it.
+   */
+  u32 ObjectPool::partitionByDistance(u32 start, float distance, const Vec3f& cameraPosition) {
+    u32 current = start;
+    u32 end = totalVisible();
+    u32 previousEnd = start;
+    DistancePivot* pivot = nullptr;
+    float nearDistance = distance * distance;
+    float keepDistance = nearDistance;
+
+    if (usesCoherentPartitioning) {
+      for (auto& distancePivot : coherence.distancePivots) {
+        if (distancePivot.distance == distance) {
+          pivot = &distancePivot;
+        }
+      }
+
+      if (pivot == nullptr) {
+        coherence.distancePivots.push_back({ distance, start });
+
+        pivot = &coherence.distancePivots.back();
+      }
+
+      previousEnd = pivot->end;
+      keepDistance = (distance + coherenceBand) * (distance + coherenceBand);
+    }
+
+    auto isNear = [&](u32 index) {
+      Vec3f delta = getPosition(index) - cameraPosition;
+
+      return Vec3f::dot(delta, delta) <= (index < previousEnd ? keepDistance : nearDistance);
+    };
+
+    while (end > current) {
+      if (isNear(current)) {
+        current++;
+      } else {
+        bool isEndObjectNear;
+
+        do {
+          isEndObjectNear = isNear(--end);
+        } while (!isEndObjectNear && end > current);
+
+        if (isEndObjectNear) {
+          swapObjects(current, end);
+
+          current++;
+        }
+      }
+    }
+
+    if (pivot != nullptr) {
+      pivot->end = current;
+    }
+
+    return current;
+  }
+
+  /**
+   * Sorts visible objects by level of detail in a single pass,
+   * writing the number of objects at each level to lodCounts.
+   * Objects use the first level whose threshold they're within,
+   * or the last level if they aren't within any; thresholds
+   * therefore has totalLods - 1 entries, in ascending order.
+   *
+   * Objects keep their previous level of detail until they're
+   * more than a hysteresis fraction of a threshold past it, so
+   * objects near a threshold don't pop between levels. Objects
+   * which stay at the same level aren't moved.
+   */
+  void ObjectPool::partitionByLod(const Vec3f& cameraPosition, const LodThreshold* thresholds, u32 totalLods, float hysteresis, u32* lodCounts) {
+    assert(totalLods > 0 && totalLods <= 256, "Object Pool levels of detail must be between 1 and 256");
+
+    u32 total = totalVisible();
+    u32 lastLod = totalLods - 1;
+    float keepFactor = (1.0f + hysteresis) * (1.0f + hysteresis);
+    float enterFactor = (1.0f - hysteresis) * (1.0f - hysteresis);
+
+    if (lodsById.size() < runningId) {
+      lodsById.resize(runningId, 0);
+    }
+
+    lodIndexes.resize(total);
+    lodOffsets.resize(totalLods);
+
+    for (u32 lod = 0; lod < totalLods; lod++) {
+      lodCounts[lod] = 0;
+    }
+
+    // Assign each object its level of detail, by squared
+    // distance against each squared threshold
+    for (u32 i = 0; i < total; i++) {
+      float dx = bounds.centerX[i] - cameraPosition.x;
+      float dy = bounds.centerY[i] - cameraPosition.y;
+      float dz = bounds.centerZ[i] - cameraPosition.z;
+      float distance = dx * dx + dy * dy + dz * dz;
+      float radius = bounds.radius[i];
+      u32 id = objects[i]._record.id;
+      u32 previousLod = lodsById[id];
+      u32 lod = 0;
+
+      while (lod < lastLod) {
+        auto& threshold = thresholds[lod];
+        float limit = threshold.distance + radius * threshold.radiusScale;
+        float factor = previousLod <= lod ? keepFactor : enterFactor;
+
+        if (distance <= limit * limit * factor) {
+          break;
+        }
+
+        lod++;
+      }
+
+      lodIndexes[i] = (u8)lod;
+      lodsById[id] = (u8)lod;
+      lodCounts[lod]++;
+    }
+
+    // Cycle objects into their level of detail's range,
+    // skipping objects already in the right range
+    u32 offset = 0;
+
+    for (u32 lod = 0; lod < totalLods; lod++) {
+      lodOffsets[lod] = offset;
+      offset += lodCounts[lod];
+    }
+
+    offset = 0;
+
+    for (u32 lod = 0; lod < totalLods; lod++) {
+      u32 end = offset + lodCounts[lod];
+      u32& next = lodOffsets[lod];
+
+      while (next < end) {
+        u32 objectLod = lodIndexes[next];
+
+        if (objectLod == lod) {
+          next++;
+        } else {
+          // Skip over objects already in the target range,
+          // so only misplaced objects are ever swapped
+          u32& target = lodOffsets[objectLod];
+
+          while (lodIndexes[target] == objectLod) {
+            target++;
+          }
+
+          swapObjects(next, target);
+          std::swap(lodIndexes[next], lodIndexes[target]);
+
+          target++;
+        }
+      }
+
+      offset = end;
+    }
+  }
+
+  /**
+   * Moves objects whose bounding spheres intersect a frustum to
+   * the front of the pool. Spheres are tested in bulk up front,
+   * or by grid cell if the pool uses a spatial grid, after which
+   * visible objects are swapped into place using their
+   * visibility bits.
+   *
+   * Pools using coherent partitioning update their previous
+   * partition instead, whether or not they use a spatial grid.
+   */
+  void ObjectPool::partitionByVisibility(const Frustum& frustum) {
+    if (usesCoherentPartitioning) {
+      partitionByCoherentVisibility(frustum);
+
+      return;
+    }
+
+    u32 total = totalActive();
+
+    if (usesSpatialGrid) {
+      // Cull whole grid cells, and mark the objects
+      // in the remaining cells by index
+      visibilityMasks.assign(Gm_GetVisibilityMaskSize(total), 0);
+      visibleIds.clear();
+
+      grid.queryFrustum(frustum, visibleIds);
+
+      for (auto id : visibleIds) {
+        u32 index = getIndex(id);
+
+        visibilityMasks[index >> 5] |= 1U << (index & 31);
+      }
+    } else {
+      visibilityMasks.resize(Gm_GetVisibilityMaskSize(total));
+
+      Gm_ComputeSphereVisibility(frustum, bounds, visibilityMasks.data(), total);
+    }
+
+    partitionByVisibility(visibilityMasks.data());
+  }
+
+  /**
+   * Moves objects to the front of the pool based on externally
+   * computed visibility bits, with bit (i % 32) of word (i / 32)
+   * set for each visible object i.
+   */
+  void ObjectPool::partitionByVisibility(const u32* masks) {
+    u32 total = totalActive();
+
+    // Bits refer to the objects' original indexes. Each swap
+    // moves a visible object into place, so swapped indexes
+    // are never tested again.
+    auto isVisible = [masks](u32 index) {
+      return (masks[index >> 5] & (1U << (index & 31))) != 0;
+    };
+
+    u32 current = 0;
+    u32 end = total;
+
+    while (end > current) {
+      if (isVisible(current)) {
+        current++;
+      } else {
+        bool isEndObjectVisible;
+
+        do {
+          isEndObjectVisible = isVisible(--end);
+        } while (!isEndObjectVisible && end > current);
+
+        if (isEndObjectVisible) {
+          swapObjects(current, end);
+
+          current++;
+        }
+      }
+    }
+
+    totalVisibleObjects = current;
+
+    coherence.isValid = false;
+  }
+
+  void ObjectPool::removeById(u32 objectId) {
+    u32 index = getIndex(objectId);
+
+    if (index == UNUSED_OBJECT_INDEX) {
+      return;
+    }
+
+    totalActiveObjects--;
+    totalVisibleObjects--;
+
+    coherence.isValid = false;
+
+    // Move last object/matrix/color into removed index
+    moveObject(totalActiveObjects, index);
+    markDirty(index);
+    releaseId(objectId);
+  }
+
+  /**
+   * Finishes a removeIf() pass, once [remaining] objects are
+   * left in the pool. Returns the number of objects removed.
+   */
+  u32 ObjectPool::finishRemoval(u32 remaining) {
+    u32 totalRemoved = totalActiveObjects - remaining;
+
+    totalActiveObjects = remaining;
+    totalVisibleObjects = totalVisibleObjects > totalRemoved ? totalVisibleObjects - totalRemoved : 0;
+
+    if (totalRemoved > 0) {
+      coherence.isValid = false;
+    }
+
+    return totalRemoved;
+  }
+
+  /**
+   * Fills the gap left by a removed object with another
+   * object during a removeIf() pass.
+   */
+  void ObjectPool::fillGap(u32 fromIndex, u32 gapIndex) {
+    moveObject(fromIndex, gapIndex);
+    markDirty(gapIndex);
+  }
+
+  /**
+   * Retires the ID of a removed object, advancing its
+   * generation so stale records are rejected, and makes
+   * it available for reuse.
+   */
+  void ObjectPool::releaseId(u32 objectId) {
+    setIndex(objectId, UNUSED_OBJECT_INDEX);
+
+    if (usesSpatialGrid) {
+      grid.remove(objectId);
+    }
+
+    freeIds.push_back(objectId);
+  }
+
+  void ObjectPool::releaseObjectAt(u32 index) {
+    releaseId(objects[index]._record.id);
+  }
+
+  void ObjectPool::reset() {
+    for (u32 i = 0; i < totalActiveObjects; i++) {
+      setIndex(objects[i]._record.id, UNUSED_OBJECT_INDEX);
+    }
+
+    // Generations are retained in the lookup table, so
+    // records from before the reset remain invalid once
+    // their IDs are handed out again
+    freeIds.clear();
+    grid.clear();
 
-  u16 ObjectPool::totalActive() const {
+    coherence.isValid = false;
+    changedBoundsIds.clear();
+    hasAllBoundsChanged = usesBoundsTracking;
+    totalActiveObjects = 0;
+    totalVisibleObjects = 0;
+    runningId = 0;
+  }
+
+  /**
+   * Retests every object against a frustum, which becomes the
+   * reference frustum of a coherent partition. Objects are kept
+   * in or out of the visible partition per retestVisibility().
+   */
+  void ObjectPool::retestCoherentVisibility(const Frustum& frustum) {
+    u32 total = totalActiveObjects;
+
+    coherence.slack.resize(total);
+    coherence.boundaryIds.clear();
+    coherence.movedIds.clear();
+    coherence.min = Vec3f(FLT_MAX);
+    coherence.max = Vec3f(-FLT_MAX);
+
+    float* slack = coherence.slack.data();
+
+    Gm_ComputeSphereSlack(frustum, bounds, slack, total);
+
+    visibilityMasks.assign(Gm_GetVisibilityMaskSize(total), 0);
+
+    for (u32 i = 0; i < total; i++) {
+      bool wasVisible = i < totalVisibleObjects;
+      bool isVisible = wasVisible ? slack[i] >= -coherenceBand : slack[i] >= 0.0f;
+
+      visibilityMasks[i >> 5] |= u32(isVisible) << (i & 31);
+
+      if (slack[i] <= coherenceBand && slack[i] >= -coherenceBand) {
+        coherence.boundaryIds.push_back(objects[i]._record.id);
+      }
+    }
+
+    for (u32 i = 0; i < total; i++) {
+      coherence.min.x = std::min(coherence.min.x, bounds.centerX[i]);
+      coherence.min.y = std::min(coherence.min.y, bounds.centerY[i]);
+      coherence.min.z = std::min(coherence.min.z, bounds.centerZ[i]);
+      coherence.max.x = std::max(coherence.max.x, bounds.centerX[i]);
+      coherence.max.y = std::max(coherence.max.y, bounds.centerY[i]);
+      coherence.max.z = std::max(coherence.max.z, bounds.centerZ[i]);
+    }
+
+    partitionByVisibility(visibilityMasks.data());
+
+    coherence.referenceFrustum = frustum;
+    coherence.lastFrustum = frustum;
+    coherence.totalReferenceBoundaryIds = (u32)coherence.boundaryIds.size();
+    coherence.isValid = true;
+  }
+
+  /**
+   * Retests a single object against a frustum, and swaps it
+   * across the end of the visible partition if its visibility
+   * has changed. With hysteresis, visible objects are only
+   * hidden once they're more than the band outside the frustum.
+   */
+  void ObjectPool::retestVisibility(u32 index, const Frustum& frustum, bool useHysteresis) {
+    Vec3f center(bounds.centerX[index], bounds.centerY[index], bounds.centerZ[index]);
+    float slack = getSphereSlack(frustum, center, bounds.radius[index]);
+    bool wasVisible = index < totalVisibleObjects;
+    bool isVisible = wasVisible && useHysteresis ? slack >= -coherenceBand : slack >= 0.0f;
+
+    if (isVisible && !wasVisible) {
+      if (index != totalVisibleObjects) {
+        swapObjects(index, totalVisibleObjects);
+      }
+
+      totalVisibleObjects++;
+    } else if (!isVisible && wasVisible) {
+      totalVisibleObjects--;
+
+      if (index != totalVisibleObjects) {
+        swapObjects(index, totalVisibleObjects);
+      }
+    }
+  }
+
+  void ObjectPool::reserve(u32 size) {
+    free();
+
+    maxObjects = size;
+    totalActiveObjects = 0;
+    totalVisibleObjects = 0;
+    objects = new Object[size];
+    colors = new pVec4[size];
+
+    if (matrixFormat == MatrixFormat::AFFINE) {
+      affineMatrices = new Matrix4x3f[size];
+    } else {
+      matrices = new Matrix4f[size];
+    }
+
+    dirtyMatrices.reserve(size);
+    dirtyColors.reserve(size);
+
+    if (usesTransformStreams) {
+      allocateTransformStreams();
+    }
+
+    allocateBounds();
+
+    for (auto& column : columns) {
+      allocateColumn(column);
+    }
+  }
+
+  /**
+   * Reallocates the object/matrix/color arrays and transform
+   * streams to a new capacity, carrying over all active objects.
+   * Object IDs are unchanged, so ObjectRecords remain valid,
+   * although Object pointers/references do not.
+   *
+   * All active objects are marked dirty, since renderers
+   * reallocate their instance buffers to match.
+   */
+  void ObjectPool::resize(u32 capacity) {
+    assert(capacity >= totalActiveObjects, "Object Pool cannot be resized below its active object count");
+
+    auto* previousObjects = objects;
+    auto* previousMatrices = matrices;
+    auto* previousAffineMatrices = affineMatrices;
+    auto* previousColors = colors;
+    auto* previousStreamData = streamData;
+    u32 previousStreamStride = streamStride;
+    auto* previousBoundsData = boundsData;
+    u32 previousBoundsStride = boundsStride;
+
+    maxObjects = capacity;
+    objects = new Object[capacity];
+    colors = new pVec4[capacity];
+
+    std::copy(previousObjects, previousObjects + totalActiveObjects, objects);
+    std::copy(previousColors, previousColors + totalActiveObjects, colors);
+
+    if (matrixFormat == MatrixFormat::AFFINE) {
+      affineMatrices = new Matrix4x3f[capacity];
+
+      std::copy(previousAffineMatrices, previousAffineMatrices + totalActiveObjects, affineMatrices);
+    } else {
+      matrices = new Matrix4f[capacity];
+
+      std::copy(previousMatrices, previousMatrices + totalActiveObjects, matrices);
+    }
+
+    if (usesTransformStreams) {
+      allocateTransformStreams();
+
+      for (u32 i = 0; i < TOTAL_TRANSFORM_STREAMS; i++) {
+        float* stream = streamData + streamStride * i;
+        float* previousStream = previousStreamData + previousStreamStride * i;
+
+        std::copy(previousStream, previousStream + totalActiveObjects, stream);
+      }
+    }
+
+    allocateBounds();
+
+    for (u32 i = 0; i < TOTAL_BOUNDS_STREAMS; i++) {
+      float* stream = boundsData + boundsStride * i;
+      float* previousStream = previousBoundsData + previousBoundsStride * i;
+
+      std::copy(previousStream, previousStream + totalActiveObjects, stream);
+    }
+
+    for (auto& column : columns) {
+      u8* previousData = column.data;
+
+      allocateColumn(column);
+
+      std::memcpy(column.data, previousData, (u64)totalActiveObjects * column.elementSize);
+
+      delete[] previousData;
+    }
+
+    delete[] previousObjects;
+    delete[] previousMatrices;
+    delete[] previousAffineMatrices;
+    delete[] previousColors;
+
+    if (previousStreamData != nullptr) {
+      Gm_AlignedFree(previousStreamData);
+    }
+
+    if (previousBoundsData != nullptr) {
+      Gm_AlignedFree(previousBoundsData);
+    }
+
+    dirtyMatrices.reserve(capacity);
+    dirtyColors.reserve(capacity);
+    dirtyMatrices.markRange(0, totalActiveObjects);
+    dirtyColors.markRange(0, totalActiveObjects);
+  }
+
+  void ObjectPool::showAll() {
+    totalVisibleObjects = totalActiveObjects;
+
+    coherence.isValid = false;
+  }
+
+  /**
+   * Updates the index of the object using a given ID. Releasing
+   * an ID (by setting UNUSED_OBJECT_INDEX) advances its generation,
+   * wrapping around after 256 uses.
+   */
+  void ObjectPool::setIndex(u32 objectId, u32 index) {
+    u32& slot = slotPages[objectId / SLOT_PAGE_SIZE][objectId % SLOT_PAGE_SIZE];
+    u32 generation = slot >> SLOT_GENERATION_SHIFT;
+
+    if (index == UNUSED_OBJECT_INDEX) {
+      generation = (generation + 1) & 0xff;
+    }
+
+    slot = (generation << SLOT_GENERATION_SHIFT) | index;
+  }
+
+  /**
+   * Sets the model space bounding sphere of the pool's objects,
+   * and updates the world space bounding spheres of any active
+   * objects to match.
+   */
+  void ObjectPool::setBoundingSphere(const Vec3f& center, float radius) {
+    localCenter = center;
+    localRadius = radius;
+
+    updateBounds(0, totalActiveObjects);
+    onBoundsUpdated(0, totalActiveObjects);
+  }
+
+  /**
+   * Stores a transposed transformation matrix at a given
+   * index, packing it if the pool uses AFFINE matrices.
+   */
+  void ObjectPool::setMatrix(u32 index, const Matrix4f& matrix) {
+    if (matrixFormat == MatrixFormat::AFFINE) {
+      affineMatrices[index] = Matrix4x3f::fromMatrix4f(matrix);
+    } else {
+      matrices[index] = matrix;
+    }
+  }
+
+  /**
+   * Sets the format of the pool's object matrices. Must be
+   * set before the pool is reserved, since renderers size
+   * their instance buffers according to the format.
+   */
+  void ObjectPool::setMatrixFormat(MatrixFormat format) {
+    assert(maxObjects == 0, "Object Pool matrix format must be set before reserving the pool");
+
+    matrixFormat = format;
+  }
+
+  /**
+   * Sets how objects are rotated. Pools using quaternion
+   * rotation keep their object orientations in a column named
+   * "orientation", starting out as the identity rotation.
+   */
+  void ObjectPool::setRotationMode(RotationMode mode) {
+    assert(mode == RotationMode::EULER || !usesTransformStreams, "Quaternion rotation is not supported with transform streams");
+
+    rotationMode = mode;
+
+    if (mode == RotationMode::QUATERNION && !hasOrientations) {
+      auto* orientations = addColumn<Quaternion>(ORIENTATION_COLUMN);
+
+      for (u32 i = 0; i < totalActiveObjects; i++) {
+        orientations[i] = { 1.0f, 0.0f, 0.0f, 0.0f };
+      }
+
+      hasOrientations = true;
+    }
+  }
+
+  void ObjectPool::setTransform(u32 index, const Vec3f& position, const Vec3f& scale, const Vec3f& rotation) {
+    streams.positionX[index] = position.x;
+    streams.positionY[index] = position.y;
+    streams.positionZ[index] = position.z;
+    streams.scaleX[index] = scale.x;
+    streams.scaleY[index] = scale.y;
+    streams.scaleZ[index] = scale.z;
+    streams.rotationX[index] = rotation.x;
+    streams.rotationY[index] = rotation.y;
+    streams.rotationZ[index] = rotation.z;
+  }
+
+  /**
+   * Writes the transform of the object using a given ID to
+   * the transform streams, if in use. Does not update the
+   * object's matrix.
+   */
+  void ObjectPool::setTransformById(u32 objectId, const Vec3f& position, const Vec3f& scale, const Vec3f& rotation) {
+    if (usesTransformStreams) {
+      setTransform(getIndex(objectId), position, scale, rotation);
+    }
+  }
+
+  /**
+   * Reduces the capacity of the pool to its active object
+   * count (or a single object, for empty pools), releasing
+   * memory once a pool is done growing.
+   */
+  void ObjectPool::shrinkToFit() {
+    u32 capacity = totalActiveObjects > 0 ? totalActiveObjects : 1;
+
+    if (maxObjects > capacity) {
+      resize(capacity);
+    }
+  }
+
+  void ObjectPool::swapObjects(u32 indexA, u32 indexB) {
+    Object objectA = objects[indexA];
+    pVec4 colorA = colors[indexA];
+
+    objects[indexA] = objects[indexB];
+    colors[indexA] = colors[indexB];
+
+    objects[indexB] = objectA;
+    colors[indexB] = colorA;
+
+    if (matrixFormat == MatrixFormat::AFFINE) {
+      Matrix4x3f matrixA = affineMatrices[indexA];
+
+      affineMatrices[indexA] = affineMatrices[indexB];
+      affineMatrices[indexB] = matrixA;
+    } else {
+      Matrix4f matrixA = matrices[indexA];
+
+      matrices[indexA] = matrices[indexB];
+      matrices[indexB] = matrixA;
+    }
+
+    if (usesTransformStreams) {
+      for (u32 i = 0; i < TOTAL_TRANSFORM_STREAMS; i++) {
+        float* stream = streamData + streamStride * i;
+        float valueA = stream[indexA];
+
+        stream[indexA] = stream[indexB];
+        stream[indexB] = valueA;
+      }
+    }
+
+    for (u32 i = 0; i < TOTAL_BOUNDS_STREAMS; i++) {
+      float* stream = boundsData + boundsStride * i;
+      float valueA = stream[indexA];
+
+      stream[indexA] = stream[indexB];
+      stream[indexB] = valueA;
+    }
+
+    for (auto& column : columns) {
+      u8* entryA = column.data + (u64)indexA * column.elementSize;
+      u8* entryB = column.data + (u64)indexB * column.elementSize;
+
+      std::swap_ranges(entryA, entryA + column.elementSize, entryB);
+    }
+
+    setIndex(objects[indexA]._record.id, indexA);
+    setIndex(objects[indexB]._record.id, indexB);
+
+    markDirty(indexA);
+    markDirty(indexB);
+  }
+
+  void ObjectPool::setColorById(u32 objectId, const pVec4& color) {
+    u32 index = getIndex(objectId);
+
+    colors[index] = color;
+
+    dirtyColors.mark(index);
+  }
+
+  /**
+   * Swaps the IDs of objects whose bounds have changed since
+   * the last call into objectIds. Returns true if every object
+   * should be considered changed instead, in which case no
+   * IDs are provided.
+   */
+  bool ObjectPool::takeChangedBounds(std::vector<u32>& objectIds) {
+    bool isEveryObjectChanged = hasAllBoundsChanged;
+
+    objectIds.clear();
+    objectIds.swap(changedBoundsIds);
+
+    hasAllBoundsChanged = false;
+
+    return isEveryObjectChanged;
+  }
+
+  u32 ObjectPool::totalActive() const {
     return totalActiveObjects;
   }
 
-  u16 ObjectPool::totalVisible() const {
+  u32 ObjectPool::totalVisible() const {
     return totalVisibleObjects;
   }
 
-  void ObjectPool::transformById(u16 objectId, const Matrix4f& matrix) {
-    matrices[indices[objectId]] = matrix;
+  void ObjectPool::transformById(u32 objectId, const Matrix4f& matrix) {
+    u32 index = getIndex(objectId);
+
+    setMatrix(index, matrix);
+    updateBounds(index, index + 1);
+    onBoundsUpdated(index, index + 1);
+
+    dirtyMatrices.mark(index);
+  }
+
+  /**
+   * Recomputes the world space bounding spheres of objects
+   * [start, end) from their matrices. Spheres are scaled by
+   * the largest axis scale of each matrix, so they enclose
+   * their objects under non-uniform scaling.
+   */
+  void ObjectPool::updateBounds(u32 start, u32 end) {
+    // Matrices are stored as columns of 4 (FULL)
+    // or 3 (AFFINE) components
+    bool isAffine = matrixFormat == MatrixFormat::AFFINE;
+    const float* matrixData = isAffine ? (const float*)affineMatrices : (const float*)matrices;
+    u32 columnSize = isAffine ? 3 : 4;
+    u32 matrixSize = columnSize * 4;
+
+    for (u32 i = start; i < end; i++) {
+      const float* m = matrixData + (u64)i * matrixSize;
+      const float* x = m;
+      const float* y = m + columnSize;
+      const float* z = m + columnSize * 2;
+      const float* t = m + columnSize * 3;
+
+      float scaleX = x[0] * x[0] + x[1] * x[1] + x[2] * x[2];
+      float scaleY = y[0] * y[0] + y[1] * y[1] + y[2] * y[2];
+      float scaleZ = z[0] * z[0] + z[1] * z[1] + z[2] * z[2];
+      float maxScale = sqrtf(std::max(scaleX, std::max(scaleY, scaleZ)));
+
+      bounds.centerX[i] = x[0] * localCenter.x + y[0] * localCenter.y + z[0] * localCenter.z + t[0];
+      bounds.centerY[i] = x[1] * localCenter.x + y[1] * localCenter.y + z[1] * localCenter.z + t[1];
+      bounds.centerZ[i] = x[2] * localCenter.x + y[2] * localCenter.y + z[2] * localCenter.z + t[2];
+      bounds.radius[i] = localRadius * maxScale;
+    }
+  }
+
+  /**
+   * Moves objects [start, end) to the grid cells containing
+   * their bounding sphere centers, if a grid is in use.
+   */
+  void ObjectPool::updateGrid(u32 start, u32 end) {
+    if (!usesSpatialGrid) {
+      return;
+    }
+
+    for (u32 i = start; i < end; i++) {
+      Vec3f center(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]);
+
+      grid.update(objects[i]._record.id, center, bounds.radius[i]);
+    }
+  }
+
+  /**
+   * Passes each dirty range of the active object matrices and
+   * colors to an upload handler, and clears them. Returns the
+   * total number of bytes uploaded.
+   */
+  u32 ObjectPool::uploadDirtyRanges(const PoolUploadHandler& upload) const {
+    u32 totalBytes = 0;
+    u32 matrixSize = getMatrixSize();
+    auto* matrixData = matrixFormat == MatrixFormat::AFFINE ? (const u8*)affineMatrices : (const u8*)matrices;
+
+    dirtyRanges.clear();
+    dirtyMatrices.getRanges(totalActiveObjects, dirtyRanges);
+
+    for (auto& range : dirtyRanges) {
+      u32 byteOffset = range.start * matrixSize;
+      u32 byteLength = (range.end - range.start) * matrixSize;
+
+      upload(PoolBuffer::MATRICES, byteOffset, byteLength, matrixData + byteOffset);
+
+      totalBytes += byteLength;
+    }
+
+    dirtyRanges.clear();
+    dirtyColors.getRanges(totalActiveObjects, dirtyRanges);
+
+    for (auto& range : dirtyRanges) {
+      u32 byteLength = (range.end - range.start) * sizeof(pVec4);
+
+      upload(PoolBuffer::COLORS, range.start * sizeof(pVec4), byteLength, &colors[range.start]);
+
+      totalBytes += byteLength;
+    }
+
+    dirtyMatrices.clear();
+    dirtyColors.clear();
+
+    return totalBytes;
+  }
+
+  /**
+   * Starts tracking which objects' bounds change, for
+   * takeChangedBounds(). Every existing object starts out
+   * as changed.
+   */
+  void ObjectPool::useBoundsTracking() {
+    if (usesBoundsTracking) {
+      return;
+    }
+
+    usesBoundsTracking = true;
+    hasAllBoundsChanged = true;
+  }
+
+  /**
+   * Starts carrying visibility and distance partitions over
+   * between calls, with a hysteresis band (in world units)
+   * that objects must pass before changing partitions. Wider
+   * bands retest more objects per partition, but tolerate more
+   * camera movement before every object is retested.
+   */
+  void ObjectPool::useCoherentPartitioning(float band) {
+    usesCoherentPartitioning = true;
+    coherenceBand = band;
+
+    coherence.isValid = false;
+    coherence.distancePivots.clear();
+  }
+
+  /**
+   * Starts keeping the pool's objects in a SpatialGrid with
+   * a given cell size, adding any existing objects. Cells
+   * should be a few times larger than the objects in them.
+   */
+  void ObjectPool::useSpatialGrid(float cellSize) {
+    usesSpatialGrid = true;
+
+    grid.setCellSize(cellSize);
+
+    updateGrid(0, totalActiveObjects);
+  }
+
+  /**
+   * Switches the pool over to keeping its object transforms
+   * in TransformStreams. Existing objects have their current
+   * transforms copied into the streams.
+   */
+  void ObjectPool::useTransformStreams() {
+    if (usesTransformStreams) {
+      return;
+    }
+
+    assert(rotationMode == RotationMode::EULER, "Transform streams only support Euler rotation");
+
+    usesTransformStreams = true;
+
+    if (maxObjects > 0) {
+      allocateTransformStreams();
+
+      for (u32 i = 0; i < totalActiveObjects; i++) {
+        auto& object = objects[i];
+
+        setTransform(i, object.position, object.scale, object.rotation);
+      }
+    }
   }
 }
\ No newline at end of file
@@ -1,13 +1,157 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "math/batch_culling.h"
+#include "math/batch_transforms.h"
 #include "math/matrix.h"
+#include "math/Quaternion.h"
+#include "math/vector.h"
+#include "system/DirtyRangeTracker.h"
 #include "system/packed_data.h"
+#include "system/SpatialGrid.h"
 #include "system/type_aliases.h"
 
 namespace Gamma {
   struct Object;
   struct ObjectRecord;
-  struct Camera;
+
+  /**
+   * Determines whether objects are rotated by their Euler
+   * angle rotation or a quaternion orientation. Quaternion
+   * rotation skips the Euler -> quaternion conversion when
+   * committing objects. Orientations are kept by the pool
+   * rather than by each Object, so pools using Euler
+   * rotation don't pay for them.
+   */
+  enum class RotationMode {
+    EULER,
+    QUATERNION
+  };
+
+  /**
+   * Determines how object matrices are stored and uploaded.
+   * AFFINE matrices omit the constant last row of each
+   * transformation matrix, taking up 48 bytes rather than 64.
+   */
+  enum class MatrixFormat {
+    FULL,
+    AFFINE
+  };
+
+  /**
+   * Per-object data arrays which are uploaded to the GPU.
+   */
+  enum class PoolBuffer {
+    MATRICES,
+    COLORS
+  };
+
+  /**
+   * Receives a byte range of a pool buffer to upload, along
+   * with a pointer to the start of the data in that range.
+   */
+  typedef std::function<void(PoolBuffer buffer, u32 byteOffset, u32 byteLength, const void* data)> PoolUploadHandler;
+
+  /**
+   * ObjectColumn
+   * ------------
+   *
+   * A contiguous array of user data attached to the objects in
+   * an ObjectPool, e.g. velocity or health. Column entries are
+   * kept at the same indexes as their objects.
+   */
+  struct ObjectColumn {
+    std::string name;
+    u32 elementSize = 0;
+    u8* data = nullptr;
+  };
+
+  /**
+   * DistancePivot
+   * -------------
+   *
+   * The end of the range of objects found to be within a given
+   * distance of the camera by partitionByDistance().
+   */
+  struct DistancePivot {
+    float distance = 0.0f;
+    u32 end = 0;
+  };
+
+  /**
+   * LodThreshold
+   * ------------
+   *
+   * The extent of a level of detail, used by objects within
+   * distance + radius * radiusScale of the camera. Thresholds
+   * by distance only use a distance, whereas thresholds by
+   * screen size only use a radius scale, since an object's
+   * projected size is proportional to radius / distance.
+   */
+  struct LodThreshold {
+    float distance = 0.0f;
+    float radiusScale = 0.0f;
+  };
+
+  /**
+   * VisibilityCoherence
+   * -------------------
+   *
+   * Visibility state carried between partitions by pools using
+   * coherent partitioning. Objects are retested in full against
+   * a reference frustum, which identifies the objects close
+   * enough to its planes to change visibility. Until the view
+   * frustum drifts too far from the reference frustum, only
+   * those objects and objects which have moved are retested.
+   */
+  struct VisibilityCoherence {
+    Frustum referenceFrustum;
+    Frustum lastFrustum;
+    /**
+     * Bounds of the object bounding sphere centers, which
+     * determine how far objects can have drifted relative to
+     * the frustum planes as the frustum changes.
+     */
+    Vec3f min;
+    Vec3f max;
+    /**
+     * IDs of objects within the hysteresis band of the
+     * reference frustum's planes.
+     */
+    std::vector<u32> boundaryIds;
+    u32 totalReferenceBoundaryIds = 0;
+    /**
+     * IDs of objects whose bounds have changed since
+     * they were last tested.
+     */
+    std::vector<u32> movedIds;
+    std::vector<DistancePivot> distancePivots;
+    std::vector<float> slack;
+    bool isValid = false;
+  };
+
+  /**
+   * ObjectSpan
+   * ----------
+   *
+   * A contiguous range of Objects in an ObjectPool. Only valid
+   * until objects are next created in or removed from the pool.
+   */
+  struct ObjectSpan {
+    Object* first = nullptr;
+    u32 count = 0;
+
+    Object& operator[](u32 index) const;
+
+    Object* begin() const;
+    Object* end() const;
+    u32 size() const;
+  };
 
   /**
    * ObjectPool
@@ -16,45 +160,310 @@ namespace Gamma {
    * A collection of Objects tied to a given Mesh, designed
    * to facilitate instanced/batched rendering.
    *
-   * @todo u16 -> u32 to support >65K objects per pool
+   * Objects are identified by 24-bit IDs, which are recycled
+   * once their objects are removed. IDs are resolved to object
+   * indexes through a paged lookup table, whose pages are only
+   * allocated once IDs in their range are handed out.
+   *
+   * Pools can optionally keep their object transforms in
+   * TransformStreams, allowing all instance matrices to be
+   * recomputed in bulk with computeMatrices(). Streams are
+   * kept in the same order as the objects themselves.
+   *
+   * Changes to object matrices and colors are tracked as dirty
+   * ranges, so only the changed parts of each array need to be
+   * uploaded with uploadDirtyRanges(). Pools can store their
+   * matrices in the compact AFFINE format to reduce the size
+   * of both the matrix array and its uploads by 25%.
+   *
+   * Pools grow geometrically when objects are created beyond
+   * their capacity, and can be shrunk with shrinkToFit(). Since
+   * object arrays are reallocated as pools are resized, Objects
+   * should be retained by ObjectRecord rather than by pointer.
+   *
+   * Objects can be created in bulk with createObjects(), and
+   * removed in bulk with removeIf(), which compacts the pool
+   * in a single pass rather than removing objects one by one.
+   *
+   * Each object has a world space bounding sphere, derived from
+   * the pool's model space bounding sphere whenever the object's
+   * matrix changes. Bounding spheres are kept in BoundsStreams,
+   * and used to cull objects against a view frustum.
+   *
+   * Pools of objects which move every frame can also keep
+   * their objects in a SpatialGrid, enabled with
+   * useSpatialGrid(), which is updated as objects are
+   * committed. Grids allow whole cells of objects to be culled
+   * at once, and answer sphere and nearest-object queries.
+   *
+   * Pools viewed by a camera which moves gradually, if at all,
+   * can use useCoherentPartitioning() to carry the previous
+   * frame's partitions over to the next. Only objects near the
+   * frustum planes or the distance thresholds are then
+   * retested, and objects only move between partitions once
+   * they're past a hysteresis band, so objects and their
+   * matrices are rarely swapped around once the camera rests.
+   *
+   * Pools can track which objects' bounding spheres change with
+   * useBoundsTracking(), so scene-wide structures built over
+   * several pools only need to update those objects.
+   *
+   * Pools can also carry typed user data columns, registered
+   * with addColumn<T>(). Column entries move in lockstep with
+   * their objects, so systems can update them linearly over
+   * the same indexes as the objects and their matrices.
+   *
+   * Objects can be committed individually, or in bulk with
+   * commitObjects(), which splits large ranges across
+   * worker threads. Pools using transform streams commit their
+   * stream transforms rather than their Objects' transforms.
    */
   class ObjectPool {
   public:
     Object& operator[](u32 index);
 
+    template<typename T>
+    T* addColumn(const std::string& name);
     Object* begin() const;
+    void commitObjects();
+    void commitObjects(u32 start, u32 end);
+    void computeMatrices();
+    void computeMatrices(u32 start, u32 end);
     Object& createObject();
+    ObjectSpan createObjects(u32 total);
     Object* end() const;
     void free();
-    Object* getById(u16 objectId) const;
+    Object* getById(u32 objectId) const;
     Object* getByRecord(const ObjectRecord& record) const;
+    Matrix4x3f* getAffineMatrices() const;
+    const BoundsStreams& getBounds() const;
     pVec4* getColors() const;
+    template<typename T>
+    T* getColumn(const std::string& name) const;
     Matrix4f* getMatrices() const;
-    u16 max() const;
-    u16 partitionByDistance(u16 start, float distance, const Vec3f& cameraPosition);
-    void partitionByVisibility(const Camera& camera);
-    void removeById(u16 objectId);
+    MatrixFormat getMatrixFormat() const;
+    u32 getMatrixSize() const;
+    Quaternion* getOrientations() const;
+    RotationMode getRotationMode() const;
+    const SpatialGrid& getSpatialGrid() const;
+    const TransformStreams& getTransformStreams() const;
+    bool hasSpatialGrid() const;
+    bool hasTransformStreams() const;
+    u32 indexOf(const Object& object) const;
+    u32 max() const;
+    u32 partitionByDistance(u32 start, float distance, const Vec3f& cameraPosition);
+    void partitionByLod(const Vec3f& cameraPosition, const LodThreshold* thresholds, u32 totalLods, float hysteresis, u32* lodCounts);
+    void partitionByVisibility(const Frustum& frustum);
+    void partitionByVisibility(const u32* visibilityMasks);
+    void removeById(u32 objectId);
+    template<typename Predicate>
+    u32 removeIf(Predicate predicate);
     void reset();
-    void reserve(u16 size);
-    void setColorById(u16 objectId, const pVec4& color);
+    void reserve(u32 size);
+    void setBoundingSphere(const Vec3f& center, float radius);
+    void setColorById(u32 objectId, const pVec4& color);
+    void setMatrixFormat(MatrixFormat format);
+    void setRotationMode(RotationMode mode);
+    void setTransformById(u32 objectId, const Vec3f& position, const Vec3f& scale, const Vec3f& rotation);
     void showAll();
-    u16 totalActive() const;
-    u16 totalVisible() const;
-    void transformById(u16 objectId, const Matrix4f& matrix);
+    void shrinkToFit();
+    bool takeChangedBounds(std::vector<u32>& objectIds);
+    u32 totalActive() const;
+    u32 totalVisible() const;
+    void transformById(u32 objectId, const Matrix4f& matrix);
+    u32 uploadDirtyRanges(const PoolUploadHandler& upload) const;
+    void useBoundsTracking();
+    void useCoherentPartitioning(float band);
+    void useSpatialGrid(float cellSize);
+    void useTransformStreams();
 
   private:
     Object* objects = nullptr;
+    /**
+     * Only one of matrices/affineMatrices is allocated,
+     * depending on the pool's matrix format.
+     */
     Matrix4f* matrices = nullptr;
+    Matrix4x3f* affineMatrices = nullptr;
     pVec4* colors = nullptr;
-    // @todo if we cycle through indices to find unoccupied slots
-    // when creating new objects, we needn't preallocate the entire
-    // indices array up to USHRT_MAX/0xffff
-    u16 indices[0xffff];
-    u16 maxObjects = 0;
-    u16 totalActiveObjects = 0;
-    u16 totalVisibleObjects = 0;
-    u16 runningId = 0;
+    MatrixFormat matrixFormat = MatrixFormat::FULL;
+    /**
+     * Position, scale and rotation streams, carved out of a
+     * single 32-byte aligned block when transform streams are
+     * in use.
+     */
+    TransformStreams streams;
+    float* streamData = nullptr;
+    u32 streamStride = 0;
+    bool usesTransformStreams = false;
+    /**
+     * World space bounding sphere streams, carved out of
+     * a single 32-byte aligned block like transform streams.
+     */
+    BoundsStreams bounds;
+    float* boundsData = nullptr;
+    u32 boundsStride = 0;
+    /**
+     * The model space bounding sphere shared by all objects.
+     */
+    Vec3f localCenter = Vec3f(0.0f);
+    float localRadius = 0.0f;
+    /**
+     * Visibility bits written by the culling kernel, reused
+     * across calls to partitionByVisibility().
+     */
+    std::vector<u32> visibilityMasks;
+    /**
+     * Objects indexed by ID, when a spatial grid is in use.
+     * Since grid entries are keyed by ID, they don't need to
+     * be moved along with their objects.
+     */
+    SpatialGrid grid;
+    bool usesSpatialGrid = false;
+    std::vector<u32> visibleIds;
+    /**
+     * The level of detail each object was last assigned by
+     * partitionByLod(), indexed by object ID.
+     */
+    std::vector<u8> lodsById;
+    std::vector<u8> lodIndexes;
+    std::vector<u32> lodOffsets;
+    VisibilityCoherence coherence;
+    float coherenceBand = 0.0f;
+    bool usesCoherentPartitioning = false;
+    /**
+     * IDs of objects whose bounds have changed since they were
+     * last taken with takeChangedBounds(). Once too many objects
+     * change, every object is considered changed instead.
+     */
+    std::vector<u32> changedBoundsIds;
+    bool hasAllBoundsChanged = false;
+    bool usesBoundsTracking = false;
+    RotationMode rotationMode = RotationMode::EULER;
+    /**
+     * Whether the pool has an orientation column, which is
+     * added once it first uses quaternion rotation.
+     */
+    bool hasOrientations = false;
+    /**
+     * Dirty ranges are cleared whenever they are uploaded,
+     * which does not otherwise modify the pool.
+     */
+    mutable DirtyRangeTracker dirtyMatrices;
+    mutable DirtyRangeTracker dirtyColors;
+    mutable std::vector<DirtyRange> dirtyRanges;
+    /**
+     * Pages of ID -> slot entries. Each slot packs the index
+     * of the object using the ID into its lower 24 bits, and
+     * the current generation of the ID into its upper 8 bits.
+     */
+    std::vector<u32*> slotPages;
+    /**
+     * IDs released by removed objects, reused before any
+     * new IDs are issued.
+     */
+    std::vector<u32> freeIds;
+    /**
+     * User data columns, which retain their definitions when
+     * the pool is freed and are reallocated on reserve().
+     */
+    std::vector<ObjectColumn> columns;
+    u32 maxObjects = 0;
+    u32 totalActiveObjects = 0;
+    u32 totalVisibleObjects = 0;
+    u32 runningId = 0;
 
-    void swapObjects(u16 indexA, u16 indexB);
+    void allocateBounds();
+    void allocateColumn(ObjectColumn& column);
+    void allocateTransformStreams();
+    u8* createColumn(const std::string& name, u32 elementSize);
+    void fillGap(u32 fromIndex, u32 gapIndex);
+    u8* findColumn(const std::string& name, u32 elementSize) const;
+    u32 finishRemoval(u32 remaining);
+    void commitBatch(u32 start, u32 end);
+    void computeStreamMatrices(u32 start, u32 end);
+    u32 getIndex(u32 objectId) const;
+    Vec3f getPosition(u32 index) const;
+    void grow(u32 minimumCapacity);
+    void initializeObject(u32 index);
+    u32 issueId();
+    void markDirty(u32 index);
+    void moveMatrix(u32 fromIndex, u32 toIndex);
+    void moveObject(u32 fromIndex, u32 toIndex);
+    void onBoundsUpdated(u32 start, u32 end);
+    void partitionByCoherentVisibility(const Frustum& frustum);
+    void releaseId(u32 objectId);
+    void releaseObjectAt(u32 index);
+    void retestCoherentVisibility(const Frustum& frustum);
+    void retestVisibility(u32 index, const Frustum& frustum, bool useHysteresis);
+    void resize(u32 capacity);
+    void setTransform(u32 index, const Vec3f& position, const Vec3f& scale, const Vec3f& rotation);
+    void setIndex(u32 objectId, u32 index);
+    void setMatrix(u32 index, const Matrix4f& matrix);
+    void swapObjects(u32 indexA, u32 indexB);
+    void updateBounds(u32 start, u32 end);
+    void updateGrid(u32 start, u32 end);
   };
+
+  /**
+   * Registers a user data column of type T, zero-initialized
+   * for all objects. Returns the column data, which stays valid
+   * until the pool is next resized; use getColumn<T>() to fetch
+   * it again afterward.
+   */
+  template<typename T>
+  T* ObjectPool::addColumn(const std::string& name) {
+    static_assert(std::is_trivially_copyable<T>::value, "Object Pool columns must be trivially copyable");
+    static_assert(alignof(T) <= alignof(std::max_align_t), "Object Pool columns cannot be over-aligned");
+
+    return (T*)createColumn(name, sizeof(T));
+  }
+
+  template<typename T>
+  T* ObjectPool::getColumn(const std::string& name) const {
+    return (T*)findColumn(name, sizeof(T));
+  }
+
+  /**
+   * Removes all objects matching a predicate, which receives
+   * a const Object&, in a single pass. Gaps left by removed
+   * objects are filled with remaining objects from the end of
+   * the pool, so at most one object is moved per removed object.
+   * Returns the number of objects removed.
+   *
+   * Only the pool itself is updated, so the scene BVH keeps
+   * the records of removed objects until it finds them to be
+   * stale, and the scene graph keeps their nodes. Scene objects
+   * should be removed with Gm_RemoveObjectsIf() instead, which
+   * removes their records from both.
+   */
+  template<typename Predicate>
+  u32 ObjectPool::removeIf(Predicate predicate) {
+    u32 current = 0;
+    u32 end = totalActiveObjects;
+
+    while (current < end) {
+      if (!predicate((const Object&)(*this)[current])) {
+        current++;
+
+        continue;
+      }
+
+      releaseObjectAt(current);
+
+      // Find the last remaining object to fill the gap,
+      // removing any matching objects along the way
+      while (--end > current && predicate((const Object&)(*this)[end])) {
+        releaseObjectAt(end);
+      }
+
+      if (end > current) {
+        fillGap(end, current);
+
+        current++;
+      }
+    }
+
+    return finishRemoval(current);
+  }
 }
\ No newline at end of file
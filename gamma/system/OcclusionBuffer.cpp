@@ -0,0 +1,688 @@
+#include <algorithm>
+#include <cmath>
+
+#include "math/batch_culling.h"
+#include "math/simd.h"
+#include "system/jobs.h"
+#include "system/OcclusionBuffer.h"
+
+namespace Gamma {
+  /**
+   * Tile dimensions, in pixels. Each tile's coverage mask has
+   * one bit per pixel, in rows of TILE_WIDTH bits.
+   */
+  constexpr static u32 TILE_WIDTH = 8;
+  constexpr static u32 TILE_HEIGHT = 4;
+  constexpr static u32 FULL_TILE_MASK = 0xFFFFFFFF;
+
+  /**
+   * The number of occluder objects set up per job, and the
+   * number of objects tested per job. Tested objects are split
+   * on multiples of 32 so jobs never share visibility bits.
+   */
+  constexpr static u32 OCCLUDER_BATCH_SIZE = 16;
+  constexpr static u32 OCCLUDEE_BATCH_SIZE = 1024;
+
+  /**
+   * Clipped triangles have at most one extra vertex per
+   * clipping plane: near, left, right, bottom and top.
+   */
+  constexpr static u32 TOTAL_CLIP_PLANES = 5;
+  constexpr static u32 MAX_CLIPPED_VERTICES = 3 + TOTAL_CLIP_PLANES;
+
+  /**
+   * Triangles smaller than this many square pixels are
+   * treated as degenerate, and skipped.
+   */
+  constexpr static float MIN_TRIANGLE_AREA = 1e-6f;
+
+  /**
+   * The face elements of an occluder, and the range of
+   * vertices they refer to.
+   */
+  struct OccluderGeometry {
+    const Vertex* vertices;
+    const u32* elements;
+    u32 totalElements;
+    u32 firstVertex;
+    u32 endVertex;
+  };
+
+  /**
+   * Returns the signed distance of a clip space vertex from
+   * one of the clipping planes, which is non-negative for
+   * vertices on the inner side of the plane.
+   */
+  inline static float getClipDistance(const Vec4f& vertex, u32 plane) {
+    switch (plane) {
+      case 0: return vertex.z + vertex.w;
+      case 1: return vertex.w + vertex.x;
+      case 2: return vertex.w - vertex.x;
+      case 3: return vertex.w + vertex.y;
+      default: return vertex.w - vertex.y;
+    }
+  }
+
+  inline static Vec4f lerpClipVertex(const Vec4f& a, const Vec4f& b, float alpha) {
+    return Vec4f(
+      a.x + (b.x - a.x) * alpha,
+      a.y + (b.y - a.y) * alpha,
+      a.z + (b.z - a.z) * alpha,
+      a.w + (b.w - a.w) * alpha
+    );
+  }
+
+  /**
+   * Returns the (row-major) model matrix of a pooled object.
+   */
+  static Matrix4f getModelMatrix(const ObjectPool& pool, u32 index) {
+    if (pool.getMatrixFormat() == MatrixFormat::AFFINE) {
+      return pool.getAffineMatrices()[index].toMatrix4f().transpose();
+    } else {
+      return pool.getMatrices()[index].transpose();
+    }
+  }
+
+  /**
+   * Projects a triangle of clip space vertices onto the screen,
+   * and appends it to a triangle list along with its edge
+   * functions and depth plane. Vertices are expected to be
+   * inside the clipping planes.
+   */
+  static void setupTriangle(const Vec4f& c0, const Vec4f& c1, const Vec4f& c2, float width, float height, std::vector<OcclusionTriangle>& triangles) {
+    const Vec4f* clipVertices[3] = { &c0, &c1, &c2 };
+    float x[3];
+    float y[3];
+    float z[3];
+
+    for (u32 i = 0; i < 3; i++) {
+      auto& vertex = *clipVertices[i];
+      float inverseW = 1.0f / vertex.w;
+
+      x[i] = (vertex.x * inverseW * 0.5f + 0.5f) * width;
+      y[i] = (vertex.y * inverseW * 0.5f + 0.5f) * height;
+      z[i] = inverseW;
+    }
+
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+
+    if (std::abs(area) < MIN_TRIANGLE_AREA) {
+      return;
+    }
+
+    // Occluders are rasterized regardless of their facing,
+    // so wind clockwise triangles counter-clockwise
+    if (area < 0.0f) {
+      std::swap(x[1], x[2]);
+      std::swap(y[1], y[2]);
+      std::swap(z[1], z[2]);
+
+      area = -area;
+    }
+
+    OcclusionTriangle triangle;
+
+    // Pixels are covered when their centers are inside the
+    // triangle, so bounds are snapped to pixel centers
+    float minX = std::min({ x[0], x[1], x[2] });
+    float minY = std::min({ y[0], y[1], y[2] });
+    float maxX = std::max({ x[0], x[1], x[2] });
+    float maxY = std::max({ y[0], y[1], y[2] });
+
+    triangle.minX = std::max(0, (s32)std::ceil(minX - 0.5f));
+    triangle.minY = std::max(0, (s32)std::ceil(minY - 0.5f));
+    triangle.maxX = std::min((s32)width - 1, (s32)std::floor(maxX - 0.5f));
+    triangle.maxY = std::min((s32)height - 1, (s32)std::floor(maxY - 0.5f));
+
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+      return;
+    }
+
+    for (u32 i = 0; i < 3; i++) {
+      u32 j = (i + 1) % 3;
+
+      triangle.edgeA[i] = y[i] - y[j];
+      triangle.edgeB[i] = x[j] - x[i];
+      triangle.edgeC[i] = -(triangle.edgeA[i] * x[i] + triangle.edgeB[i] * y[i]);
+    }
+
+    float inverseArea = 1.0f / area;
+
+    triangle.depthA = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) * inverseArea;
+    triangle.depthB = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) * inverseArea;
+    triangle.depthC = z[0] - triangle.depthA * x[0] - triangle.depthB * y[0];
+    triangle.minDepth = std::min({ z[0], z[1], z[2] });
+
+    triangles.push_back(triangle);
+  }
+
+  /**
+   * Clips a clip space triangle against the near and side
+   * planes, and sets up the triangles of the clipped polygon.
+   */
+  static void clipTriangle(const Vec4f& c0, const Vec4f& c1, const Vec4f& c2, float width, float height, std::vector<OcclusionTriangle>& triangles) {
+    Vec4f polygon[MAX_CLIPPED_VERTICES];
+    Vec4f clipped[MAX_CLIPPED_VERTICES];
+    u32 totalVertices = 3;
+    u32 outsidePlanes = 0;
+
+    polygon[0] = c0;
+    polygon[1] = c1;
+    polygon[2] = c2;
+
+    for (u32 plane = 0; plane < TOTAL_CLIP_PLANES; plane++) {
+      u32 totalOutside = 0;
+
+      for (u32 i = 0; i < 3; i++) {
+        if (getClipDistance(polygon[i], plane) < 0.0f) {
+          totalOutside++;
+        }
+      }
+
+      if (totalOutside == 3) {
+        return;
+      }
+
+      if (totalOutside > 0) {
+        outsidePlanes |= 1 << plane;
+      }
+    }
+
+    for (u32 plane = 0; plane < TOTAL_CLIP_PLANES; plane++) {
+      if ((outsidePlanes & (1 << plane)) == 0) {
+        continue;
+      }
+
+      u32 totalClipped = 0;
+
+      for (u32 i = 0; i < totalVertices; i++) {
+        auto& a = polygon[i];
+        auto& b = polygon[(i + 1) % totalVertices];
+        float distanceA = getClipDistance(a, plane);
+        float distanceB = getClipDistance(b, plane);
+
+        if (distanceA >= 0.0f) {
+          clipped[totalClipped++] = a;
+        }
+
+        if ((distanceA >= 0.0f) != (distanceB >= 0.0f)) {
+          clipped[totalClipped++] = lerpClipVertex(a, b, distanceA / (distanceA - distanceB));
+        }
+      }
+
+      if (totalClipped < 3) {
+        return;
+      }
+
+      std::copy(clipped, clipped + totalClipped, polygon);
+
+      totalVertices = totalClipped;
+    }
+
+    for (u32 i = 1; i + 1 < totalVertices; i++) {
+      setupTriangle(polygon[0], polygon[i], polygon[i + 1], width, height, triangles);
+    }
+  }
+
+  /**
+   * Transforms the vertices in [firstVertex, endVertex) into
+   * clip space once, and then clips and sets up each triangle
+   * referring to them.
+   */
+  static void setupTriangles(const OccluderGeometry& geometry, const Matrix4f& matrix, float width, float height, std::vector<Vec4f>& clipVertices, std::vector<OcclusionTriangle>& triangles) {
+    clipVertices.resize(geometry.endVertex - geometry.firstVertex);
+
+    for (u32 i = geometry.firstVertex; i < geometry.endVertex; i++) {
+      clipVertices[i - geometry.firstVertex] = matrix * geometry.vertices[i].position;
+    }
+
+    auto* elements = geometry.elements;
+
+    for (u32 i = 0; i + 2 < geometry.totalElements; i += 3) {
+      clipTriangle(
+        clipVertices[elements[i] - geometry.firstVertex],
+        clipVertices[elements[i + 1] - geometry.firstVertex],
+        clipVertices[elements[i + 2] - geometry.firstVertex],
+        width,
+        height,
+        triangles
+      );
+    }
+  }
+
+  /**
+   * Determines the range of vertices referred to by a set
+   * of face elements.
+   */
+  static OccluderGeometry getOccluderGeometry(const Vertex* vertices, const u32* elements, u32 totalElements) {
+    OccluderGeometry geometry;
+
+    geometry.vertices = vertices;
+    geometry.elements = elements;
+    geometry.totalElements = totalElements - totalElements % 3;
+    geometry.firstVertex = 0xFFFFFFFF;
+    geometry.endVertex = 0;
+
+    for (u32 i = 0; i < geometry.totalElements; i++) {
+      geometry.firstVertex = std::min(geometry.firstVertex, elements[i]);
+      geometry.endVertex = std::max(geometry.endVertex, elements[i] + 1);
+    }
+
+    if (geometry.totalElements == 0) {
+      geometry.firstVertex = 0;
+    }
+
+    return geometry;
+  }
+
+  /**
+   * Returns the coverage mask of a triangle within the tile
+   * at a given pixel offset, one bit per covered pixel center.
+   */
+  static u32 getTileCoverageScalar(const OcclusionTriangle& triangle, u32 tileX, u32 tileY) {
+    u32 mask = 0;
+
+    for (u32 row = 0; row < TILE_HEIGHT; row++) {
+      float py = (float)(tileY + row) + 0.5f;
+
+      for (u32 column = 0; column < TILE_WIDTH; column++) {
+        float px = (float)(tileX + column) + 0.5f;
+        bool isInside = true;
+
+        for (u32 i = 0; i < 3; i++) {
+          float edge = (triangle.edgeA[i] * px + triangle.edgeB[i] * py) + triangle.edgeC[i];
+
+          isInside &= edge >= 0.0f;
+        }
+
+        if (isInside) {
+          mask |= 1U << (row * TILE_WIDTH + column);
+        }
+      }
+    }
+
+    return mask;
+  }
+
+  #if GAMMA_SIMD_X86
+    /**
+     * Evaluates the edge functions of a triangle over a tile
+     * four pixels at a time.
+     */
+    static u32 getTileCoverageSse(const OcclusionTriangle& triangle, u32 tileX, u32 tileY) {
+      __m128 pxLeft = _mm_add_ps(_mm_set1_ps((float)tileX + 0.5f), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+      __m128 pxRight = _mm_add_ps(pxLeft, _mm_set1_ps(4.0f));
+      __m128 zero = _mm_setzero_ps();
+      u32 mask = 0;
+
+      for (u32 row = 0; row < TILE_HEIGHT; row++) {
+        __m128 py = _mm_set1_ps((float)(tileY + row) + 0.5f);
+        __m128 insideLeft = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        __m128 insideRight = insideLeft;
+
+        for (u32 i = 0; i < 3; i++) {
+          __m128 a = _mm_set1_ps(triangle.edgeA[i]);
+          __m128 b = _mm_set1_ps(triangle.edgeB[i]);
+          __m128 c = _mm_set1_ps(triangle.edgeC[i]);
+          __m128 by = _mm_mul_ps(b, py);
+          __m128 edgeLeft = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, pxLeft), by), c);
+          __m128 edgeRight = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, pxRight), by), c);
+
+          insideLeft = _mm_and_ps(insideLeft, _mm_cmpge_ps(edgeLeft, zero));
+          insideRight = _mm_and_ps(insideRight, _mm_cmpge_ps(edgeRight, zero));
+        }
+
+        u32 rowMask = (u32)_mm_movemask_ps(insideLeft) | ((u32)_mm_movemask_ps(insideRight) << 4);
+
+        mask |= rowMask << (row * TILE_WIDTH);
+      }
+
+      return mask;
+    }
+  #endif
+
+  inline static u32 getTileCoverage(const OcclusionTriangle& triangle, u32 tileX, u32 tileY) {
+    #if GAMMA_SIMD_X86
+      if (Gm_GetSimdLevel() >= SimdLevel::SSE) {
+        return getTileCoverageSse(triangle, tileX, tileY);
+      }
+    #endif
+
+    return getTileCoverageScalar(triangle, tileX, tileY);
+  }
+
+  /**
+   * OcclusionBuffer
+   * ---------------
+   */
+
+  /**
+   * Clips and sets up the triangles of each of a mesh's objects
+   * which are inside the view frustum, for the next rasterize().
+   * Meshes with LODs only have their last LOD rasterized.
+   */
+  void OcclusionBuffer::addOccluder(const Mesh& mesh) {
+    auto& pool = mesh.objects;
+    auto& bounds = pool.getBounds();
+    u32 totalObjects = pool.totalActive();
+    u32 elementOffset = 0;
+    u32 elementCount = (u32)mesh.faceElements.size();
+
+    if (totalObjects == 0 || elementCount == 0 || tiles.size() == 0) {
+      return;
+    }
+
+    if (mesh.lods.size() > 0) {
+      elementOffset = mesh.lods.back().elementOffset;
+      elementCount = mesh.lods.back().elementCount;
+    }
+
+    u32 totalLists = (totalObjects + OCCLUDER_BATCH_SIZE - 1) / OCCLUDER_BATCH_SIZE;
+    u32 firstList = totalTriangleLists;
+
+    for (u32 i = 0; i < totalLists; i++) {
+      allocateTriangleList();
+    }
+
+    auto geometry = getOccluderGeometry(mesh.vertices.data(), mesh.faceElements.data() + elementOffset, elementCount);
+
+    Gm_ParallelFor(0, totalObjects, OCCLUDER_BATCH_SIZE, [&](u32 start, u32 end) {
+      auto& triangles = triangleLists[firstList + start / OCCLUDER_BATCH_SIZE];
+      std::vector<Vec4f> clipVertices;
+
+      for (u32 i = start; i < end; i++) {
+        Vec3f center(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]);
+
+        if (!frustum.isSphereVisible(center, bounds.radius[i])) {
+          continue;
+        }
+
+        Matrix4f matrix = viewProjection * getModelMatrix(pool, i);
+
+        setupTriangles(geometry, matrix, (float)width, (float)height, clipVertices, triangles);
+      }
+    });
+  }
+
+  /**
+   * Clips and sets up a single set of occluder triangles,
+   * transformed into world space by a (row-major) matrix,
+   * for the next rasterize().
+   */
+  void OcclusionBuffer::addTriangles(const Vertex* vertices, const u32* elements, u32 totalElements, const Matrix4f& matrix) {
+    if (tiles.size() == 0) {
+      return;
+    }
+
+    auto geometry = getOccluderGeometry(vertices, elements, totalElements);
+    std::vector<Vec4f> clipVertices;
+
+    setupTriangles(geometry, viewProjection * matrix, (float)width, (float)height, clipVertices, allocateTriangleList());
+  }
+
+  std::vector<OcclusionTriangle>& OcclusionBuffer::allocateTriangleList() {
+    if (totalTriangleLists == triangleLists.size()) {
+      triangleLists.emplace_back();
+    }
+
+    auto& triangles = triangleLists[totalTriangleLists++];
+
+    triangles.clear();
+
+    return triangles;
+  }
+
+  /**
+   * Resets every tile to an infinitely distant depth, and
+   * discards any triangles which haven't been rasterized.
+   */
+  void OcclusionBuffer::clear() {
+    std::fill(tiles.begin(), tiles.end(), OcclusionTile());
+
+    totalTriangleLists = 0;
+  }
+
+  u32 OcclusionBuffer::getHeight() const {
+    return height;
+  }
+
+  /**
+   * Returns the buffer's tiles, in rows of getWidth() / 8.
+   */
+  const OcclusionTile* OcclusionBuffer::getTiles() const {
+    return tiles.data();
+  }
+
+  u32 OcclusionBuffer::getWidth() const {
+    return width;
+  }
+
+  /**
+   * Determines whether a model space bounding box, transformed
+   * into world space by a (row-major) matrix, may be visible.
+   * Boxes are hidden if their nearest depth is behind every
+   * tile they overlap on the screen.
+   */
+  bool OcclusionBuffer::isBoxVisible(const Bounds& bounds, const Matrix4f& matrix) const {
+    if (tiles.size() == 0) {
+      return true;
+    }
+
+    Matrix4f boxMatrix = viewProjection * matrix;
+    float minX = (float)width;
+    float minY = (float)height;
+    float maxX = 0.0f;
+    float maxY = 0.0f;
+    float maxDepth = 0.0f;
+
+    for (u32 i = 0; i < 8; i++) {
+      Vec3f corner(
+        i & 1 ? bounds.max.x : bounds.min.x,
+        i & 2 ? bounds.max.y : bounds.min.y,
+        i & 4 ? bounds.max.z : bounds.min.z
+      );
+
+      Vec4f clipCorner = boxMatrix * corner;
+
+      // Boxes crossing the near plane are always visible
+      if (clipCorner.z + clipCorner.w <= 0.0f) {
+        return true;
+      }
+
+      float inverseW = 1.0f / clipCorner.w;
+      float x = (clipCorner.x * inverseW * 0.5f + 0.5f) * width;
+      float y = (clipCorner.y * inverseW * 0.5f + 0.5f) * height;
+
+      minX = std::min(minX, x);
+      minY = std::min(minY, y);
+      maxX = std::max(maxX, x);
+      maxY = std::max(maxY, y);
+      maxDepth = std::max(maxDepth, inverseW);
+    }
+
+    if (minX >= (float)width || minY >= (float)height || maxX < 0.0f || maxY < 0.0f) {
+      return false;
+    }
+
+    u32 tileX1 = (u32)std::max(0.0f, minX) / TILE_WIDTH;
+    u32 tileY1 = (u32)std::max(0.0f, minY) / TILE_HEIGHT;
+    u32 tileX2 = std::min((u32)maxX / TILE_WIDTH, totalTileColumns - 1);
+    u32 tileY2 = std::min((u32)maxY / TILE_HEIGHT, totalTileRows - 1);
+
+    for (u32 tileY = tileY1; tileY <= tileY2; tileY++) {
+      auto* row = &tiles[tileY * totalTileColumns];
+
+      for (u32 tileX = tileX1; tileX <= tileX2; tileX++) {
+        if (maxDepth >= row[tileX].referenceDepth) {
+          return true;
+        }
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * Tests the bounding boxes of a mesh's visible objects against
+   * the rasterized occluders, and partitions the objects found
+   * to be hidden behind them out of the visible range.
+   */
+  void OcclusionBuffer::partitionByOcclusion(Mesh& mesh) {
+    auto& pool = mesh.objects;
+    u32 totalVisible = pool.totalVisible();
+
+    if (totalVisible == 0 || tiles.size() == 0) {
+      return;
+    }
+
+    visibilityMasks.assign(Gm_GetVisibilityMaskSize(pool.totalActive()), 0);
+
+    auto* masks = visibilityMasks.data();
+
+    Gm_ParallelFor(0, totalVisible, OCCLUDEE_BATCH_SIZE, [&](u32 start, u32 end) {
+      for (u32 i = start; i < end; i++) {
+        if (isBoxVisible(mesh.bounds, getModelMatrix(pool, i))) {
+          masks[i >> 5] |= 1U << (i & 31);
+        }
+      }
+    });
+
+    pool.partitionByVisibility(masks);
+  }
+
+  /**
+   * Rasterizes every triangle added since the last rasterize(),
+   * with each job taking its own rows of tiles.
+   */
+  void OcclusionBuffer::rasterize() {
+    Gm_ParallelFor(0, totalTileRows, 1, [&](u32 start, u32 end) {
+      for (u32 tileRow = start; tileRow < end; tileRow++) {
+        s32 top = tileRow * TILE_HEIGHT;
+        s32 bottom = top + TILE_HEIGHT - 1;
+
+        for (u32 i = 0; i < totalTriangleLists; i++) {
+          for (auto& triangle : triangleLists[i]) {
+            if (triangle.minY <= bottom && triangle.maxY >= top) {
+              rasterizeTriangle(triangle, tileRow);
+            }
+          }
+        }
+      }
+    });
+
+    totalTriangleLists = 0;
+  }
+
+  /**
+   * Rasterizes a triangle into a row of tiles, updating each
+   * covered tile's layers with the farthest depth the triangle
+   * could have within the tile.
+   */
+  void OcclusionBuffer::rasterizeTriangle(const OcclusionTriangle& triangle, u32 tileRow) {
+    u32 tileY = tileRow * TILE_HEIGHT;
+    float y1 = (float)std::max(triangle.minY, (s32)tileY) + 0.5f;
+    float y2 = (float)std::min(triangle.maxY, (s32)(tileY + TILE_HEIGHT - 1)) + 0.5f;
+    auto* row = &tiles[tileRow * totalTileColumns];
+
+    for (u32 tileColumn = triangle.minX / TILE_WIDTH; tileColumn <= triangle.maxX / TILE_WIDTH; tileColumn++) {
+      u32 tileX = tileColumn * TILE_WIDTH;
+      u32 mask = getTileCoverage(triangle, tileX, tileY);
+
+      if (mask == 0) {
+        continue;
+      }
+
+      // Depth planes are linear, so the farthest depth over the
+      // covered part of the tile is at one of its corners
+      float x1 = (float)std::max(triangle.minX, (s32)tileX) + 0.5f;
+      float x2 = (float)std::min(triangle.maxX, (s32)(tileX + TILE_WIDTH - 1)) + 0.5f;
+      float depthX1 = triangle.depthA * x1 + triangle.depthC;
+      float depthX2 = triangle.depthA * x2 + triangle.depthC;
+      float depthY1 = triangle.depthB * y1;
+      float depthY2 = triangle.depthB * y2;
+
+      float depth = std::max(triangle.minDepth, std::min({
+        depthX1 + depthY1,
+        depthX2 + depthY1,
+        depthX1 + depthY2,
+        depthX2 + depthY2
+      }));
+
+      auto& tile = row[tileColumn];
+
+      if (depth <= tile.referenceDepth) {
+        continue;
+      }
+
+      if (mask == FULL_TILE_MASK) {
+        tile.referenceDepth = depth;
+
+        if (tile.workingMask != 0 && tile.workingDepth <= depth) {
+          tile.workingMask = 0;
+        }
+
+        continue;
+      }
+
+      if (tile.workingMask == 0) {
+        tile.workingDepth = depth;
+        tile.workingMask = mask;
+      } else {
+        // Rather than merging a triangle far behind the working
+        // layer, and pushing the whole layer back to its depth,
+        // discard the working layer and start a new one
+        float distanceToTriangle = tile.workingDepth - depth;
+        float distanceToReference = tile.workingDepth - tile.referenceDepth;
+
+        if (distanceToTriangle > distanceToReference) {
+          tile.workingDepth = depth;
+          tile.workingMask = mask;
+        } else {
+          tile.workingDepth = std::min(tile.workingDepth, depth);
+          tile.workingMask |= mask;
+        }
+      }
+
+      if (tile.workingMask == FULL_TILE_MASK) {
+        tile.referenceDepth = tile.workingDepth;
+        tile.workingMask = 0;
+      }
+    }
+  }
+
+  /**
+   * Resizes the buffer, rounding its dimensions up to whole
+   * tiles, and clears it.
+   */
+  void OcclusionBuffer::resize(u32 minWidth, u32 minHeight) {
+    totalTileColumns = (minWidth + TILE_WIDTH - 1) / TILE_WIDTH;
+    totalTileRows = (minHeight + TILE_HEIGHT - 1) / TILE_HEIGHT;
+
+    width = totalTileColumns * TILE_WIDTH;
+    height = totalTileRows * TILE_HEIGHT;
+
+    tiles.resize(totalTileColumns * totalTileRows);
+
+    clear();
+  }
+
+  /**
+   * Sets the (row-major) matrix transforming world space
+   * positions into clip space, for occluders and tested
+   * bounding boxes alike.
+   */
+  void OcclusionBuffer::setViewProjection(const Matrix4f& matrix) {
+    viewProjection = matrix;
+    frustum = Frustum::fromMatrix(matrix);
+  }
+
+  u32 OcclusionBuffer::totalPendingTriangles() const {
+    u32 total = 0;
+
+    for (u32 i = 0; i < totalTriangleLists; i++) {
+      total += (u32)triangleLists[i].size();
+    }
+
+    return total;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vector>
+
+#include "math/frustum.h"
+#include "math/geometry.h"
+#include "math/matrix.h"
+#include "system/entities.h"
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * OcclusionTile
+   * -------------
+   *
+   * An 8x4 pixel tile of an OcclusionBuffer. Depths are stored
+   * as 1/w, so larger depths are nearer to the camera.
+   *
+   * Every pixel in the tile is covered by occluders at least
+   * as near as the reference depth. Occluders which only cover
+   * part of the tile are merged into a working layer, with a
+   * coverage mask and the farthest depth of those occluders;
+   * once the working layer covers the whole tile, it replaces
+   * the reference layer.
+   */
+  struct OcclusionTile {
+    float referenceDepth = 0.0f;
+    float workingDepth = 0.0f;
+    u32 workingMask = 0;
+  };
+
+  /**
+   * OcclusionTriangle
+   * -----------------
+   *
+   * A screen space occluder triangle, set up for rasterization.
+   * Pixels are covered where all three edge functions are
+   * non-negative, and triangle depths are interpolated across
+   * the screen with a depth plane.
+   */
+  struct OcclusionTriangle {
+    float edgeA[3];
+    float edgeB[3];
+    float edgeC[3];
+    float depthA;
+    float depthB;
+    float depthC;
+    float minDepth;
+    s32 minX;
+    s32 minY;
+    s32 maxX;
+    s32 maxY;
+  };
+
+  /**
+   * OcclusionBuffer
+   * ---------------
+   *
+   * A small, CPU-side masked depth buffer for occlusion culling.
+   * Occluder meshes are added with addOccluder(), which clips
+   * and sets up their triangles across worker threads, and are
+   * then rasterized into the buffer's tiles with rasterize(),
+   * with each worker thread taking its own rows of tiles.
+   *
+   * Once rasterized, partitionByOcclusion() tests the bounding
+   * boxes of a mesh's visible objects against the tiles they
+   * overlap, and moves objects found to be hidden behind the
+   * occluders out of the visible range.
+   *
+   * The buffer doesn't depend on a renderer, so it can be used
+   * and inspected without a graphics context.
+   */
+  class OcclusionBuffer {
+  public:
+    void addOccluder(const Mesh& mesh);
+    void addTriangles(const Vertex* vertices, const u32* elements, u32 totalElements, const Matrix4f& matrix);
+    void clear();
+    u32 getHeight() const;
+    const OcclusionTile* getTiles() const;
+    u32 getWidth() const;
+    bool isBoxVisible(const Bounds& bounds, const Matrix4f& matrix) const;
+    void partitionByOcclusion(Mesh& mesh);
+    void rasterize();
+    void resize(u32 minWidth, u32 minHeight);
+    void setViewProjection(const Matrix4f& matrix);
+    u32 totalPendingTriangles() const;
+
+  private:
+    std::vector<OcclusionTile> tiles;
+    /**
+     * Triangles set up since the last rasterize(), in separate
+     * lists per setup job so jobs never share an output list.
+     * Lists are reused between frames.
+     */
+    std::vector<std::vector<OcclusionTriangle>> triangleLists;
+    /**
+     * Visibility bits for the objects of the mesh being
+     * tested in partitionByOcclusion().
+     */
+    std::vector<u32> visibilityMasks;
+    Matrix4f viewProjection = Matrix4f::identity();
+    /**
+     * The frustum of the view-projection matrix, used to skip
+     * occluder objects before setting up their triangles.
+     */
+    Frustum frustum;
+    u32 width = 0;
+    u32 height = 0;
+    u32 totalTileColumns = 0;
+    u32 totalTileRows = 0;
+    u32 totalTriangleLists = 0;
+
+    std::vector<OcclusionTriangle>& allocateTriangleList();
+    void rasterizeTriangle(const OcclusionTriangle& triangle, u32 tileRow);
+  };
+}
\ No newline at end of file
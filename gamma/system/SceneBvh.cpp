@@ -0,0 +1,1072 @@
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+
+#include "math/batch_culling.h"
+#include "system/SceneBvh.h"
+
+namespace Gamma {
+  /**
+   * Marks node object entries whose objects have been removed.
+   */
+  constexpr static u32 INVALID_SLOT = 0xFFFFFFFF;
+
+  /**
+   * Marks objects which haven't been built into the tree yet,
+   * and the (nonexistent) parent of the root node.
+   */
+  constexpr static u32 PENDING_NODE = 0xFFFFFFFF;
+
+  /**
+   * Marks object slots which are not in use.
+   */
+  constexpr static u32 FREE_NODE = 0xFFFFFFFE;
+
+  /**
+   * The number of objects below which leaf nodes are not
+   * split, and the number above which they always are.
+   */
+  constexpr static u32 MIN_SPLIT_OBJECTS = 4;
+  constexpr static u32 MAX_LEAF_OBJECTS = 16;
+
+  /**
+   * The number of centroid bins evaluated per axis when
+   * choosing where to split a node.
+   */
+  constexpr static u32 TOTAL_SAH_BINS = 12;
+
+  /**
+   * The cost of traversing a node, relative to testing
+   * a single object bounding sphere.
+   */
+  constexpr static float TRAVERSAL_COST = 1.0f;
+
+  /**
+   * Rebuild thresholds. Trees are rebuilt once the number of
+   * objects added or removed since the last build exceeds
+   * 1/REBUILD_CHANGE_DIVISOR of the built objects, or once
+   * refitting has increased the SAH cost of the tree by
+   * MAX_COST_RATIO over its cost when built.
+   */
+  constexpr static u32 MIN_REBUILD_CHANGES = 64;
+  constexpr static u32 REBUILD_CHANGE_DIVISOR = 8;
+  constexpr static float MAX_COST_RATIO = 1.5f;
+
+  struct BvhBuildItem {
+    u32 slot;
+    Vec3f min;
+    Vec3f max;
+    Vec3f centroid;
+  };
+
+  struct BvhBin {
+    Vec3f min = Vec3f(FLT_MAX);
+    Vec3f max = Vec3f(-FLT_MAX);
+    u32 count = 0;
+  };
+
+  inline static float getAxis(const Vec3f& vector, u32 axis) {
+    return axis == 0 ? vector.x : axis == 1 ? vector.y : vector.z;
+  }
+
+  inline static void expand(Vec3f& min, Vec3f& max, const Vec3f& pointMin, const Vec3f& pointMax) {
+    min.x = std::min(min.x, pointMin.x);
+    min.y = std::min(min.y, pointMin.y);
+    min.z = std::min(min.z, pointMin.z);
+    max.x = std::max(max.x, pointMax.x);
+    max.y = std::max(max.y, pointMax.y);
+    max.z = std::max(max.z, pointMax.z);
+  }
+
+  /**
+   * Returns the surface area of a box, or 0 for empty boxes.
+   */
+  inline static float getSurfaceArea(const Vec3f& min, const Vec3f& max) {
+    Vec3f size = max - min;
+
+    if (size.x < 0.0f || size.y < 0.0f || size.z < 0.0f) {
+      return 0.0f;
+    }
+
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+  }
+
+  inline static bool isBoxOverlapping(const BvhNode& node, const Vec3f& min, const Vec3f& max) {
+    return (
+      node.min.x <= max.x && node.max.x >= min.x &&
+      node.min.y <= max.y && node.max.y >= min.y &&
+      node.min.z <= max.z && node.max.z >= min.z
+    );
+  }
+
+  /**
+   * Returns the distance along a ray at which it enters a node,
+   * or FLT_MAX if it misses. Empty nodes (min > max) are never
+   * entered, since their exit distance precedes their entry.
+   */
+  inline static float getRayEntryDistance(const BvhNode& node, const Vec3f& origin, const Vec3f& inverseDirection, float maxDistance) {
+    float entry = 0.0f;
+    float exit = maxDistance;
+
+    for (u32 axis = 0; axis < 3; axis++) {
+      float inverse = getAxis(inverseDirection, axis);
+      float start = getAxis(origin, axis);
+      float t1 = (getAxis(node.min, axis) - start) * inverse;
+      float t2 = (getAxis(node.max, axis) - start) * inverse;
+
+      if (inverse < 0.0f) {
+        std::swap(t1, t2);
+      }
+
+      entry = std::max(entry, t1);
+      exit = std::min(exit, t2);
+    }
+
+    return entry <= exit ? entry : FLT_MAX;
+  }
+
+  /**
+   * Computes the SAH cost of a tree, relative to the surface
+   * area of its root node.
+   */
+  static float computeCost(const std::vector<BvhNode>& nodes) {
+    if (nodes.size() == 0) {
+      return 0.0f;
+    }
+
+    float rootArea = getSurfaceArea(nodes[0].min, nodes[0].max);
+    float cost = 0.0f;
+
+    if (rootArea == 0.0f) {
+      return 0.0f;
+    }
+
+    for (auto& node : nodes) {
+      float area = getSurfaceArea(node.min, node.max);
+
+      if (node.count == 0) {
+        cost += area * TRAVERSAL_COST;
+      } else {
+        cost += area * node.count;
+      }
+    }
+
+    return cost / rootArea;
+  }
+
+  static std::vector<BvhBuildItem> createBuildItems(const std::vector<BvhObject>& objects) {
+    std::vector<BvhBuildItem> items;
+
+    for (u32 slot = 0; slot < objects.size(); slot++) {
+      auto& object = objects[slot];
+
+      if (object.node == FREE_NODE) {
+        continue;
+      }
+
+      BvhBuildItem item;
+
+      item.slot = slot;
+      item.min = object.center - Vec3f(object.radius);
+      item.max = object.center + Vec3f(object.radius);
+      item.centroid = object.center;
+
+      items.push_back(item);
+    }
+
+    return items;
+  }
+
+  /**
+   * Builds a tree over a set of items, splitting nodes at the
+   * best of TOTAL_SAH_BINS centroid bins along each axis.
+   * Children are always created after their parents, so nodes
+   * can be refitted bottom-up by iterating them in reverse.
+   */
+  static BvhBuild buildBvh(std::vector<BvhBuildItem>& items) {
+    BvhBuild build;
+
+    if (items.size() == 0) {
+      return build;
+    }
+
+    BvhNode root;
+
+    root.first = 0;
+    root.count = (u32)items.size();
+
+    build.nodes.reserve(items.size() / 2 + 1);
+    build.nodes.push_back(root);
+    build.parents.push_back(PENDING_NODE);
+
+    std::vector<u32> stack = { 0 };
+
+    while (stack.size() > 0) {
+      u32 index = stack.back();
+      u32 first = build.nodes[index].first;
+      u32 count = build.nodes[index].count;
+      u32 end = first + count;
+
+      stack.pop_back();
+
+      Vec3f min(FLT_MAX);
+      Vec3f max(-FLT_MAX);
+      Vec3f centroidMin(FLT_MAX);
+      Vec3f centroidMax(-FLT_MAX);
+
+      for (u32 i = first; i < end; i++) {
+        expand(min, max, items[i].min, items[i].max);
+        expand(centroidMin, centroidMax, items[i].centroid, items[i].centroid);
+      }
+
+      build.nodes[index].min = min;
+      build.nodes[index].max = max;
+
+      if (count <= MIN_SPLIT_OBJECTS) {
+        continue;
+      }
+
+      // Find the cheapest split
+      float bestCost = FLT_MAX;
+      u32 bestAxis = 0;
+      u32 bestBin = 0;
+
+      for (u32 axis = 0; axis < 3; axis++) {
+        float low = getAxis(centroidMin, axis);
+        float extent = getAxis(centroidMax, axis) - low;
+
+        if (extent <= 0.0f) {
+          continue;
+        }
+
+        BvhBin bins[TOTAL_SAH_BINS];
+        float binScale = (float)TOTAL_SAH_BINS / extent;
+
+        for (u32 i = first; i < end; i++) {
+          u32 bin = std::min((u32)((getAxis(items[i].centroid, axis) - low) * binScale), TOTAL_SAH_BINS - 1);
+
+          expand(bins[bin].min, bins[bin].max, items[i].min, items[i].max);
+
+          bins[bin].count++;
+        }
+
+        // Sweep from the right to accumulate the cost of the
+        // right side of each split, then from the left
+        float rightCosts[TOTAL_SAH_BINS];
+        Vec3f rightMin(FLT_MAX);
+        Vec3f rightMax(-FLT_MAX);
+        u32 rightCount = 0;
+
+        for (u32 bin = TOTAL_SAH_BINS - 1; bin > 0; bin--) {
+          expand(rightMin, rightMax, bins[bin].min, bins[bin].max);
+
+          rightCount += bins[bin].count;
+          rightCosts[bin] = getSurfaceArea(rightMin, rightMax) * rightCount;
+        }
+
+        Vec3f leftMin(FLT_MAX);
+        Vec3f leftMax(-FLT_MAX);
+        u32 leftCount = 0;
+
+        for (u32 bin = 1; bin < TOTAL_SAH_BINS; bin++) {
+          expand(leftMin, leftMax, bins[bin - 1].min, bins[bin - 1].max);
+
+          leftCount += bins[bin - 1].count;
+
+          if (leftCount == 0 || leftCount == count) {
+            continue;
+          }
+
+          float cost = getSurfaceArea(leftMin, leftMax) * leftCount + rightCosts[bin];
+
+          if (cost < bestCost) {
+            bestCost = cost;
+            bestAxis = axis;
+            bestBin = bin;
+          }
+        }
+      }
+
+      float area = getSurfaceArea(min, max);
+      float leafCost = area * count;
+      float splitCost = area * TRAVERSAL_COST + bestCost;
+      u32 middle;
+
+      if (bestCost == FLT_MAX) {
+        // All centroids are in the same place
+        if (count <= MAX_LEAF_OBJECTS) {
+          continue;
+        }
+
+        middle = first + count / 2;
+      } else {
+        if (splitCost >= leafCost && count <= MAX_LEAF_OBJECTS) {
+          continue;
+        }
+
+        float low = getAxis(centroidMin, bestAxis);
+        float binScale = (float)TOTAL_SAH_BINS / (getAxis(centroidMax, bestAxis) - low);
+
+        auto* split = std::partition(&items[first], &items[first] + count, [&](const BvhBuildItem& item) {
+          return std::min((u32)((getAxis(item.centroid, bestAxis) - low) * binScale), TOTAL_SAH_BINS - 1) < bestBin;
+        });
+
+        middle = (u32)(split - &items[0]);
+      }
+
+      u32 left = (u32)build.nodes.size();
+      BvhNode leftNode;
+      BvhNode rightNode;
+
+      leftNode.first = first;
+      leftNode.count = middle - first;
+      rightNode.first = middle;
+      rightNode.count = end - middle;
+
+      build.nodes.push_back(leftNode);
+      build.nodes.push_back(rightNode);
+      build.parents.push_back(index);
+      build.parents.push_back(index);
+
+      build.nodes[index].first = left;
+      build.nodes[index].count = 0;
+
+      stack.push_back(left);
+      stack.push_back(left + 1);
+    }
+
+    build.nodeObjects.resize(items.size());
+
+    for (u32 i = 0; i < items.size(); i++) {
+      build.nodeObjects[i] = items[i].slot;
+    }
+
+    build.cost = computeCost(build.nodes);
+
+    return build;
+  }
+
+  /**
+   * SceneBvh
+   * --------
+   */
+  u32 SceneBvh::allocateSlot(const ObjectRecord& record) {
+    u32 slot;
+
+    if (freeSlots.size() > 0) {
+      slot = freeSlots.back();
+
+      freeSlots.pop_back();
+    } else {
+      slot = (u32)objects.size();
+
+      objects.push_back(BvhObject());
+    }
+
+    if (slotsByMesh.size() <= record.meshIndex) {
+      slotsByMesh.resize(record.meshIndex + 1);
+    }
+
+    auto& meshSlots = slotsByMesh[record.meshIndex];
+
+    if (meshSlots.size() <= record.id) {
+      meshSlots.resize(record.id + 1, 0);
+    }
+
+    meshSlots[record.id] = slot + 1;
+
+    auto& object = objects[slot];
+
+    object.record = record;
+    object.node = PENDING_NODE;
+    object.pendingIndex = (u32)pendingObjects.size();
+
+    pendingObjects.push_back(slot);
+
+    totalActiveObjects++;
+
+    return slot;
+  }
+
+  u32 SceneBvh::findSlot(const ObjectRecord& record) const {
+    if (record.meshIndex >= slotsByMesh.size()) {
+      return INVALID_SLOT;
+    }
+
+    auto& meshSlots = slotsByMesh[record.meshIndex];
+
+    if (record.id >= meshSlots.size() || meshSlots[record.id] == 0) {
+      return INVALID_SLOT;
+    }
+
+    return meshSlots[record.id] - 1;
+  }
+
+  void SceneBvh::freeSlot(u32 slot) {
+    auto& object = objects[slot];
+
+    if (object.node == PENDING_NODE) {
+      u32 lastSlot = pendingObjects.back();
+
+      pendingObjects[object.pendingIndex] = lastSlot;
+      objects[lastSlot].pendingIndex = object.pendingIndex;
+
+      pendingObjects.pop_back();
+    } else {
+      auto& node = nodes[object.node];
+
+      for (u32 i = node.first; i < node.first + node.count; i++) {
+        if (nodeObjects[i] == slot) {
+          nodeObjects[i] = INVALID_SLOT;
+        }
+      }
+
+      markDirty(object.node);
+
+      totalRemovedSinceBuild++;
+    }
+
+    slotsByMesh[object.record.meshIndex][object.record.id] = 0;
+
+    object.node = FREE_NODE;
+
+    if (rebuildTask.valid()) {
+      deferredFreeSlots.push_back(slot);
+    } else {
+      freeSlots.push_back(slot);
+    }
+
+    totalActiveObjects--;
+  }
+
+  /**
+   * Returns the SAH cost of the tree as of its last full
+   * refit, relative to the surface area of its root node.
+   */
+  float SceneBvh::getCost() const {
+    return currentCost;
+  }
+
+  /**
+   * Swaps in a newly built tree. Objects removed while the
+   * tree was being built are dropped from it, and objects
+   * added in the meantime are left pending. Since objects may
+   * have moved during the build, the tree is then refitted.
+   */
+  void SceneBvh::installBuild(BvhBuild& build) {
+    nodes = std::move(build.nodes);
+    parents = std::move(build.parents);
+    nodeObjects = std::move(build.nodeObjects);
+    builtCost = build.cost;
+    totalRemovedSinceBuild = 0;
+
+    for (auto& object : objects) {
+      if (object.node != FREE_NODE) {
+        object.node = PENDING_NODE;
+      }
+    }
+
+    for (u32 index = 0; index < nodes.size(); index++) {
+      auto& node = nodes[index];
+
+      for (u32 i = node.first; i < node.first + node.count; i++) {
+        u32 slot = nodeObjects[i];
+
+        if (objects[slot].node == FREE_NODE) {
+          nodeObjects[i] = INVALID_SLOT;
+
+          totalRemovedSinceBuild++;
+        } else {
+          objects[slot].node = index;
+        }
+      }
+    }
+
+    pendingObjects.clear();
+
+    for (u32 slot = 0; slot < objects.size(); slot++) {
+      if (objects[slot].node == PENDING_NODE) {
+        objects[slot].pendingIndex = (u32)pendingObjects.size();
+
+        pendingObjects.push_back(slot);
+      }
+    }
+
+    freeSlots.insert(freeSlots.end(), deferredFreeSlots.begin(), deferredFreeSlots.end());
+    deferredFreeSlots.clear();
+
+    dirtyNodes.clear();
+    dirtyNodeFlags.assign(nodes.size(), false);
+
+    refitAll();
+  }
+
+  void SceneBvh::markDirty(u32 node) {
+    if (!dirtyNodeFlags[node]) {
+      dirtyNodeFlags[node] = true;
+
+      dirtyNodes.push_back(node);
+    }
+  }
+
+  /**
+   * Culls the objects of a set of meshes against a frustum,
+   * moving visible objects to the front of their ObjectPools.
+   * Subtrees entirely inside or outside of the frustum are
+   * accepted or rejected without testing their objects.
+   *
+   * Particle systems are left as they are, since they are
+   * positioned on the GPU rather than committed.
+   */
+  void SceneBvh::partitionByVisibility(const Frustum& frustum, const std::vector<Mesh*>& meshes) {
+    visibilityMasks.resize(meshes.size());
+    staleRecords.clear();
+
+    for (u32 i = 0; i < meshes.size(); i++) {
+      visibilityMasks[i].assign(Gm_GetVisibilityMaskSize(meshes[i]->objects.totalActive()), 0);
+    }
+
+    visitFrustum(frustum, [&](const BvhObject& object) {
+      auto& record = object.record;
+
+      if (record.meshIndex >= meshes.size()) {
+        staleRecords.push_back(record);
+
+        return;
+      }
+
+      auto& pool = meshes[record.meshIndex]->objects;
+      auto* pooledObject = pool.getByRecord(record);
+
+      if (pooledObject == nullptr) {
+        staleRecords.push_back(record);
+
+        return;
+      }
+
+      u32 index = pool.indexOf(*pooledObject);
+
+      visibilityMasks[record.meshIndex][index >> 5] |= 1U << (index & 31);
+    });
+
+    for (auto& record : staleRecords) {
+      removeRecord(record);
+    }
+
+    for (u32 i = 0; i < meshes.size(); i++) {
+      auto* mesh = meshes[i];
+
+      if (mesh->type == MeshType::PARTICLE_SYSTEM) {
+        continue;
+      }
+
+      mesh->objects.partitionByVisibility(visibilityMasks[i].data());
+    }
+  }
+
+  /**
+   * Collects the records of objects whose bounding spheres
+   * overlap an axis-aligned box.
+   */
+  void SceneBvh::queryBox(const Vec3f& min, const Vec3f& max, std::vector<ObjectRecord>& records) const {
+    visitBox(min, max, [&](const BvhObject& object) {
+      Vec3f closest(
+        std::max(min.x, std::min(object.center.x, max.x)),
+        std::max(min.y, std::min(object.center.y, max.y)),
+        std::max(min.z, std::min(object.center.z, max.z))
+      );
+
+      Vec3f delta = object.center - closest;
+
+      if (Vec3f::dot(delta, delta) <= object.radius * object.radius) {
+        records.push_back(object.record);
+      }
+    });
+  }
+
+  /**
+   * Collects the records of objects whose bounding spheres
+   * intersect a frustum.
+   */
+  void SceneBvh::queryFrustum(const Frustum& frustum, std::vector<ObjectRecord>& records) const {
+    visitFrustum(frustum, [&](const BvhObject& object) {
+      records.push_back(object.record);
+    });
+  }
+
+  /**
+   * Collects the records of objects whose bounding spheres
+   * overlap a sphere.
+   */
+  void SceneBvh::querySphere(const Vec3f& center, float radius, std::vector<ObjectRecord>& records) const {
+    visitBox(center - Vec3f(radius), center + Vec3f(radius), [&](const BvhObject& object) {
+      Vec3f delta = object.center - center;
+      float range = radius + object.radius;
+
+      if (Vec3f::dot(delta, delta) <= range * range) {
+        records.push_back(object.record);
+      }
+    });
+  }
+
+  /**
+   * Finds the nearest object bounding sphere along a ray within
+   * a maximum distance. Rays starting inside of a sphere hit it
+   * at a distance of 0.
+   */
+  bool SceneBvh::raycast(const Vec3f& origin, const Vec3f& direction, float maxDistance, BvhRayHit& hit) const {
+    Vec3f unitDirection = direction.unit();
+    Vec3f inverseDirection(1.0f / unitDirection.x, 1.0f / unitDirection.y, 1.0f / unitDirection.z);
+    float closestDistance = maxDistance;
+    bool didHit = false;
+
+    auto testObject = [&](u32 slot) {
+      auto& object = objects[slot];
+      Vec3f toCenter = object.center - origin;
+      float projection = Vec3f::dot(toCenter, unitDirection);
+      float distanceSquared = Vec3f::dot(toCenter, toCenter) - projection * projection;
+      float radiusSquared = object.radius * object.radius;
+
+      if (distanceSquared > radiusSquared) {
+        return;
+      }
+
+      float halfChord = sqrtf(radiusSquared - distanceSquared);
+      float exit = projection + halfChord;
+
+      if (exit < 0.0f) {
+        return;
+      }
+
+      float entry = std::max(projection - halfChord, 0.0f);
+
+      if (entry <= closestDistance) {
+        closestDistance = entry;
+        hit.record = object.record;
+        hit.distance = entry;
+        didHit = true;
+      }
+    };
+
+    for (auto slot : pendingObjects) {
+      testObject(slot);
+    }
+
+    if (nodes.size() == 0) {
+      return didHit;
+    }
+
+    std::vector<u32> stack = { 0 };
+
+    while (stack.size() > 0) {
+      auto& node = nodes[stack.back()];
+
+      stack.pop_back();
+
+      if (getRayEntryDistance(node, origin, inverseDirection, closestDistance) == FLT_MAX) {
+        continue;
+      }
+
+      if (node.count > 0) {
+        for (u32 i = node.first; i < node.first + node.count; i++) {
+          if (nodeObjects[i] != INVALID_SLOT) {
+            testObject(nodeObjects[i]);
+          }
+        }
+      } else {
+        // Visit the nearer child first
+        float leftDistance = getRayEntryDistance(nodes[node.first], origin, inverseDirection, closestDistance);
+        float rightDistance = getRayEntryDistance(nodes[node.first + 1], origin, inverseDirection, closestDistance);
+
+        if (leftDistance < rightDistance) {
+          stack.push_back(node.first + 1);
+          stack.push_back(node.first);
+        } else {
+          stack.push_back(node.first);
+          stack.push_back(node.first + 1);
+        }
+      }
+    }
+
+    return didHit;
+  }
+
+  /**
+   * Builds a new tree from scratch on the calling thread.
+   */
+  void SceneBvh::rebuild() {
+    if (rebuildTask.valid()) {
+      rebuildTask.get();
+    }
+
+    auto items = createBuildItems(objects);
+    auto build = buildBvh(items);
+
+    installBuild(build);
+  }
+
+  /**
+   * Recomputes the bounds of every node from its objects or
+   * children, and the SAH cost of the resulting tree.
+   */
+  void SceneBvh::refitAll() {
+    for (u32 index = (u32)nodes.size(); index-- > 0;) {
+      auto& node = nodes[index];
+
+      if (node.count == 0) {
+        auto& left = nodes[node.first];
+        auto& right = nodes[node.first + 1];
+
+        node.min = left.min;
+        node.max = left.max;
+
+        expand(node.min, node.max, right.min, right.max);
+      } else {
+        node.min = Vec3f(FLT_MAX);
+        node.max = Vec3f(-FLT_MAX);
+
+        for (u32 i = node.first; i < node.first + node.count; i++) {
+          if (nodeObjects[i] != INVALID_SLOT) {
+            auto& object = objects[nodeObjects[i]];
+
+            expand(node.min, node.max, object.center - Vec3f(object.radius), object.center + Vec3f(object.radius));
+          }
+        }
+      }
+    }
+
+    currentCost = computeCost(nodes);
+  }
+
+  /**
+   * Refits a leaf node to its objects, and then refits its
+   * ancestors until reaching one whose bounds don't change.
+   */
+  void SceneBvh::refitNode(u32 index) {
+    auto& leaf = nodes[index];
+
+    leaf.min = Vec3f(FLT_MAX);
+    leaf.max = Vec3f(-FLT_MAX);
+
+    for (u32 i = leaf.first; i < leaf.first + leaf.count; i++) {
+      if (nodeObjects[i] != INVALID_SLOT) {
+        auto& object = objects[nodeObjects[i]];
+
+        expand(leaf.min, leaf.max, object.center - Vec3f(object.radius), object.center + Vec3f(object.radius));
+      }
+    }
+
+    u32 parent = parents[index];
+
+    while (parent != PENDING_NODE) {
+      auto& node = nodes[parent];
+      auto& left = nodes[node.first];
+      auto& right = nodes[node.first + 1];
+      Vec3f min = left.min;
+      Vec3f max = left.max;
+
+      expand(min, max, right.min, right.max);
+
+      if (min == node.min && max == node.max) {
+        break;
+      }
+
+      node.min = min;
+      node.max = max;
+      parent = parents[parent];
+    }
+  }
+
+  void SceneBvh::removeRecord(const ObjectRecord& record) {
+    u32 slot = findSlot(record);
+
+    if (slot != INVALID_SLOT && objects[slot].record.generation == record.generation) {
+      freeSlot(slot);
+    }
+  }
+
+  void SceneBvh::reset() {
+    if (rebuildTask.valid()) {
+      rebuildTask.get();
+    }
+
+    nodes.clear();
+    parents.clear();
+    nodeObjects.clear();
+    dirtyNodes.clear();
+    dirtyNodeFlags.clear();
+    objects.clear();
+    freeSlots.clear();
+    slotsByMesh.clear();
+    pendingObjects.clear();
+    deferredFreeSlots.clear();
+
+    totalActiveObjects = 0;
+    totalRemovedSinceBuild = 0;
+    builtCost = 0.0f;
+    currentCost = 0.0f;
+  }
+
+  u32 SceneBvh::totalObjects() const {
+    return totalActiveObjects;
+  }
+
+  u32 SceneBvh::totalPendingObjects() const {
+    return (u32)pendingObjects.size();
+  }
+
+  /**
+   * Refits nodes whose objects have moved, and swaps in or
+   * starts a background rebuild as needed. Should be called
+   * once per frame, before the tree is queried.
+   */
+  void SceneBvh::update() {
+    if (rebuildTask.valid() && rebuildTask.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+      auto build = rebuildTask.get();
+
+      installBuild(build);
+    }
+
+    if (dirtyNodes.size() > 0) {
+      // Refitting each dirty leaf's ancestors only pays off
+      // while relatively few leaves have changed
+      if (dirtyNodes.size() > nodes.size() / 8) {
+        refitAll();
+      } else {
+        for (auto node : dirtyNodes) {
+          refitNode(node);
+        }
+      }
+
+      for (auto node : dirtyNodes) {
+        dirtyNodeFlags[node] = false;
+      }
+
+      dirtyNodes.clear();
+    }
+
+    if (rebuildTask.valid()) {
+      return;
+    }
+
+    u32 totalBuiltObjects = totalActiveObjects - (u32)pendingObjects.size();
+    u32 totalChanges = (u32)pendingObjects.size() + totalRemovedSinceBuild;
+
+    bool hasChangedEnough = (
+      totalChanges > MIN_REBUILD_CHANGES &&
+      totalChanges > totalBuiltObjects / REBUILD_CHANGE_DIVISOR
+    );
+
+    bool hasDegradedEnough = builtCost > 0.0f && currentCost > builtCost * MAX_COST_RATIO;
+
+    if (!hasChangedEnough && !hasDegradedEnough) {
+      return;
+    }
+
+    if (nodes.size() == 0) {
+      // Nothing to query in the meantime, so build
+      // the first tree right away
+      rebuild();
+    } else {
+      rebuildTask = std::async(std::launch::async, [items = createBuildItems(objects)]() mutable {
+        return buildBvh(items);
+      });
+    }
+  }
+
+  /**
+   * Adds or moves the objects of an ObjectPool whose bounds have
+   * changed since the last call, starting to track the pool's
+   * bounds changes (and adding all of its objects) if it
+   * isn't already.
+   */
+  void SceneBvh::updateChangedObjects(ObjectPool& pool) {
+    pool.useBoundsTracking();
+
+    if (pool.takeChangedBounds(changedIds)) {
+      updateObjects(pool, 0, pool.totalActive());
+
+      return;
+    }
+
+    for (auto id : changedIds) {
+      auto* object = pool.getById(id);
+
+      if (object != nullptr) {
+        u32 index = pool.indexOf(*object);
+
+        updateObjects(pool, index, index + 1);
+      }
+    }
+  }
+
+  /**
+   * Adds or moves an object. Moved objects have their leaf
+   * nodes refitted on the next update().
+   */
+  void SceneBvh::updateObject(const ObjectRecord& record, const Vec3f& center, float radius) {
+    u32 slot = findSlot(record);
+
+    if (slot == INVALID_SLOT) {
+      slot = allocateSlot(record);
+    }
+
+    auto& object = objects[slot];
+
+    object.record = record;
+    object.center = center;
+    object.radius = radius;
+
+    if (object.node != PENDING_NODE) {
+      markDirty(object.node);
+    }
+  }
+
+  /**
+   * Adds or moves objects [start, end) of an ObjectPool, using
+   * their world space bounding spheres.
+   */
+  void SceneBvh::updateObjects(const ObjectPool& pool, u32 start, u32 end) {
+    auto& bounds = pool.getBounds();
+    auto* poolObjects = pool.begin();
+
+    end = std::min(end, pool.totalActive());
+
+    for (u32 i = start; i < end; i++) {
+      Vec3f center(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]);
+
+      updateObject(poolObjects[i]._record, center, bounds.radius[i]);
+    }
+  }
+
+  /**
+   * Calls a visitor with each object in the leaf nodes which
+   * overlap a box, as well as each pending object.
+   */
+  template<typename Visitor>
+  void SceneBvh::visitBox(const Vec3f& min, const Vec3f& max, Visitor visitor) const {
+    for (auto slot : pendingObjects) {
+      visitor(objects[slot]);
+    }
+
+    if (nodes.size() == 0) {
+      return;
+    }
+
+    std::vector<u32> stack = { 0 };
+
+    while (stack.size() > 0) {
+      auto& node = nodes[stack.back()];
+
+      stack.pop_back();
+
+      if (!isBoxOverlapping(node, min, max)) {
+        continue;
+      }
+
+      if (node.count > 0) {
+        for (u32 i = node.first; i < node.first + node.count; i++) {
+          if (nodeObjects[i] != INVALID_SLOT) {
+            visitor(objects[nodeObjects[i]]);
+          }
+        }
+      } else {
+        stack.push_back(node.first);
+        stack.push_back(node.first + 1);
+      }
+    }
+  }
+
+  /**
+   * Calls a visitor with each object whose bounding sphere
+   * intersects a frustum. Planes which a node is entirely in
+   * front of are skipped for its descendants, and objects in
+   * nodes entirely inside of the frustum aren't tested at all.
+   */
+  template<typename Visitor>
+  void SceneBvh::visitFrustum(const Frustum& frustum, Visitor visitor) const {
+    constexpr u32 ALL_PLANES = 0b111111;
+
+    for (auto slot : pendingObjects) {
+      auto& object = objects[slot];
+
+      if (frustum.isSphereVisible(object.center, object.radius)) {
+        visitor(object);
+      }
+    }
+
+    if (nodes.size() == 0) {
+      return;
+    }
+
+    struct FrustumVisit {
+      u32 node;
+      u32 planeMask;
+    };
+
+    std::vector<FrustumVisit> stack = { { 0, ALL_PLANES } };
+
+    while (stack.size() > 0) {
+      auto visit = stack.back();
+      auto& node = nodes[visit.node];
+      u32 planeMask = visit.planeMask;
+      bool isOutside = false;
+
+      stack.pop_back();
+
+      for (u32 p = 0; p < 6; p++) {
+        if ((planeMask & (1 << p)) == 0) {
+          continue;
+        }
+
+        auto& plane = frustum.planes[p];
+        auto& normal = plane.normal;
+
+        // Test the corners furthest along and against the normal
+        Vec3f inner(
+          normal.x > 0.0f ? node.max.x : node.min.x,
+          normal.y > 0.0f ? node.max.y : node.min.y,
+          normal.z > 0.0f ? node.max.z : node.min.z
+        );
+
+        Vec3f outer(
+          normal.x > 0.0f ? node.min.x : node.max.x,
+          normal.y > 0.0f ? node.min.y : node.max.y,
+          normal.z > 0.0f ? node.min.z : node.max.z
+        );
+
+        if (Vec3f::dot(normal, inner) + plane.distance < 0.0f) {
+          isOutside = true;
+
+          break;
+        }
+
+        if (Vec3f::dot(normal, outer) + plane.distance >= 0.0f) {
+          planeMask &= ~(1 << p);
+        }
+      }
+
+      if (isOutside) {
+        continue;
+      }
+
+      if (node.count > 0) {
+        for (u32 i = node.first; i < node.first + node.count; i++) {
+          if (nodeObjects[i] == INVALID_SLOT) {
+            continue;
+          }
+
+          auto& object = objects[nodeObjects[i]];
+
+          if (planeMask == 0 || frustum.isSphereVisible(object.center, object.radius)) {
+            visitor(object);
+          }
+        }
+      } else {
+        stack.push_back({ node.first, planeMask });
+        stack.push_back({ node.first + 1, planeMask });
+      }
+    }
+  }
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <future>
+#include <vector>
+
+#include "math/frustum.h"
+#include "math/vector.h"
+#include "system/entities.h"
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * BvhNode
+   * -------
+   *
+   * An axis-aligned bounding box in a SceneBvh. Leaf nodes
+   * refer to objects [first, first + count) in the BVH's list
+   * of node objects, whereas internal nodes have a count of 0
+   * and children at nodes [first] and [first + 1].
+   */
+  struct BvhNode {
+    Vec3f min;
+    u32 first = 0;
+    Vec3f max;
+    u32 count = 0;
+  };
+
+  /**
+   * BvhObject
+   * ---------
+   *
+   * The world space bounding sphere of an object tracked by a
+   * SceneBvh, along with the leaf node containing it. Objects
+   * added since the last rebuild aren't in any node yet, and
+   * are kept in a pending list instead.
+   */
+  struct BvhObject {
+    ObjectRecord record;
+    Vec3f center;
+    float radius = 0.0f;
+    u32 node = 0;
+    u32 pendingIndex = 0;
+  };
+
+  /**
+   * BvhRayHit
+   * ---------
+   *
+   * The nearest object bounding sphere hit by a ray.
+   */
+  struct BvhRayHit {
+    ObjectRecord record;
+    float distance = 0.0f;
+  };
+
+  /**
+   * BvhBuild
+   * --------
+   *
+   * The output of a SAH build, which may be produced on
+   * a background thread and swapped in once it's done.
+   */
+  struct BvhBuild {
+    std::vector<BvhNode> nodes;
+    std::vector<u32> parents;
+    std::vector<u32> nodeObjects;
+    float cost = 0.0f;
+  };
+
+  /**
+   * SceneBvh
+   * --------
+   *
+   * A bounding volume hierarchy over the objects of every mesh
+   * in a scene, keyed by object record. Objects are added or
+   * moved with updateObject()/updateObjects(), or as their
+   * bounds change with updateChangedObjects(), which refits the
+   * affected nodes on the next update().
+   *
+   * Once refits or newly added objects degrade the tree enough,
+   * update() rebuilds it with the surface area heuristic on a
+   * background thread, and swaps it in on a later update().
+   *
+   * Records of objects removed without removeRecord() are
+   * dropped the next time they're found to be stale during
+   * partitionByVisibility(), and may otherwise still be
+   * returned from queries until then.
+   */
+  class SceneBvh {
+  public:
+    float getCost() const;
+    void partitionByVisibility(const Frustum& frustum, const std::vector<Mesh*>& meshes);
+    void queryBox(const Vec3f& min, const Vec3f& max, std::vector<ObjectRecord>& records) const;
+    void queryFrustum(const Frustum& frustum, std::vector<ObjectRecord>& records) const;
+    void querySphere(const Vec3f& center, float radius, std::vector<ObjectRecord>& records) const;
+    bool raycast(const Vec3f& origin, const Vec3f& direction, float maxDistance, BvhRayHit& hit) const;
+    void rebuild();
+    void removeRecord(const ObjectRecord& record);
+    void reset();
+    u32 totalObjects() const;
+    u32 totalPendingObjects() const;
+    void update();
+    void updateChangedObjects(ObjectPool& pool);
+    void updateObject(const ObjectRecord& record, const Vec3f& center, float radius);
+    void updateObjects(const ObjectPool& pool, u32 start, u32 end);
+
+  private:
+    std::vector<BvhNode> nodes;
+    std::vector<u32> parents;
+    /**
+     * Object slots referred to by leaf nodes. Slots of
+     * objects removed since the last rebuild are replaced
+     * with INVALID_SLOT, rather than shifting leaf ranges.
+     */
+    std::vector<u32> nodeObjects;
+    /**
+     * Leaf nodes whose objects have moved since the last
+     * update(), and therefore need to be refitted.
+     */
+    std::vector<u32> dirtyNodes;
+    std::vector<bool> dirtyNodeFlags;
+    /**
+     * Object slots, reused once their objects are removed.
+     * Slots are looked up by [meshIndex][objectId], offset
+     * by 1 so that 0 means an object has no slot.
+     */
+    std::vector<BvhObject> objects;
+    std::vector<u32> freeSlots;
+    std::vector<std::vector<u32>> slotsByMesh;
+    std::vector<u32> pendingObjects;
+    /**
+     * Slots freed while a rebuild is running, which may be
+     * referred to by the rebuilt tree until it's swapped in.
+     */
+    std::vector<u32> deferredFreeSlots;
+    std::future<BvhBuild> rebuildTask;
+    /**
+     * Visibility bits for each mesh's ObjectPool, reused
+     * across calls to partitionByVisibility().
+     */
+    std::vector<std::vector<u32>> visibilityMasks;
+    std::vector<ObjectRecord> staleRecords;
+    /**
+     * IDs of objects taken from an ObjectPool's tracked bounds
+     * changes, reused across calls to updateChangedObjects().
+     */
+    std::vector<u32> changedIds;
+    u32 totalActiveObjects = 0;
+    u32 totalRemovedSinceBuild = 0;
+    float builtCost = 0.0f;
+    float currentCost = 0.0f;
+
+    u32 allocateSlot(const ObjectRecord& record);
+    void freeSlot(u32 slot);
+    u32 findSlot(const ObjectRecord& record) const;
+    void installBuild(BvhBuild& build);
+    void markDirty(u32 node);
+    void refitAll();
+    void refitNode(u32 node);
+    template<typename Visitor>
+    void visitBox(const Vec3f& min, const Vec3f& max, Visitor visitor) const;
+    template<typename Visitor>
+    void visitFrustum(const Frustum& frustum, Visitor visitor) const;
+  };
+}
\ No newline at end of file
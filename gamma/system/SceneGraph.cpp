@@ -0,0 +1,403 @@
+#include <algorithm>
+
+#include "system/assert.h"
+#include "system/SceneGraph.h"
+
+namespace Gamma {
+  /**
+   * Marks the (nonexistent) parent of root nodes, and lookups
+   * of records without a node.
+   */
+  constexpr static u32 NO_PARENT = 0xFFFFFFFF;
+  constexpr static u32 NO_NODE = 0xFFFFFFFF;
+
+  /**
+   * Marks removed nodes, which are dropped on the next sort.
+   */
+  constexpr static u32 REMOVED_NODE = 0xFFFFFFFE;
+
+  u32 SceneGraph::addNode(const ObjectRecord& record) {
+    u32 node = (u32)records.size();
+
+    records.push_back(record);
+    parents.push_back(NO_PARENT);
+    localMatrices.push_back(Matrix4f::identity());
+    worldMatrices.push_back(Matrix4f::identity());
+    dirtyFlags.push_back(0);
+
+    if (totalNodesByMesh.size() <= record.meshIndex) {
+      totalNodesByMesh.resize(record.meshIndex + 1, 0);
+    }
+
+    totalNodesByMesh[record.meshIndex]++;
+
+    setNode(record, node);
+    markDirty(node);
+
+    isSorted = false;
+
+    return node;
+  }
+
+  /**
+   * Attaches an object to a parent object, adding either one
+   * as a node if it isn't in the graph yet. Objects which are
+   * already attached are moved to the new parent.
+   */
+  void SceneGraph::attach(const ObjectRecord& child, const ObjectRecord& parent) {
+    u32 parentNode = findNode(parent);
+    u32 childNode = findNode(child);
+
+    if (parentNode == NO_NODE) {
+      parentNode = addNode(parent);
+    }
+
+    if (childNode == NO_NODE) {
+      childNode = addNode(child);
+    }
+
+    for (u32 node = parentNode; node < records.size(); node = parents[node]) {
+      assert(node != childNode, "Scene Graph: cannot attach an object to itself or its own descendant");
+    }
+
+    parents[childNode] = parentNode;
+
+    markDirty(childNode);
+
+    isSorted = false;
+  }
+
+  /**
+   * Detaches an object from its parent. The object keeps its
+   * last world matrix as its local matrix, until it's next
+   * committed.
+   */
+  void SceneGraph::detach(const ObjectRecord& record) {
+    u32 node = findNode(record);
+
+    if (node == NO_NODE || parents[node] == NO_PARENT) {
+      return;
+    }
+
+    parents[node] = NO_PARENT;
+    localMatrices[node] = worldMatrices[node];
+
+    markDirty(node);
+
+    isSorted = false;
+  }
+
+  u32 SceneGraph::findNode(const ObjectRecord& record) const {
+    if (record.meshIndex >= nodesByMesh.size()) {
+      return NO_NODE;
+    }
+
+    auto& meshNodes = nodesByMesh[record.meshIndex];
+
+    if (record.id >= meshNodes.size() || meshNodes[record.id] == 0) {
+      return NO_NODE;
+    }
+
+    u32 node = meshNodes[record.id] - 1;
+
+    return records[node].generation == record.generation ? node : NO_NODE;
+  }
+
+  const std::vector<ObjectRecord>& SceneGraph::getUpdatedRecords() const {
+    return updatedRecords;
+  }
+
+  const Matrix4f& SceneGraph::getWorldMatrix(const ObjectRecord& record) const {
+    u32 node = findNode(record);
+
+    assert(node != NO_NODE, "Scene Graph: object not found");
+
+    return worldMatrices[node];
+  }
+
+  bool SceneGraph::hasParent(const ObjectRecord& record) const {
+    u32 node = findNode(record);
+
+    if (node == NO_NODE) {
+      return false;
+    }
+
+    u32 parent = parents[node];
+
+    return parent != NO_PARENT && parents[parent] != REMOVED_NODE;
+  }
+
+  bool SceneGraph::hasRecord(const ObjectRecord& record) const {
+    return findNode(record) != NO_NODE;
+  }
+
+  void SceneGraph::markDirty(u32 node) {
+    dirtyFlags[node] = 1;
+    firstDirtyNode = std::min(firstDirtyNode, node);
+  }
+
+  /**
+   * Detaches a node from its parent if its parent was removed,
+   * keeping its last world matrix.
+   */
+  void SceneGraph::orphan(u32 node) {
+    u32 parent = parents[node];
+
+    if (parent < records.size() && parents[parent] == REMOVED_NODE) {
+      parents[node] = NO_PARENT;
+      localMatrices[node] = worldMatrices[node];
+    }
+  }
+
+  /**
+   * Removes an object's node. Its children are detached on
+   * the next update(), keeping their last world matrices.
+   */
+  void SceneGraph::removeRecord(const ObjectRecord& record) {
+    u32 node = findNode(record);
+
+    if (node == NO_NODE) {
+      return;
+    }
+
+    parents[node] = REMOVED_NODE;
+    nodesByMesh[record.meshIndex][record.id] = 0;
+    totalNodesByMesh[record.meshIndex]--;
+
+    isSorted = false;
+  }
+
+  void SceneGraph::reset() {
+    records.clear();
+    parents.clear();
+    localMatrices.clear();
+    worldMatrices.clear();
+    dirtyFlags.clear();
+    nodesByMesh.clear();
+    totalNodesByMesh.clear();
+    updatedRecords.clear();
+
+    firstDirtyNode = 0;
+    isSorted = true;
+  }
+
+  void SceneGraph::setLocalMatrix(const ObjectRecord& record, const Matrix4f& matrix) {
+    u32 node = findNode(record);
+
+    if (node == NO_NODE) {
+      return;
+    }
+
+    orphan(node);
+
+    localMatrices[node] = matrix;
+
+    markDirty(node);
+  }
+
+  void SceneGraph::setNode(const ObjectRecord& record, u32 node) {
+    if (nodesByMesh.size() <= record.meshIndex) {
+      nodesByMesh.resize(record.meshIndex + 1);
+    }
+
+    auto& meshNodes = nodesByMesh[record.meshIndex];
+
+    if (meshNodes.size() <= record.id) {
+      meshNodes.resize(record.id + 1, 0);
+    }
+
+    meshNodes[record.id] = node + 1;
+  }
+
+  /**
+   * Sorts nodes into breadth-first order, starting from each
+   * root with children. Removed nodes and childless roots are
+   * dropped, and children of removed nodes become roots.
+   */
+  void SceneGraph::sort() {
+    u32 total = (u32)records.size();
+    std::vector<u32> childOffsets(total + 1, 0);
+    std::vector<u32> children(total);
+    std::vector<u32> order;
+
+    for (u32 i = 0; i < total; i++) {
+      orphan(i);
+
+      if (parents[i] < total) {
+        childOffsets[parents[i] + 1]++;
+      }
+    }
+
+    for (u32 i = 0; i < total; i++) {
+      childOffsets[i + 1] += childOffsets[i];
+    }
+
+    std::vector<u32> cursors(childOffsets.begin(), childOffsets.end() - 1);
+
+    for (u32 i = 0; i < total; i++) {
+      u32 parent = parents[i];
+
+      if (parent < total) {
+        children[cursors[parent]++] = i;
+      }
+    }
+
+    for (u32 i = 0; i < total; i++) {
+      if (parents[i] == NO_PARENT && childOffsets[i + 1] > childOffsets[i]) {
+        order.push_back(i);
+      }
+    }
+
+    for (u32 head = 0; head < order.size(); head++) {
+      u32 node = order[head];
+
+      for (u32 c = childOffsets[node]; c < childOffsets[node + 1]; c++) {
+        order.push_back(children[c]);
+      }
+    }
+
+    // Unlist every node before relisting the sorted ones,
+    // leaving alone any lookups already taken over by nodes
+    // added since their object IDs were reused
+    for (u32 i = 0; i < total; i++) {
+      auto& record = records[i];
+
+      if (parents[i] != REMOVED_NODE && nodesByMesh[record.meshIndex][record.id] == i + 1) {
+        nodesByMesh[record.meshIndex][record.id] = 0;
+      }
+    }
+
+    std::vector<u32> sortedIndexes(total, NO_NODE);
+    std::vector<ObjectRecord> sortedRecords(order.size());
+    std::vector<u32> sortedParents(order.size());
+    std::vector<Matrix4f> sortedLocalMatrices(order.size());
+    std::vector<Matrix4f> sortedWorldMatrices(order.size());
+    std::vector<u8> sortedDirtyFlags(order.size());
+
+    std::fill(totalNodesByMesh.begin(), totalNodesByMesh.end(), 0);
+
+    firstDirtyNode = (u32)order.size();
+
+    for (u32 i = 0; i < order.size(); i++) {
+      u32 node = order[i];
+      u32 parent = parents[node];
+      auto& record = records[node];
+
+      sortedIndexes[node] = i;
+      sortedRecords[i] = record;
+      // Parents are always sorted before their children
+      sortedParents[i] = parent == NO_PARENT ? NO_PARENT : sortedIndexes[parent];
+      sortedLocalMatrices[i] = localMatrices[node];
+      sortedWorldMatrices[i] = worldMatrices[node];
+      sortedDirtyFlags[i] = dirtyFlags[node];
+
+      if (dirtyFlags[node] && firstDirtyNode == order.size()) {
+        firstDirtyNode = i;
+      }
+
+      setNode(record, i);
+
+      totalNodesByMesh[record.meshIndex]++;
+    }
+
+    records = std::move(sortedRecords);
+    parents = std::move(sortedParents);
+    localMatrices = std::move(sortedLocalMatrices);
+    worldMatrices = std::move(sortedWorldMatrices);
+    dirtyFlags = std::move(sortedDirtyFlags);
+
+    isSorted = true;
+  }
+
+  /**
+   * Takes the local matrices of any nodes among objects
+   * [start, end) of an ObjectPool from the pool's matrices,
+   * after the objects are committed in bulk.
+   */
+  void SceneGraph::syncObjects(const ObjectPool& pool, u32 start, u32 end) {
+    end = std::min(end, pool.totalActive());
+
+    if (start >= end) {
+      return;
+    }
+
+    auto* poolObjects = pool.begin();
+    u16 meshIndex = poolObjects[start]._record.meshIndex;
+
+    if (meshIndex >= totalNodesByMesh.size() || totalNodesByMesh[meshIndex] == 0) {
+      return;
+    }
+
+    for (u32 i = start; i < end; i++) {
+      u32 node = findNode(poolObjects[i]._record);
+
+      if (node == NO_NODE) {
+        continue;
+      }
+
+      if (pool.getMatrixFormat() == MatrixFormat::AFFINE) {
+        localMatrices[node] = pool.getAffineMatrices()[i].toMatrix4f();
+      } else {
+        localMatrices[node] = pool.getMatrices()[i];
+      }
+
+      markDirty(node);
+    }
+  }
+
+  u32 SceneGraph::totalNodes() const {
+    return (u32)records.size();
+  }
+
+  /**
+   * Recomputes the world matrices of dirty nodes and their
+   * descendants, and writes them into their objects' pools.
+   * Root matrices are written when their objects are
+   * committed, so only child matrices are written here.
+   */
+  void SceneGraph::update(const std::vector<Mesh*>& meshes) {
+    if (!isSorted) {
+      sort();
+    }
+
+    u32 total = (u32)records.size();
+
+    updatedRecords.clear();
+
+    for (u32 i = firstDirtyNode; i < total; i++) {
+      u32 parent = parents[i];
+
+      if (parent == NO_PARENT) {
+        if (dirtyFlags[i]) {
+          worldMatrices[i] = localMatrices[i];
+        }
+
+        continue;
+      }
+
+      if (!dirtyFlags[i] && !dirtyFlags[parent]) {
+        continue;
+      }
+
+      // Transposed matrices multiply in reverse, so this is
+      // parent * local in row-major terms
+      worldMatrices[i] = localMatrices[i] * worldMatrices[parent];
+      dirtyFlags[i] = 1;
+
+      auto& record = records[i];
+      auto& pool = meshes[record.meshIndex]->objects;
+
+      if (pool.getByRecord(record) != nullptr) {
+        pool.transformById(record.id, worldMatrices[i]);
+
+        updatedRecords.push_back(record);
+      }
+    }
+
+    if (firstDirtyNode < total) {
+      std::fill(dirtyFlags.begin() + firstDirtyNode, dirtyFlags.end(), 0);
+    }
+
+    firstDirtyNode = total;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+
+#include "math/matrix.h"
+#include "system/entities.h"
+#include "system/ObjectPool.h"
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * SceneGraph
+   * ----------
+   *
+   * Parent/child relationships between objects, across every
+   * mesh in a scene, keyed by object record. Each node has a
+   * local matrix relative to its parent, and a world matrix;
+   * root nodes have no parent, so their world matrix is their
+   * local matrix.
+   *
+   * Nodes are stored as flat arrays sorted in breadth-first
+   * order, so every parent comes before its children. update()
+   * recomputes world matrices in a single linear pass from the
+   * first dirty node onward, with each node only recomputed
+   * when it or its parent changed, and writes them into the
+   * matrix slots of the children's objects.
+   *
+   * Attaching, detaching or removing nodes only marks the
+   * order as stale, and nodes are re-sorted once on the next
+   * update(). Roots left without any children are dropped,
+   * and become ordinary objects again.
+   *
+   * All matrices are transposed (column-major), like those
+   * in an ObjectPool.
+   */
+  class SceneGraph {
+  public:
+    void attach(const ObjectRecord& child, const ObjectRecord& parent);
+    void detach(const ObjectRecord& record);
+    const std::vector<ObjectRecord>& getUpdatedRecords() const;
+    const Matrix4f& getWorldMatrix(const ObjectRecord& record) const;
+    bool hasParent(const ObjectRecord& record) const;
+    bool hasRecord(const ObjectRecord& record) const;
+    void removeRecord(const ObjectRecord& record);
+    void reset();
+    void setLocalMatrix(const ObjectRecord& record, const Matrix4f& matrix);
+    void syncObjects(const ObjectPool& pool, u32 start, u32 end);
+    u32 totalNodes() const;
+    void update(const std::vector<Mesh*>& meshes);
+
+  private:
+    std::vector<ObjectRecord> records;
+    /**
+     * The node index of each node's parent, or NO_PARENT for
+     * roots. Until nodes are re-sorted, parents may come after
+     * their children, and removed nodes are kept in place
+     * with a parent of REMOVED_NODE.
+     */
+    std::vector<u32> parents;
+    std::vector<Matrix4f> localMatrices;
+    std::vector<Matrix4f> worldMatrices;
+    /**
+     * Nodes whose local matrix or parent changed since the
+     * last update(). During update(), dirty flags propagate
+     * to children, since every parent is visited first.
+     */
+    std::vector<u8> dirtyFlags;
+    /**
+     * Nodes are looked up by [meshIndex][objectId], offset by
+     * 1 so that 0 means an object has no node.
+     */
+    std::vector<std::vector<u32>> nodesByMesh;
+    std::vector<u32> totalNodesByMesh;
+    /**
+     * Records of the objects whose matrices were written by
+     * the last update(), reused between updates.
+     */
+    std::vector<ObjectRecord> updatedRecords;
+    u32 firstDirtyNode = 0;
+    bool isSorted = true;
+
+    u32 addNode(const ObjectRecord& record);
+    u32 findNode(const ObjectRecord& record) const;
+    void markDirty(u32 node);
+    void orphan(u32 node);
+    void setNode(const ObjectRecord& record, u32 node);
+    void sort();
+  };
+}
\ No newline at end of file
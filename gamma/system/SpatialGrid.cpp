@@ -0,0 +1,478 @@
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "system/SpatialGrid.h"
+
+namespace Gamma {
+  /**
+   * Marks entries of objects which aren't in the grid.
+   */
+  constexpr static u32 INVALID_CELL = 0xFFFFFFFF;
+
+  /**
+   * Terminates the object lists of each cell.
+   */
+  constexpr static u32 NO_ENTRY = 0xFFFFFFFF;
+
+  constexpr static u32 MIN_TABLE_SIZE = 64;
+
+  inline static u32 hashCell(s32 x, s32 y, s32 z) {
+    return ((u32)x * 73856093) ^ ((u32)y * 19349663) ^ ((u32)z * 83492791);
+  }
+
+  inline static s32 toCellCoordinate(float value, float inverseCellSize) {
+    return (s32)floorf(value * inverseCellSize);
+  }
+
+  /**
+   * SpatialGrid
+   * -----------
+   */
+  void SpatialGrid::clear() {
+    cells.clear();
+    entries.clear();
+
+    maxRadius = 0.0f;
+    totalUsedCells = 0;
+    totalOccupiedCells = 0;
+  }
+
+  u32 SpatialGrid::findCell(s32 x, s32 y, s32 z) const {
+    if (cells.size() == 0) {
+      return INVALID_CELL;
+    }
+
+    u32 mask = (u32)cells.size() - 1;
+    u32 index = hashCell(x, y, z) & mask;
+
+    while (cells[index].isUsed) {
+      auto& cell = cells[index];
+
+      if (cell.x == x && cell.y == y && cell.z == z) {
+        return index;
+      }
+
+      index = (index + 1) & mask;
+    }
+
+    return INVALID_CELL;
+  }
+
+  /**
+   * Returns the index of a cell in the cell table, adding it
+   * if it doesn't exist yet. Emptied cells are kept in the
+   * table until it is next rehashed, so the table is rehashed
+   * once it's half full of either kind of cell.
+   */
+  u32 SpatialGrid::findOrCreateCell(s32 x, s32 y, s32 z) {
+    u32 existingCell = findCell(x, y, z);
+
+    if (existingCell != INVALID_CELL) {
+      return existingCell;
+    }
+
+    if ((totalUsedCells + 1) * 2 > cells.size()) {
+      u32 capacity = MIN_TABLE_SIZE;
+
+      while (capacity < (totalOccupiedCells + 1) * 4) {
+        capacity *= 2;
+      }
+
+      rehash(capacity);
+    }
+
+    u32 mask = (u32)cells.size() - 1;
+    u32 index = hashCell(x, y, z) & mask;
+
+    while (cells[index].isUsed) {
+      index = (index + 1) & mask;
+    }
+
+    auto& cell = cells[index];
+
+    cell.x = x;
+    cell.y = y;
+    cell.z = z;
+    cell.head = NO_ENTRY;
+    cell.count = 0;
+    cell.isUsed = true;
+
+    totalUsedCells++;
+
+    return index;
+  }
+
+  void SpatialGrid::free() {
+    clear();
+
+    cells.shrink_to_fit();
+    entries.shrink_to_fit();
+  }
+
+  /**
+   * Returns the loose bounds of a cell, which enclose any
+   * object centered within it.
+   */
+  void SpatialGrid::getCellBounds(const GridCell& cell, Vec3f& min, Vec3f& max) const {
+    min = Vec3f((float)cell.x, (float)cell.y, (float)cell.z) * cellSize - Vec3f(maxRadius);
+    max = Vec3f((float)cell.x + 1.0f, (float)cell.y + 1.0f, (float)cell.z + 1.0f) * cellSize + Vec3f(maxRadius);
+  }
+
+  float SpatialGrid::getCellSize() const {
+    return cellSize;
+  }
+
+  bool SpatialGrid::has(u32 id) const {
+    return id < entries.size() && entries[id].cell != INVALID_CELL;
+  }
+
+  void SpatialGrid::link(u32 id, u32 cellIndex) {
+    auto& cell = cells[cellIndex];
+    auto& entry = entries[id];
+
+    entry.cell = cellIndex;
+    entry.previous = NO_ENTRY;
+    entry.next = cell.head;
+
+    if (cell.head != NO_ENTRY) {
+      entries[cell.head].previous = id;
+    }
+
+    cell.head = id;
+
+    if (cell.count++ == 0) {
+      totalOccupiedCells++;
+    }
+  }
+
+  /**
+   * Collects the IDs of objects whose bounding spheres intersect
+   * a frustum. Cells entirely outside of the frustum are skipped,
+   * and all objects in cells entirely inside of it are collected
+   * without testing them individually.
+   */
+  void SpatialGrid::queryFrustum(const Frustum& frustum, std::vector<u32>& ids) const {
+    for (auto& cell : cells) {
+      if (cell.count == 0) {
+        continue;
+      }
+
+      Vec3f min;
+      Vec3f max;
+      bool isOutside = false;
+      bool isInside = true;
+
+      getCellBounds(cell, min, max);
+
+      for (u32 p = 0; p < 6; p++) {
+        auto& plane = frustum.planes[p];
+        auto& normal = plane.normal;
+
+        Vec3f inner(
+          normal.x > 0.0f ? max.x : min.x,
+          normal.y > 0.0f ? max.y : min.y,
+          normal.z > 0.0f ? max.z : min.z
+        );
+
+        Vec3f outer(
+          normal.x > 0.0f ? min.x : max.x,
+          normal.y > 0.0f ? min.y : max.y,
+          normal.z > 0.0f ? min.z : max.z
+        );
+
+        if (Vec3f::dot(normal, inner) + plane.distance < 0.0f) {
+          isOutside = true;
+
+          break;
+        }
+
+        if (Vec3f::dot(normal, outer) + plane.distance < 0.0f) {
+          isInside = false;
+        }
+      }
+
+      if (isOutside) {
+        continue;
+      }
+
+      for (u32 id = cell.head; id != NO_ENTRY; id = entries[id].next) {
+        auto& entry = entries[id];
+
+        if (isInside || frustum.isSphereVisible(entry.center, entry.radius)) {
+          ids.push_back(id);
+        }
+      }
+    }
+  }
+
+  /**
+   * Collects the IDs of up to [total] objects with centers
+   * nearest to a position, nearest first. Rings of cells are
+   * searched outward from the position's cell until no closer
+   * objects can remain, or until searching every occupied cell
+   * directly would be cheaper.
+   */
+  void SpatialGrid::queryNearest(const Vec3f& position, u32 total, std::vector<u32>& ids) const {
+    if (total == 0 || totalOccupiedCells == 0) {
+      return;
+    }
+
+    // Max-heap of the nearest objects found so far
+    std::vector<std::pair<float, u32>> nearest;
+
+    auto visitCell = [&](const GridCell& cell) {
+      for (u32 id = cell.head; id != NO_ENTRY; id = entries[id].next) {
+        Vec3f delta = entries[id].center - position;
+        float distanceSquared = Vec3f::dot(delta, delta);
+
+        if (nearest.size() < total) {
+          nearest.push_back({ distanceSquared, id });
+
+          std::push_heap(nearest.begin(), nearest.end());
+        } else if (distanceSquared < nearest.front().first) {
+          std::pop_heap(nearest.begin(), nearest.end());
+
+          nearest.back() = { distanceSquared, id };
+
+          std::push_heap(nearest.begin(), nearest.end());
+        }
+      }
+    };
+
+    s32 x = toCellCoordinate(position.x, inverseCellSize);
+    s32 y = toCellCoordinate(position.y, inverseCellSize);
+    s32 z = toCellCoordinate(position.z, inverseCellSize);
+    u32 totalVisitedCells = 0;
+
+    for (s32 ring = 0; totalVisitedCells < totalOccupiedCells; ring++) {
+      u64 side = (u64)ring * 2 + 1;
+
+      if (side * side * side > (u64)totalOccupiedCells * 2) {
+        nearest.clear();
+
+        for (auto& cell : cells) {
+          if (cell.count > 0) {
+            visitCell(cell);
+          }
+        }
+
+        break;
+      }
+
+      // Visit the shell of cells [ring] cells away
+      for (s32 dx = -ring; dx <= ring; dx++) {
+        for (s32 dy = -ring; dy <= ring; dy++) {
+          bool isOnShell = dx == -ring || dx == ring || dy == -ring || dy == ring;
+          s32 step = isOnShell || ring == 0 ? 1 : ring * 2;
+
+          for (s32 dz = -ring; dz <= ring; dz += step) {
+            u32 cellIndex = findCell(x + dx, y + dy, z + dz);
+
+            if (cellIndex != INVALID_CELL && cells[cellIndex].count > 0) {
+              visitCell(cells[cellIndex]);
+
+              totalVisitedCells++;
+            }
+          }
+        }
+      }
+
+      // Objects in cells beyond this ring are at least
+      // [ring] cells away from the position
+      float reach = (float)ring * cellSize;
+
+      if (nearest.size() == total && nearest.front().first <= reach * reach) {
+        break;
+      }
+    }
+
+    std::sort_heap(nearest.begin(), nearest.end());
+
+    for (auto& pair : nearest) {
+      ids.push_back(pair.second);
+    }
+  }
+
+  /**
+   * Collects the IDs of objects whose bounding spheres
+   * overlap a sphere.
+   */
+  void SpatialGrid::querySphere(const Vec3f& center, float radius, std::vector<u32>& ids) const {
+    visitCells(center - Vec3f(radius), center + Vec3f(radius), [&](const GridCell& cell) {
+      for (u32 id = cell.head; id != NO_ENTRY; id = entries[id].next) {
+        auto& entry = entries[id];
+        Vec3f delta = entry.center - center;
+        float range = radius + entry.radius;
+
+        if (Vec3f::dot(delta, delta) <= range * range) {
+          ids.push_back(id);
+        }
+      }
+    });
+  }
+
+  /**
+   * Rebuilds the cell table at a new capacity, dropping any
+   * cells which have been emptied.
+   */
+  void SpatialGrid::rehash(u32 capacity) {
+    auto previousCells = std::move(cells);
+    u32 mask = capacity - 1;
+
+    cells.assign(capacity, GridCell());
+
+    totalUsedCells = 0;
+
+    for (auto& previousCell : previousCells) {
+      if (previousCell.count == 0) {
+        continue;
+      }
+
+      u32 index = hashCell(previousCell.x, previousCell.y, previousCell.z) & mask;
+
+      while (cells[index].isUsed) {
+        index = (index + 1) & mask;
+      }
+
+      cells[index] = previousCell;
+
+      for (u32 id = previousCell.head; id != NO_ENTRY; id = entries[id].next) {
+        entries[id].cell = index;
+      }
+
+      totalUsedCells++;
+    }
+  }
+
+  void SpatialGrid::remove(u32 id) {
+    if (has(id)) {
+      unlink(id);
+    }
+  }
+
+  /**
+   * Changes the size of each grid cell, redistributing
+   * any objects already in the grid.
+   */
+  void SpatialGrid::setCellSize(float size) {
+    cellSize = size;
+    inverseCellSize = 1.0f / size;
+
+    cells.clear();
+
+    totalUsedCells = 0;
+    totalOccupiedCells = 0;
+
+    for (u32 id = 0; id < entries.size(); id++) {
+      if (entries[id].cell != INVALID_CELL) {
+        entries[id].cell = INVALID_CELL;
+
+        update(id, entries[id].center, entries[id].radius);
+      }
+    }
+  }
+
+  u32 SpatialGrid::totalCells() const {
+    return totalOccupiedCells;
+  }
+
+  void SpatialGrid::unlink(u32 id) {
+    auto& entry = entries[id];
+    auto& cell = cells[entry.cell];
+
+    if (entry.previous != NO_ENTRY) {
+      entries[entry.previous].next = entry.next;
+    } else {
+      cell.head = entry.next;
+    }
+
+    if (entry.next != NO_ENTRY) {
+      entries[entry.next].previous = entry.previous;
+    }
+
+    if (--cell.count == 0) {
+      totalOccupiedCells--;
+    }
+
+    entry.cell = INVALID_CELL;
+  }
+
+  /**
+   * Adds or moves an object. Objects are only relinked
+   * when their centers move into a different cell.
+   */
+  void SpatialGrid::update(u32 id, const Vec3f& center, float radius) {
+    if (id >= entries.size()) {
+      GridEntry unusedEntry;
+
+      unusedEntry.cell = INVALID_CELL;
+
+      entries.resize(id + 1, unusedEntry);
+    }
+
+    s32 x = toCellCoordinate(center.x, inverseCellSize);
+    s32 y = toCellCoordinate(center.y, inverseCellSize);
+    s32 z = toCellCoordinate(center.z, inverseCellSize);
+    auto& entry = entries[id];
+
+    entry.center = center;
+    entry.radius = radius;
+    maxRadius = std::max(maxRadius, radius);
+
+    if (entry.cell != INVALID_CELL) {
+      auto& cell = cells[entry.cell];
+
+      if (cell.x == x && cell.y == y && cell.z == z) {
+        return;
+      }
+
+      unlink(id);
+    }
+
+    link(id, findOrCreateCell(x, y, z));
+  }
+
+  /**
+   * Calls a visitor with each occupied cell whose loose bounds
+   * overlap a box. Cells are looked up by coordinate, unless
+   * the box spans more cells than are occupied.
+   */
+  template<typename Visitor>
+  void SpatialGrid::visitCells(const Vec3f& min, const Vec3f& max, Visitor visitor) const {
+    s32 x1 = toCellCoordinate(min.x - maxRadius, inverseCellSize);
+    s32 y1 = toCellCoordinate(min.y - maxRadius, inverseCellSize);
+    s32 z1 = toCellCoordinate(min.z - maxRadius, inverseCellSize);
+    s32 x2 = toCellCoordinate(max.x + maxRadius, inverseCellSize);
+    s32 y2 = toCellCoordinate(max.y + maxRadius, inverseCellSize);
+    s32 z2 = toCellCoordinate(max.z + maxRadius, inverseCellSize);
+    u64 totalSpannedCells = (u64)(x2 - x1 + 1) * (u64)(y2 - y1 + 1) * (u64)(z2 - z1 + 1);
+
+    if (totalSpannedCells > totalOccupiedCells) {
+      for (auto& cell : cells) {
+        if (
+          cell.count > 0 &&
+          cell.x >= x1 && cell.x <= x2 &&
+          cell.y >= y1 && cell.y <= y2 &&
+          cell.z >= z1 && cell.z <= z2
+        ) {
+          visitor(cell);
+        }
+      }
+
+      return;
+    }
+
+    for (s32 x = x1; x <= x2; x++) {
+      for (s32 y = y1; y <= y2; y++) {
+        for (s32 z = z1; z <= z2; z++) {
+          u32 cellIndex = findCell(x, y, z);
+
+          if (cellIndex != INVALID_CELL && cells[cellIndex].count > 0) {
+            visitor(cells[cellIndex]);
+          }
+        }
+      }
+    }
+  }
+}
\ No newline at end of file
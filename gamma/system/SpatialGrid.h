@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+
+#include "math/frustum.h"
+#include "math/vector.h"
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * GridCell
+   * --------
+   *
+   * An occupied cell of a SpatialGrid, heading a linked list
+   * of the objects whose centers fall inside it.
+   */
+  struct GridCell {
+    s32 x = 0;
+    s32 y = 0;
+    s32 z = 0;
+    u32 head = 0;
+    u32 count = 0;
+    bool isUsed = false;
+  };
+
+  /**
+   * GridEntry
+   * ---------
+   *
+   * The bounding sphere of an object in a SpatialGrid, and
+   * its links to the previous/next objects in its cell.
+   */
+  struct GridEntry {
+    Vec3f center;
+    float radius = 0.0f;
+    u32 cell = 0;
+    u32 previous = 0;
+    u32 next = 0;
+  };
+
+  /**
+   * SpatialGrid
+   * -----------
+   *
+   * A loose uniform grid of objects keyed by object ID, stored
+   * as a hash table of occupied cells. Each object is kept in
+   * the cell containing its center, and cells are treated as
+   * extending by the largest object radius in the grid, so
+   * objects never need to be kept in more than one cell.
+   *
+   * Moving an object costs O(1): either nothing, if it stays in
+   * the same cell, or an unlink and relink if it doesn't. This
+   * makes grids better suited than a BVH to large numbers of
+   * objects which move every frame.
+   */
+  class SpatialGrid {
+  public:
+    void clear();
+    void free();
+    float getCellSize() const;
+    bool has(u32 id) const;
+    void queryFrustum(const Frustum& frustum, std::vector<u32>& ids) const;
+    void queryNearest(const Vec3f& position, u32 total, std::vector<u32>& ids) const;
+    void querySphere(const Vec3f& center, float radius, std::vector<u32>& ids) const;
+    void remove(u32 id);
+    void setCellSize(float size);
+    u32 totalCells() const;
+    void update(u32 id, const Vec3f& center, float radius);
+
+  private:
+    /**
+     * Open-addressed cell table, with a power-of-2 size.
+     */
+    std::vector<GridCell> cells;
+    /**
+     * Entries indexed by object ID. Entries of objects
+     * not in the grid have a cell of INVALID_CELL.
+     */
+    std::vector<GridEntry> entries;
+    float cellSize = 1.0f;
+    float inverseCellSize = 1.0f;
+    /**
+     * The largest object radius seen since the grid was last
+     * cleared, by which all cells are loosened.
+     */
+    float maxRadius = 0.0f;
+    u32 totalUsedCells = 0;
+    u32 totalOccupiedCells = 0;
+
+    u32 findCell(s32 x, s32 y, s32 z) const;
+    u32 findOrCreateCell(s32 x, s32 y, s32 z);
+    void getCellBounds(const GridCell& cell, Vec3f& min, Vec3f& max) const;
+    void link(u32 id, u32 cell);
+    void rehash(u32 capacity);
+    void unlink(u32 id);
+    template<typename Visitor>
+    void visitCells(const Vec3f& min, const Vec3f& max, Visitor visitor) const;
+  };
+}
\ No newline at end of file
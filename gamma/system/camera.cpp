@@ -45,4 +45,56 @@ namespace Gamma {
 
     altitude = Gm_Clampf(altitude, -altitudeLimit, altitudeLimit);
   }
+
+  /**
+   * Gm_GetCameraFrustum()
+   * ---------------------
+   *
+   * Returns the view frustum of a camera in world space.
+   */
+  Frustum Gm_GetCameraFrustum(const Camera& camera, const Area<u32>& area) {
+    return Frustum::fromMatrix(Gm_GetCameraViewProjectionMatrix(camera, area));
+  }
+
+  /**
+   * Gm_GetCameraProjectionMatrix()
+   * ------------------------------
+   *
+   * Returns the (row-major) perspective projection matrix
+   * of a camera, for a given render area.
+   */
+  Matrix4f Gm_GetCameraProjectionMatrix(const Camera& camera, const Area<u32>& area) {
+    return Matrix4f::glPerspective(area, camera.fov, CAMERA_NEAR_PLANE, CAMERA_FAR_PLANE);
+  }
+
+  /**
+   * Gm_GetCameraViewMatrix()
+   * ------------------------
+   *
+   * Returns the (row-major) view matrix of a camera.
+   */
+  Matrix4f Gm_GetCameraViewMatrix(const Camera& camera) {
+    return (
+      camera.rotation.toMatrix4f() *
+      Matrix4f::translation(camera.position.invert().gl())
+    );
+  }
+
+  /**
+   * Gm_GetCameraViewProjectionMatrix()
+   * ----------------------------------
+   *
+   * Returns the (row-major) matrix transforming world space
+   * positions into the clip space of a camera. Since world
+   * positions have their Z axis inverted before being
+   * transformed by the view matrix, the same inversion is
+   * folded into the view-projection matrix.
+   */
+  Matrix4f Gm_GetCameraViewProjectionMatrix(const Camera& camera, const Area<u32>& area) {
+    Matrix4f projection = Gm_GetCameraProjectionMatrix(camera, area);
+    Matrix4f view = Gm_GetCameraViewMatrix(camera);
+    Matrix4f invertZ = Matrix4f::scale(Vec3f(1.0f, 1.0f, -1.0f));
+
+    return projection * view * invertZ;
+  }
 }
\ No newline at end of file
@@ -1,11 +1,20 @@
 #pragma once
 
+#include "math/frustum.h"
 #include "math/matrix.h"
 #include "math/orientation.h"
+#include "math/plane.h"
 #include "math/Quaternion.h"
 #include "math/vector.h"
+#include "system/type_aliases.h"
 
 namespace Gamma {
+  /**
+   * Near/far clipping plane distances for camera projections.
+   */
+  constexpr static float CAMERA_NEAR_PLANE = 1.0f;
+  constexpr static float CAMERA_FAR_PLANE = 10000.0f;
+
   struct Camera {
     Vec3f position;
     Orientation orientation;
@@ -24,4 +33,9 @@ namespace Gamma {
     bool isUpsideDown() const;
     void limitAltitude(float factor);
   };
+
+  Frustum Gm_GetCameraFrustum(const Camera& camera, const Area<u32>& area);
+  Matrix4f Gm_GetCameraProjectionMatrix(const Camera& camera, const Area<u32>& area);
+  Matrix4f Gm_GetCameraViewMatrix(const Camera& camera);
+  Matrix4f Gm_GetCameraViewProjectionMatrix(const Camera& camera, const Area<u32>& area);
 }
\ No newline at end of file
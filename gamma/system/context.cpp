@@ -53,6 +53,7 @@ static void Gm_DisplayDevtools(GmContext* context) {
   auto vertsLabel = "Verts: " + String(sceneStats.verts);
   auto trisLabel = "Tris: " + String(sceneStats.tris);
   auto memoryLabel = "GPU Memory: " + String(renderStats.gpuMemoryUsed) + "MB / " + String(renderStats.gpuMemoryTotal) + "MB";
+  auto uploadLabel = "Instance uploads: " + String(renderStats.instanceBytesUploaded / 1000) + "KB";
 
   renderer.renderText(font_sm, fpsLabel.c_str(), 25, 25);
   renderer.renderText(font_sm, frameTimeLabel.c_str(), 25, 50);
@@ -60,12 +61,13 @@ static void Gm_DisplayDevtools(GmContext* context) {
   renderer.renderText(font_sm, vertsLabel.c_str(), 25, 100);
   renderer.renderText(font_sm, trisLabel.c_str(), 25, 125);
   renderer.renderText(font_sm, memoryLabel.c_str(), 25, 150);
+  renderer.renderText(font_sm, uploadLabel.c_str(), 25, 175);
 
   // Render user-defined debug messages
   u8 index = 0;
 
   for (auto& message : context->debugMessages) {
-    renderer.renderText(font_sm, message.c_str(), 25, 200 + index++ * 25, Vec3f(1.f), Vec4f(0.f, 0.f, 0.f, 0.8f));
+    renderer.renderText(font_sm, message.c_str(), 25, 225 + index++ * 25, Vec3f(1.f), Vec4f(0.f, 0.f, 0.f, 0.8f));
   }
 
   context->debugMessages.clear();
@@ -198,6 +200,8 @@ void Gm_HandleEvents(GmContext* context) {
 }
 
 void Gm_RenderScene(GmContext* context) {
+  Gm_UpdateSceneGraph(context);
+
   context->renderer->render();
 
   #if GAMMA_DEVELOPER_MODE
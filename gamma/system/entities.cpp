@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <map>
@@ -45,6 +46,42 @@ namespace Gamma {
     { 5, 1, 2, 6 }            // right
   };
 
+  /**
+   * Gm_ComputeBounds
+   * ----------------
+   *
+   * Computes the model space bounding box of a mesh, and the
+   * smallest sphere centered on the box which encloses all of
+   * the mesh's vertices.
+   */
+  static void Gm_ComputeBounds(Mesh* mesh) {
+    auto& vertices = mesh->vertices;
+    auto& bounds = mesh->bounds;
+
+    if (vertices.size() == 0) {
+      bounds = Bounds();
+
+      return;
+    }
+
+    bounds.min = vertices[0].position;
+    bounds.max = vertices[0].position;
+
+    for (auto& vertex : vertices) {
+      auto& position = vertex.position;
+
+      bounds.min = Vec3f(std::min(bounds.min.x, position.x), std::min(bounds.min.y, position.y), std::min(bounds.min.z, position.z));
+      bounds.max = Vec3f(std::max(bounds.max.x, position.x), std::max(bounds.max.y, position.y), std::max(bounds.max.z, position.z));
+    }
+
+    bounds.center = (bounds.min + bounds.max) * 0.5f;
+    bounds.radius = 0.0f;
+
+    for (auto& vertex : vertices) {
+      bounds.radius = std::max(bounds.radius, (vertex.position - bounds.center).magnitude());
+    }
+  }
+
   /**
    * Gm_ComputeNormals
    * -----------------
@@ -234,6 +271,7 @@ namespace Gamma {
 
     Gm_ComputeNormals(mesh);
     Gm_ComputeTangents(mesh);
+    Gm_ComputeBounds(mesh);
 
     return mesh;
   }
@@ -256,6 +294,7 @@ namespace Gamma {
     }
 
     Gm_ComputeTangents(mesh);
+    Gm_ComputeBounds(mesh);
 
     return mesh;
   }
@@ -293,6 +332,7 @@ namespace Gamma {
 
     Gm_ComputeNormals(mesh);
     Gm_ComputeTangents(mesh);
+    Gm_ComputeBounds(mesh);
 
     return mesh;
   }
@@ -383,6 +423,7 @@ namespace Gamma {
 
     Gm_ComputeNormals(mesh);
     Gm_ComputeTangents(mesh);
+    Gm_ComputeBounds(mesh);
 
     return mesh;
   }
@@ -57,10 +57,36 @@ namespace Gamma {
     u16 meshIndex = 0;
     // @todo remove this and allow meshes to be 'deactivated' when freed
     u16 meshId = 0;
-    // @todo u32 id with 24 bits for id and 8 for generation,
-    // allowing up to ~16.77 million objects per pool
-    u16 id = 0;
-    u16 generation = 0;
+    // 24 bits for the ID and 8 for its generation, allowing
+    // up to ~16.77 million objects per pool
+    u32 id : 24;
+    u32 generation : 8;
+
+    ObjectRecord(): id(0), generation(0) {};
+  };
+
+  /**
+   * MeshHandle
+   * ----------
+   *
+   * Refers to a Mesh by its index in the scene, resolved once
+   * from the mesh name with Gm_GetMeshHandle(). Avoids looking
+   * meshes up by name in per-frame update loops.
+   */
+  struct MeshHandle {
+    u16 index = 0;
+  };
+
+  /**
+   * NamedObjectHandle
+   * -----------------
+   *
+   * Refers to the record of an object saved by name, resolved
+   * once with Gm_GetObjectHandle(). Handles remain valid when
+   * a different object is saved under the same name.
+   */
+  struct NamedObjectHandle {
+    u32 index = 0;
   };
 
   /**
@@ -251,6 +277,11 @@ namespace Gamma {
      * @see MeshLod
      */
     std::vector<MeshLod> lods;
+    /**
+     * Model space bounds of the mesh vertices, used
+     * to derive the bounding spheres of its objects.
+     */
+    Bounds bounds;
     /**
      * A collection of objects representing unique instances
      * of the mesh.
@@ -290,6 +321,15 @@ namespace Gamma {
      * to shadow maps, enabling them to cast shadows.
      */
     bool canCastShadows = true;
+    /**
+     * Controls whether the mesh's instances inside the view
+     * frustum are rasterized into the CPU occlusion buffer,
+     * hiding the objects behind them. Meshes with LODs
+     * rasterize their last (lowest-detail) LOD as the occluder.
+     *
+     * @see OcclusionBuffer
+     */
+    bool isOccluder = false;
     /**
      * Controls whether the mesh and its instances are
      * ignored in all rendering passes.
@@ -21,7 +21,8 @@ namespace Gamma {
     RENDER_GLOBAL_ILLUMINATION = 1 << 9,
     RENDER_INDIRECT_SKY_LIGHT = 1 << 10,
     RENDER_DEV_BUFFERS = 1 << 11,
-    ENABLE_DENOISING = 1 << 12
+    ENABLE_DENOISING = 1 << 12,
+    RENDER_CLUSTERED_LIGHTS = 1 << 13
   };
 
   void Gm_DisableFlags(GammaFlags flags);
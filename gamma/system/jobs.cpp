@@ -0,0 +1,166 @@
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "system/jobs.h"
+
+namespace Gamma {
+  /**
+   * WorkerPool
+   * ----------
+   *
+   * A set of worker threads which sleep until a job is posted,
+   * then claim batches of it until none are left.
+   */
+  class WorkerPool {
+  public:
+    WorkerPool() {
+      u32 totalThreads = std::thread::hardware_concurrency();
+      u32 totalWorkers = totalThreads > 1 ? totalThreads - 1 : 0;
+
+      for (u32 i = 0; i < totalWorkers; i++) {
+        workers.emplace_back([this]() { work(); });
+      }
+    }
+
+    ~WorkerPool() {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        isStopping = true;
+      }
+
+      wake.notify_all();
+
+      for (auto& worker : workers) {
+        worker.join();
+      }
+    }
+
+    u32 getTotalWorkers() const {
+      return (u32)workers.size();
+    }
+
+    /**
+     * Runs a job across all workers, returning false without
+     * running it if another job is already in progress.
+     */
+    bool run(u32 start, u32 end, u32 batchSize, const RangeJob& job) {
+      bool wasRunning = false;
+
+      if (!isRunning.compare_exchange_strong(wasRunning, true)) {
+        return false;
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        activeJob = &job;
+        jobEnd = end;
+        jobBatchSize = batchSize;
+        nextIndex = start;
+        generation++;
+      }
+
+      wake.notify_all();
+
+      runBatches();
+
+      // Wait for any workers still finishing their batches
+      std::unique_lock<std::mutex> lock(mutex);
+
+      done.wait(lock, [&]() { return activeWorkers == 0; });
+
+      activeJob = nullptr;
+      isRunning = false;
+
+      return true;
+    }
+
+  private:
+    std::vector<std::thread> workers;
+    std::atomic<bool> isRunning = false;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const RangeJob* activeJob = nullptr;
+    std::atomic<u32> nextIndex = 0;
+    u32 jobEnd = 0;
+    u32 jobBatchSize = 0;
+    u32 generation = 0;
+    u32 activeWorkers = 0;
+    bool isStopping = false;
+
+    void runBatches() {
+      while (true) {
+        u32 batchStart = nextIndex.fetch_add(jobBatchSize);
+
+        if (batchStart >= jobEnd) {
+          break;
+        }
+
+        u32 batchEnd = jobEnd - batchStart > jobBatchSize ? batchStart + jobBatchSize : jobEnd;
+
+        (*activeJob)(batchStart, batchEnd);
+      }
+    }
+
+    void work() {
+      std::unique_lock<std::mutex> lock(mutex);
+      u32 lastGeneration = generation;
+
+      while (true) {
+        wake.wait(lock, [&]() {
+          return isStopping || (activeJob != nullptr && generation != lastGeneration);
+        });
+
+        if (isStopping) {
+          return;
+        }
+
+        lastGeneration = generation;
+        activeWorkers++;
+
+        lock.unlock();
+        runBatches();
+        lock.lock();
+
+        if (--activeWorkers == 0) {
+          done.notify_all();
+        }
+      }
+    }
+  };
+
+  static WorkerPool& getWorkerPool() {
+    static WorkerPool workerPool;
+
+    return workerPool;
+  }
+
+  void Gm_ParallelFor(u32 start, u32 end, u32 batchSize, const RangeJob& job) {
+    if (start >= end) {
+      return;
+    }
+
+    auto& workerPool = getWorkerPool();
+
+    if (batchSize == 0) {
+      batchSize = 1;
+    }
+
+    if (
+      end - start <= batchSize ||
+      workerPool.getTotalWorkers() == 0 ||
+      !workerPool.run(start, end, batchSize, job)
+    ) {
+      job(start, end);
+    }
+  }
+
+  u32 Gm_GetTotalWorkerThreads() {
+    return getWorkerPool().getTotalWorkers();
+  }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <functional>
+
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * A job run over a subrange [start, end) of a larger range.
+   */
+  typedef std::function<void(u32 start, u32 end)> RangeJob;
+
+  /**
+   * Splits [start, end) into batches of up to batchSize and runs
+   * them across a persistent set of worker threads, along with
+   * the calling thread. Returns once every batch has finished.
+   *
+   * Ranges too small to split, and nested calls made from within
+   * a running job, are run on the calling thread instead.
+   */
+  void Gm_ParallelFor(u32 start, u32 end, u32 batchSize, const RangeJob& job);
+
+  u32 Gm_GetTotalWorkerThreads();
+}
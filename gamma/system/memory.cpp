@@ -0,0 +1,25 @@
+#include <cstdlib>
+
+#include "system/memory.h"
+
+namespace Gamma {
+  void* Gm_AlignedAlloc(u64 size, u32 alignment) {
+    // Round up to a multiple of the alignment, which
+    // std::aligned_alloc() requires
+    size = (size + alignment - 1) / alignment * alignment;
+
+    #if defined(_MSC_VER)
+      return _aligned_malloc(size, alignment);
+    #else
+      return std::aligned_alloc(alignment, size);
+    #endif
+  }
+
+  void Gm_AlignedFree(void* block) {
+    #if defined(_MSC_VER)
+      _aligned_free(block);
+    #else
+      std::free(block);
+    #endif
+  }
+}
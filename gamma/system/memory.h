@@ -0,0 +1,13 @@
+#pragma once
+
+#include "system/type_aliases.h"
+
+namespace Gamma {
+  /**
+   * Allocates a block of memory whose address is a multiple
+   * of the provided alignment, suitable for aligned SIMD loads
+   * and stores. Blocks must be released with Gm_AlignedFree().
+   */
+  void* Gm_AlignedAlloc(u64 size, u32 alignment);
+  void Gm_AlignedFree(void* block);
+}
@@ -1,6 +1,8 @@
+#include <cmath>
 #include <filesystem>
 
 #include "system/scene.h"
+#include "math/constants.h"
 #include "system/assert.h"
 #include "system/console.h"
 #include "system/context.h"
@@ -32,22 +34,27 @@ const GmSceneStats Gm_GetSceneStats(GmContext* context) {
   return stats;
 }
 
-void Gm_AddMesh(GmContext* context, const std::string& meshName, u16 maxInstances, Gamma::Mesh* mesh) {
+void Gm_AddMesh(GmContext* context, const std::string& meshName, u32 maxInstances, Gamma::Mesh* mesh) {
   auto& scene = context->scene;
   auto& meshes = scene.meshes;
   auto& meshMap = scene.meshMap;
 
   assert(meshMap.find(meshName) == meshMap.end(), "Mesh '" + meshName + "' already exists!");
 
+  // The particle system vertex shader declares a full mat4
+  // model matrix attribute, rather than using instancing.glsl
+  assert(mesh->type != MeshType::PARTICLE_SYSTEM || mesh->objects.getMatrixFormat() == MatrixFormat::FULL, "Particle system Mesh '" + meshName + "' must use FULL matrices");
+
   mesh->index = (u16)meshes.size();
   mesh->id = scene.runningMeshId++;
   mesh->objects.reserve(maxInstances);
+  mesh->objects.setBoundingSphere(mesh->bounds.center, mesh->bounds.radius);
 
   meshMap.emplace(meshName, mesh);
   meshes.push_back(mesh);
 
   if (mesh->type == MeshType::PARTICLE_SYSTEM) {
-    for (u16 i = 0; i < maxInstances; i++) {
+    for (u32 i = 0; i < maxInstances; i++) {
       Gm_CreateObjectFrom(context, meshName);
     }
   }
@@ -85,7 +92,9 @@ void Gm_UseSceneFile(GmContext* context, const std::string& filename) {
   // Load meshes
   for (auto& [ key, property ] : *scene["meshes"].object) {
     auto& meshConfig = *property.object;
-    u32 maxInstances = Gm_ReadYamlProperty<u32>(meshConfig, "max");
+    // Pools grow as objects are created, so 'max' only
+    // determines the initial capacity of each mesh pool
+    u32 maxInstances = Gm_HasYamlProperty(meshConfig, "max") ? Gm_ReadYamlProperty<u32>(meshConfig, "max") : 1;
     Mesh* mesh = nullptr;
 
     if (Gm_HasYamlProperty(meshConfig, "plane")) {
@@ -133,6 +142,10 @@ void Gm_UseSceneFile(GmContext* context, const std::string& filename) {
         }
       }
 
+      if (Gm_HasYamlProperty(meshConfig, "occluder")) {
+        mesh->isOccluder = Gm_ReadYamlProperty<bool>(meshConfig, "occluder");
+      }
+
       Gm_AddMesh(context, key, maxInstances, mesh);
     }
   }
@@ -142,44 +155,142 @@ void Gm_UseSceneFile(GmContext* context, const std::string& filename) {
   Gm_FreeYamlObject(&scene);
 }
 
+/**
+ * Determines whether a mesh was added to a context's scene.
+ * Objects are committed through the scene's mesh list, so
+ * objects can only be created from meshes in that list.
+ */
+static bool Gm_IsSceneMesh(GmContext* context, Gamma::Mesh* mesh) {
+  auto& meshes = context->scene.meshes;
+
+  return mesh->index < meshes.size() && meshes[mesh->index] == mesh;
+}
+
+static void Gm_InitializeObject(Gamma::Mesh* mesh, Gamma::Object& object) {
+  object._record.meshId = mesh->id;
+  object._record.meshIndex = mesh->index;
+  object.position = Vec3f(0.0f);
+  object.rotation = Vec3f(0.0f);
+  object.scale = Vec3f(1.0f);
+}
+
 Gamma::Object& Gm_CreateObjectFrom(GmContext* context, const std::string& meshName) {
   auto& meshMap = context->scene.meshMap;
 
   assert(meshMap.find(meshName) != meshMap.end(), "Mesh '" + meshName + "' not found");
 
-  auto& mesh = *meshMap.at(meshName);
-  auto& object = mesh.objects.createObject();
+  return Gm_CreateObjectFrom(context, meshMap.at(meshName));
+}
 
-  object._record.meshId = mesh.id;
-  object._record.meshIndex = mesh.index;
-  object.position = Vec3f(0.0f);
-  object.rotation = Vec3f(0.0f);
-  object.scale = Vec3f(1.0f);
+Gamma::Object& Gm_CreateObjectFrom(GmContext* context, Gamma::MeshHandle handle) {
+  return Gm_CreateObjectFrom(context, context->scene.meshes[handle.index]);
+}
+
+Gamma::Object& Gm_CreateObjectFrom(GmContext* context, Gamma::Mesh* mesh) {
+  assert(Gm_IsSceneMesh(context, mesh), "Mesh has not been added to the scene");
+
+  auto& object = mesh->objects.createObject();
 
-  if (mesh.lods.size() > 0) {
+  Gm_InitializeObject(mesh, object);
+
+  if (mesh->lods.size() > 0) {
     // Increment the base LoD instance count by default,
     // which we use for vert/tri counts in scene stats.
     // Gm_UseLodByDistance can control the per-LoD
     // instance counts during the update loop.
-    mesh.lods[0].instanceCount++;
+    mesh->lods[0].instanceCount++;
   }
 
   return object;
 }
 
+Gamma::ObjectSpan Gm_CreateObjectsFrom(GmContext* context, Gamma::Mesh* mesh, u32 total) {
+  assert(Gm_IsSceneMesh(context, mesh), "Mesh has not been added to the scene");
+
+  auto objects = mesh->objects.createObjects(total);
+
+  for (auto& object : objects) {
+    Gm_InitializeObject(mesh, object);
+  }
+
+  if (mesh->lods.size() > 0) {
+    mesh->lods[0].instanceCount += total;
+  }
+
+  return objects;
+}
+
+/**
+ * Computes the local transform matrix of an object, from its
+ * own position, scale and rotation. Parent transforms are
+ * applied later by the scene graph in Gm_UpdateSceneGraph().
+ */
+static void Gm_ComputeObjectMatrix(GmContext* context, const Gamma::Object& object, Gamma::Matrix4f& matrix) {
+  auto* mesh = context->scene.meshes[object._record.meshIndex];
+
+  if (mesh->objects.getRotationMode() == RotationMode::QUATERNION) {
+    auto& orientation = mesh->objects.getOrientations()[mesh->objects.indexOf(object)];
+
+    Gm_ComputeTransformMatrix(object.position, object.scale, orientation, matrix);
+  } else {
+    Gm_ComputeTransformMatrix(object.position, object.scale, object.rotation, matrix);
+  }
+}
+
 void Gm_Commit(GmContext* context, const Gamma::Object& object) {
   auto& meshes = context->scene.meshes;
+  auto& graph = context->scene.graph;
   auto& record = object._record;
   auto* mesh = meshes[record.meshIndex];
 
-  // @todo (?) dispatch transform commands to separate buckets for multithreading
-  mesh->objects.transformById(record.id, Matrix4f::transformation(
-    object.position,
-    object.scale,
-    object.rotation
-  ).transpose());
+  // For large numbers of objects, Gm_CommitAll()/Gm_CommitRange()
+  // avoid per-object lookups and spread the work across threads
+  Matrix4f matrix;
+
+  Gm_ComputeObjectMatrix(context, object, matrix);
 
+  mesh->objects.setTransformById(record.id, object.position, object.scale, object.rotation);
   mesh->objects.setColorById(record.id, object.color);
+
+  if (graph.hasRecord(record)) {
+    graph.setLocalMatrix(record, matrix);
+
+    // Attached objects are transformed relative to their parents,
+    // and their world matrices written by Gm_UpdateSceneGraph()
+    if (graph.hasParent(record)) {
+      return;
+    }
+  }
+
+  mesh->objects.transformById(record.id, matrix);
+}
+
+void Gm_CommitAll(GmContext* context, Gamma::Mesh* mesh) {
+  mesh->objects.commitObjects();
+
+  context->scene.graph.syncObjects(mesh->objects, 0, mesh->objects.totalActive());
+}
+
+void Gm_CommitRange(GmContext* context, Gamma::Mesh* mesh, u32 begin, u32 end) {
+  mesh->objects.commitObjects(begin, end);
+
+  context->scene.graph.syncObjects(mesh->objects, begin, end);
+}
+
+Gamma::Mesh* Gm_GetMesh(GmContext* context, const std::string& meshName) {
+  auto& meshMap = context->scene.meshMap;
+
+  assert(meshMap.find(meshName) != meshMap.end(), "Mesh '" + meshName + "' not found");
+
+  return meshMap.at(meshName);
+}
+
+Gamma::Mesh* Gm_GetMesh(GmContext* context, Gamma::MeshHandle handle) {
+  return context->scene.meshes[handle.index];
+}
+
+Gamma::MeshHandle Gm_GetMeshHandle(GmContext* context, const std::string& meshName) {
+  return { Gm_GetMesh(context, meshName)->index };
 }
 
 Gamma::ObjectPool& Gm_GetObjects(GmContext* context, const std::string& meshName) {
@@ -189,8 +300,28 @@ Gamma::ObjectPool& Gm_GetObjects(GmContext* context, const std::string& meshName
   return context->scene.meshMap[meshName]->objects;
 }
 
+Gamma::ObjectPool& Gm_GetObjects(GmContext* context, Gamma::MeshHandle handle) {
+  return context->scene.meshes[handle.index]->objects;
+}
+
+Gamma::NamedObjectHandle Gm_GetObjectHandle(GmContext* context, const std::string& objectName) {
+  auto& store = context->scene.objectStore;
+
+  assert(store.find(objectName) != store.end(), "Object '" + objectName + "' has not been saved");
+
+  return { store.at(objectName) };
+}
+
 void Gm_SaveObject(GmContext* context, const std::string& objectName, const Gamma::Object& object) {
-  context->scene.objectStore[objectName] = object._record;
+  auto& scene = context->scene;
+  auto& store = scene.objectStore;
+
+  if (store.find(objectName) == store.end()) {
+    store.emplace(objectName, (u32)scene.namedObjects.size());
+    scene.namedObjects.push_back(object._record);
+  } else {
+    scene.namedObjects[store.at(objectName)] = object._record;
+  }
 }
 
 void Gm_SaveLight(GmContext* context, const std::string& lightName, Gamma::Light* light) {
@@ -201,27 +332,36 @@ bool Gm_HasObject(GmContext* context, const std::string& objectName) {
   return Gm_FindObject(context, objectName) != nullptr;
 }
 
+bool Gm_HasObject(GmContext* context, Gamma::NamedObjectHandle handle) {
+  return Gm_FindObject(context, handle) != nullptr;
+}
+
 Gamma::Object* Gm_FindObject(GmContext* context, const std::string& objectName) {
-  auto& scene = context->scene;
-  auto& store = scene.objectStore;
+  auto& store = context->scene.objectStore;
 
   if (store.find(objectName) == store.end()) {
     return nullptr;
   }
 
-  auto& record = store.at(objectName);
+  return Gm_FindObject(context, NamedObjectHandle{ store.at(objectName) });
+}
+
+Gamma::Object* Gm_FindObject(GmContext* context, Gamma::NamedObjectHandle handle) {
+  auto& scene = context->scene;
+  auto& record = scene.namedObjects[handle.index];
   auto& mesh = scene.meshes[record.meshIndex];
 
   return mesh->objects.getByRecord(record);
 }
 
 Gamma::Object& Gm_GetObject(GmContext* context, const std::string& objectName) {
-  auto& scene = context->scene;
   // @todo assert that the object exists
-  auto& record = scene.objectStore.at(objectName);
-  auto& mesh = scene.meshes[record.meshIndex];
+  return Gm_GetObject(context, NamedObjectHandle{ context->scene.objectStore.at(objectName) });
+}
 
-  return *mesh->objects.getByRecord(record);
+Gamma::Object& Gm_GetObject(GmContext* context, Gamma::NamedObjectHandle handle) {
+  // @todo assert that the object exists
+  return *Gm_FindObject(context, handle);
 }
 
 Gamma::Light& Gm_GetLight(GmContext* context, const std::string& lightName) {
@@ -235,9 +375,99 @@ void Gm_RemoveObject(GmContext* context, const Gamma::Object& object) {
   auto& record = object._record;
   auto& mesh = context->scene.meshes[record.meshIndex];
 
+  context->scene.bvh.removeRecord(record);
+  context->scene.graph.removeRecord(record);
+
   mesh->objects.removeById(record.id);
 }
 
+/**
+ * Removes all objects of a mesh matching a predicate in a
+ * single pass, as with ObjectPool::removeIf(), along with
+ * their scene BVH and scene graph records. Returns the
+ * number of objects removed.
+ */
+u32 Gm_RemoveObjectsIf(GmContext* context, Gamma::Mesh* mesh, const std::function<bool(const Gamma::Object&)>& predicate) {
+  auto& bvh = context->scene.bvh;
+  auto& graph = context->scene.graph;
+
+  return mesh->objects.removeIf([&](const Gamma::Object& object) {
+    if (!predicate(object)) {
+      return false;
+    }
+
+    bvh.removeRecord(object._record);
+    graph.removeRecord(object._record);
+
+    return true;
+  });
+}
+
+/**
+ * Attaches an object to a parent object, so the object's
+ * transform is relative to its parent's from then on. Both
+ * objects take their current transforms, and the object's
+ * world matrix is written on the next Gm_UpdateSceneGraph().
+ */
+void Gm_AttachObject(GmContext* context, const Gamma::Object& child, const Gamma::Object& parent) {
+  auto& graph = context->scene.graph;
+  Matrix4f childMatrix;
+  Matrix4f parentMatrix;
+
+  Gm_ComputeObjectMatrix(context, child, childMatrix);
+  Gm_ComputeObjectMatrix(context, parent, parentMatrix);
+
+  graph.attach(child._record, parent._record);
+  graph.setLocalMatrix(child._record, childMatrix);
+  graph.setLocalMatrix(parent._record, parentMatrix);
+}
+
+/**
+ * Detaches an object from its parent. The object stays where
+ * it is until it's next committed, at which point its transform
+ * is no longer relative to its former parent.
+ */
+void Gm_DetachObject(GmContext* context, const Gamma::Object& object) {
+  context->scene.graph.detach(object._record);
+}
+
+/**
+ * Writes the world matrices of attached objects whose parents
+ * (or themselves) have been committed since the last update.
+ * Runs automatically before scene culling and rendering, but
+ * can be called earlier to read back world space bounds.
+ */
+void Gm_UpdateSceneGraph(GmContext* context) {
+  auto& scene = context->scene;
+
+  scene.graph.update(scene.meshes);
+}
+
+/**
+ * Brings the scene BVH up to date with every object whose
+ * bounds have changed since the last update, however they
+ * were changed. The BVH isn't maintained until this is first
+ * called, at which point it adds every object in the scene,
+ * so scenes which don't use it don't pay for it. Runs
+ * automatically during scene culling, but must be called
+ * before querying the BVH otherwise.
+ */
+void Gm_UpdateSceneBvh(GmContext* context) {
+  auto& scene = context->scene;
+
+  Gm_UpdateSceneGraph(context);
+
+  for (auto* mesh : scene.meshes) {
+    // Particle systems are positioned on the GPU, and
+    // aren't culled by the BVH
+    if (mesh->type != MeshType::PARTICLE_SYSTEM) {
+      scene.bvh.updateChangedObjects(mesh->objects);
+    }
+  }
+
+  scene.bvh.update();
+}
+
 void Gm_RemoveLight(GmContext* context, Gamma::Light* light) {
   auto& scene = context->scene;
   auto& renderer = context->renderer;
@@ -301,38 +531,164 @@ void Gm_HandleFreeCameraMode(GmContext* context, float dt) {
 }
 
 void Gm_UseFrustumCulling(GmContext* context, const std::initializer_list<std::string>& meshNames) {
-  auto& meshMap = context->scene.meshMap;
+  auto frustum = Gm_GetCameraFrustum(context->scene.camera, context->window.size);
 
   for (auto& meshName : meshNames) {
-    meshMap[meshName]->objects.partitionByVisibility(context->scene.camera);
+    Gm_GetMesh(context, meshName)->objects.partitionByVisibility(frustum);
   }
 }
 
-void Gm_UseLodByDistance(GmContext* context, float distance, const std::initializer_list<std::string>& meshNames) {
-  auto& meshMap = context->scene.meshMap;
+void Gm_UseFrustumCulling(GmContext* context, const std::initializer_list<Gamma::MeshHandle>& meshHandles) {
+  auto frustum = Gm_GetCameraFrustum(context->scene.camera, context->window.size);
+
+  for (auto handle : meshHandles) {
+    Gm_GetMesh(context, handle)->objects.partitionByVisibility(frustum);
+  }
+}
+
+// The fraction of a LoD threshold objects can move past it
+// before changing LoDs, which prevents popping between LoDs
+constexpr static float LOD_HYSTERESIS = 0.1f;
+
+static void Gm_PartitionByLod(GmContext* context, Gamma::Mesh& mesh, const std::vector<Gamma::LodThreshold>& thresholds) {
+  u32 totalLods = (u32)mesh.lods.size();
+  std::vector<u32> lodCounts(totalLods);
+  u32 instanceOffset = 0;
+
+  // Sort objects into all LoDs together, and use the
+  // number of objects at each LoD to determine each
+  // LoD's range of instances
+  mesh.objects.partitionByLod(context->scene.camera.position, thresholds.data(), totalLods, LOD_HYSTERESIS, lodCounts.data());
+
+  for (u32 lodIndex = 0; lodIndex < totalLods; lodIndex++) {
+    mesh.lods[lodIndex].instanceOffset = instanceOffset;
+    mesh.lods[lodIndex].instanceCount = lodCounts[lodIndex];
+
+    instanceOffset += lodCounts[lodIndex];
+  }
+}
+
+static void Gm_UseLodByDistance(GmContext* context, float distance, Gamma::Mesh& mesh) {
+  if (mesh.lods.size() == 0) {
+    return;
+  }
+
+  // Each LoD extends the distance threshold further,
+  // with the final LoD used beyond the last threshold
+  std::vector<Gamma::LodThreshold> thresholds(mesh.lods.size() - 1);
+
+  for (u32 lodIndex = 0; lodIndex < thresholds.size(); lodIndex++) {
+    thresholds[lodIndex].distance = distance * float(lodIndex + 1);
+  }
+
+  Gm_PartitionByLod(context, mesh, thresholds);
+}
+
+static void Gm_UseLodByScreenSize(GmContext* context, float pixels, Gamma::Mesh& mesh) {
+  if (mesh.lods.size() == 0) {
+    return;
+  }
+
+  // Objects are projected to a diameter of 2 * radius * scale / distance
+  // pixels, so an object is at least a given size within a distance of
+  // radius * (2 * scale / size). Each LoD halves the size threshold,
+  // with the final LoD used for objects smaller than the last threshold.
   auto& camera = context->scene.camera;
+  float scale = 0.5f * float(context->window.size.height) / tanf(camera.fov * 0.5f * Gamma::DEGREES_TO_RADIANS);
+  float size = pixels;
+  std::vector<Gamma::LodThreshold> thresholds(mesh.lods.size() - 1);
+
+  for (auto& threshold : thresholds) {
+    threshold.radiusScale = 2.0f * scale / size;
+
+    size *= 0.5f;
+  }
+
+  Gm_PartitionByLod(context, mesh, thresholds);
+}
+
+void Gm_UseLodByDistance(GmContext* context, float distance, const std::initializer_list<std::string>& meshNames) {
+  for (auto& meshName : meshNames) {
+    Gm_UseLodByDistance(context, distance, *Gm_GetMesh(context, meshName));
+  }
+}
 
+void Gm_UseLodByDistance(GmContext* context, float distance, const std::initializer_list<Gamma::MeshHandle>& meshHandles) {
+  for (auto handle : meshHandles) {
+    Gm_UseLodByDistance(context, distance, *Gm_GetMesh(context, handle));
+  }
+}
+
+void Gm_UseLodByScreenSize(GmContext* context, float pixels, const std::initializer_list<std::string>& meshNames) {
   for (auto& meshName : meshNames) {
-    auto& mesh = *meshMap[meshName];
+    Gm_UseLodByScreenSize(context, pixels, *Gm_GetMesh(context, meshName));
+  }
+}
 
-    u32 instanceOffset = 0;
+void Gm_UseLodByScreenSize(GmContext* context, float pixels, const std::initializer_list<Gamma::MeshHandle>& meshHandles) {
+  for (auto handle : meshHandles) {
+    Gm_UseLodByScreenSize(context, pixels, *Gm_GetMesh(context, handle));
+  }
+}
 
-    for (u32 lodIndex = 0; lodIndex < mesh.lods.size(); lodIndex++) {
-      mesh.lods[lodIndex].instanceOffset = instanceOffset;
+// The width of the occlusion buffer, in pixels. Its height
+// follows the aspect ratio of the window.
+constexpr static u32 OCCLUSION_BUFFER_WIDTH = 256;
 
-      if (lodIndex < mesh.lods.size() - 1) {
-        // Group all objects within the distance threshold
-        // in front of those outside it, and use the pivot
-        // defining that boundary to determine our instance
-        // count for this LoD set
-        instanceOffset = (u32)mesh.objects.partitionByDistance((u16)instanceOffset, distance * float(lodIndex + 1), camera.position);
+static void Gm_RasterizeOccluders(GmContext* context) {
+  auto& scene = context->scene;
+  auto& buffer = scene.occlusionBuffer;
+  auto& area = context->window.size;
+  u32 height = OCCLUSION_BUFFER_WIDTH * area.height / std::max(area.width, 1U);
 
-        mesh.lods[lodIndex].instanceCount = instanceOffset - mesh.lods[lodIndex].instanceOffset;
-      } else {
-        // The final LoD can just use the remaining set
-        // of objects beyond the last LoD distance threshold
-        mesh.lods[lodIndex].instanceCount = (u32)mesh.objects.totalVisible() - instanceOffset;
-      }
+  buffer.resize(OCCLUSION_BUFFER_WIDTH, height);
+  buffer.setViewProjection(Gm_GetCameraViewProjectionMatrix(scene.camera, area));
+
+  for (auto* mesh : scene.meshes) {
+    if (mesh->isOccluder && !mesh->disabled) {
+      buffer.addOccluder(*mesh);
     }
   }
+
+  buffer.rasterize();
+}
+
+// Frustum culls each mesh, and then culls the objects found
+// to be hidden behind occluder meshes. Occluders are drawn
+// from all of their objects inside the view frustum, so
+// they're unaffected by having been occlusion culled
+// themselves on previous frames.
+void Gm_UseOcclusionCulling(GmContext* context, const std::initializer_list<std::string>& meshNames) {
+  auto frustum = Gm_GetCameraFrustum(context->scene.camera, context->window.size);
+
+  Gm_RasterizeOccluders(context);
+
+  for (auto& meshName : meshNames) {
+    auto* mesh = Gm_GetMesh(context, meshName);
+
+    mesh->objects.partitionByVisibility(frustum);
+    context->scene.occlusionBuffer.partitionByOcclusion(*mesh);
+  }
+}
+
+void Gm_UseOcclusionCulling(GmContext* context, const std::initializer_list<Gamma::MeshHandle>& meshHandles) {
+  auto frustum = Gm_GetCameraFrustum(context->scene.camera, context->window.size);
+
+  Gm_RasterizeOccluders(context);
+
+  for (auto handle : meshHandles) {
+    auto* mesh = Gm_GetMesh(context, handle);
+
+    mesh->objects.partitionByVisibility(frustum);
+    context->scene.occlusionBuffer.partitionByOcclusion(*mesh);
+  }
+}
+
+void Gm_UseSceneCulling(GmContext* context) {
+  auto& scene = context->scene;
+  auto frustum = Gm_GetCameraFrustum(scene.camera, context->window.size);
+
+  Gm_UpdateSceneBvh(context);
+
+  scene.bvh.partitionByVisibility(frustum, scene.meshes);
 }
\ No newline at end of file
@@ -8,8 +8,12 @@
 #include <vector>
 
 #include "system/camera.h"
+#include "system/CascadeSet.h"
 #include "system/entities.h"
 #include "system/InputSystem.h"
+#include "system/OcclusionBuffer.h"
+#include "system/SceneBvh.h"
+#include "system/SceneGraph.h"
 #include "system/Signaler.h"
 #include "system/traits.h"
 #include "system/type_aliases.h"
@@ -18,7 +22,10 @@
 #define addProbe(probeName, position) Gm_AddProbe(context, probeName, position)
 #define createLight(type) Gm_CreateLight(context, type)
 #define createObjectFrom(meshName) Gm_CreateObjectFrom(context, meshName)
+#define createObjectsFrom(mesh, total) Gm_CreateObjectsFrom(context, mesh, total)
 #define commit(object) Gm_Commit(context, object)
+#define commitAll(mesh) Gm_CommitAll(context, mesh)
+#define commitRange(mesh, begin, end) Gm_CommitRange(context, mesh, begin, end)
 #define saveObject(objectName, object) Gm_SaveObject(context, objectName, object)
 #define saveLight(lightName, light) Gm_SaveLight(context, lightName, light)
 #define hasObject(objectName) Gm_HasObject(context, objectName)
@@ -26,12 +33,20 @@
 #define object(objectName) Gm_GetObject(context, objectName)
 #define light(lightName) Gm_GetLight(context, lightName)
 #define removeObject(object) Gm_RemoveObject(context, object)
+#define removeObjectsIf(mesh, predicate) Gm_RemoveObjectsIf(context, mesh, predicate)
+#define attachObject(child, parent) Gm_AttachObject(context, child, parent)
+#define detachObject(object) Gm_DetachObject(context, object)
 #define removeLight(light) Gm_RemoveLight(context, light)
-#define mesh(meshName) context->scene.meshMap.at(meshName)
+#define mesh(meshName) Gm_GetMesh(context, meshName)
+#define meshHandle(meshName) Gm_GetMeshHandle(context, meshName)
+#define objectHandle(objectName) Gm_GetObjectHandle(context, objectName)
 #define objects(meshName) Gm_GetObjects(context, meshName)
 #define pointCameraAt(...) Gm_PointCameraAt(context, __VA_ARGS__)
 #define useFrustumCulling(...) Gm_UseFrustumCulling(context, __VA_ARGS__)
 #define useLodByDistance(distance, ...) Gm_UseLodByDistance(context, distance, __VA_ARGS__)
+#define useLodByScreenSize(pixels, ...) Gm_UseLodByScreenSize(context, pixels, __VA_ARGS__)
+#define useOcclusionCulling(...) Gm_UseOcclusionCulling(context, __VA_ARGS__)
+#define useSceneCulling() Gm_UseSceneCulling(context)
 
 #define getInput() context->scene.input
 #define getCamera() context->scene.camera
@@ -53,9 +68,23 @@ struct GmScene {
   std::vector<Gamma::Light*> lights;
   std::map<std::string, Gamma::Mesh*> meshMap;
   std::map<std::string, Gamma::Vec3f> probeMap;
-  std::map<std::string, Gamma::ObjectRecord> objectStore;
+  // Named object records are stored by index, so
+  // NamedObjectHandles can refer to them directly
+  std::map<std::string, u32> objectStore;
+  std::vector<Gamma::ObjectRecord> namedObjects;
   // @todo when recycling a light, its lightStore entry should be removed
   std::map<std::string, Gamma::Light*> lightStore;
+  // Bounds of every object, across all meshes, kept up
+  // to date once scene culling is used
+  Gamma::SceneBvh bvh;
+  // Parent/child relationships between objects, whose
+  // world matrices are updated each frame
+  Gamma::SceneGraph graph;
+  // Cascade splits for directional light shadows
+  Gamma::CascadeSettings shadowCascades;
+  // Depth of every occluder mesh, redrawn each frame
+  // occlusion culling is used
+  Gamma::OcclusionBuffer occlusionBuffer;
   Gamma::Vec3f freeCameraVelocity = Gamma::Vec3f(0.0f);
   u16 runningMeshId = 0;
   u32 frame = 0;
@@ -63,23 +92,48 @@ struct GmScene {
 };
 
 const GmSceneStats Gm_GetSceneStats(GmContext* context);
-void Gm_AddMesh(GmContext* context, const std::string& meshName, u16 maxInstances, Gamma::Mesh* mesh);
+void Gm_AddMesh(GmContext* context, const std::string& meshName, u32 maxInstances, Gamma::Mesh* mesh);
 void Gm_AddProbe(GmContext* context, const std::string& probeName, const Gamma::Vec3f& position);
 Gamma::Light& Gm_CreateLight(GmContext* context, Gamma::LightType type);
 void Gm_UseSceneFile(GmContext* context, const std::string& filename);
 Gamma::Object& Gm_CreateObjectFrom(GmContext* context, const std::string& meshName);
+Gamma::Object& Gm_CreateObjectFrom(GmContext* context, Gamma::Mesh* mesh);
+Gamma::Object& Gm_CreateObjectFrom(GmContext* context, Gamma::MeshHandle handle);
+Gamma::ObjectSpan Gm_CreateObjectsFrom(GmContext* context, Gamma::Mesh* mesh, u32 total);
 void Gm_Commit(GmContext* context, const Gamma::Object& object);
+void Gm_CommitAll(GmContext* context, Gamma::Mesh* mesh);
+void Gm_CommitRange(GmContext* context, Gamma::Mesh* mesh, u32 begin, u32 end);
+Gamma::Mesh* Gm_GetMesh(GmContext* context, const std::string& meshName);
+Gamma::Mesh* Gm_GetMesh(GmContext* context, Gamma::MeshHandle handle);
+Gamma::MeshHandle Gm_GetMeshHandle(GmContext* context, const std::string& meshName);
 Gamma::ObjectPool& Gm_GetObjects(GmContext* context, const std::string& meshName);
+Gamma::ObjectPool& Gm_GetObjects(GmContext* context, Gamma::MeshHandle handle);
+Gamma::NamedObjectHandle Gm_GetObjectHandle(GmContext* context, const std::string& objectName);
 void Gm_SaveObject(GmContext* context, const std::string& objectName, const Gamma::Object& object);
 void Gm_SaveLight(GmContext* context, const std::string& lightName, Gamma::Light* light);
 bool Gm_HasObject(GmContext* context, const std::string& objectName);
+bool Gm_HasObject(GmContext* context, Gamma::NamedObjectHandle handle);
 Gamma::Object* Gm_FindObject(GmContext* context, const std::string& objectName);
+Gamma::Object* Gm_FindObject(GmContext* context, Gamma::NamedObjectHandle handle);
 Gamma::Object& Gm_GetObject(GmContext* context, const std::string& objectName);
+Gamma::Object& Gm_GetObject(GmContext* context, Gamma::NamedObjectHandle handle);
 Gamma::Light& Gm_GetLight(GmContext* context, const std::string& lightName);
 void Gm_RemoveObject(GmContext* context, const Gamma::Object& object);
+u32 Gm_RemoveObjectsIf(GmContext* context, Gamma::Mesh* mesh, const std::function<bool(const Gamma::Object&)>& predicate);
+void Gm_AttachObject(GmContext* context, const Gamma::Object& child, const Gamma::Object& parent);
+void Gm_DetachObject(GmContext* context, const Gamma::Object& object);
+void Gm_UpdateSceneGraph(GmContext* context);
+void Gm_UpdateSceneBvh(GmContext* context);
 void Gm_RemoveLight(GmContext* context, Gamma::Light* light);
 void Gm_PointCameraAt(GmContext* context, const Gamma::Object& object, bool upsideDown = false);
 void Gm_PointCameraAt(GmContext* context, const Gamma::Vec3f& position, bool upsideDown = false);
 void Gm_HandleFreeCameraMode(GmContext* context, float dt);
 void Gm_UseFrustumCulling(GmContext* context, const std::initializer_list<std::string>& meshNames);
-void Gm_UseLodByDistance(GmContext* context, float distance, const std::initializer_list<std::string>& meshNames);
\ No newline at end of file
+void Gm_UseFrustumCulling(GmContext* context, const std::initializer_list<Gamma::MeshHandle>& meshHandles);
+void Gm_UseLodByDistance(GmContext* context, float distance, const std::initializer_list<std::string>& meshNames);
+void Gm_UseLodByDistance(GmContext* context, float distance, const std::initializer_list<Gamma::MeshHandle>& meshHandles);
+void Gm_UseLodByScreenSize(GmContext* context, float pixels, const std::initializer_list<std::string>& meshNames);
+void Gm_UseLodByScreenSize(GmContext* context, float pixels, const std::initializer_list<Gamma::MeshHandle>& meshHandles);
+void Gm_UseOcclusionCulling(GmContext* context, const std::initializer_list<std::string>& meshNames);
+void Gm_UseOcclusionCulling(GmContext* context, const std::initializer_list<Gamma::MeshHandle>& meshHandles);
+void Gm_UseSceneCulling(GmContext* context);
\ No newline at end of file
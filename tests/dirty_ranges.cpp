@@ -0,0 +1,130 @@
+#include <iostream>
+#include <vector>
+
+#include "math/matrix.h"
+#include "math/vector.h"
+#include "system/entities.h"
+#include "system/ObjectPool.h"
+#include "system/packed_data.h"
+#include "test.h"
+#include "dirty_ranges.h"
+
+using namespace Gamma;
+
+constexpr static u32 TOTAL_OBJECTS = 1000;
+
+/**
+ * An upload passed to a PoolUploadHandler, standing in
+ * for the glBufferSubData() call the renderer would make.
+ */
+struct RecordedUpload {
+  PoolBuffer buffer;
+  u32 byteOffset;
+  u32 byteLength;
+  const void* data;
+};
+
+/**
+ * Uploads a pool's dirty ranges, recording each upload
+ * rather than sending it to the GPU.
+ */
+static std::vector<RecordedUpload> recordUploads(const ObjectPool& pool, u32& totalBytes) {
+  std::vector<RecordedUpload> uploads;
+
+  totalBytes = pool.uploadDirtyRanges([&](PoolBuffer buffer, u32 byteOffset, u32 byteLength, const void* data) {
+    uploads.push_back({ buffer, byteOffset, byteLength, data });
+  });
+
+  return uploads;
+}
+
+static bool isUpload(const RecordedUpload& upload, PoolBuffer buffer, u32 byteOffset, u32 byteLength) {
+  return (
+    upload.buffer == buffer &&
+    upload.byteOffset == byteOffset &&
+    upload.byteLength == byteLength
+  );
+}
+
+/**
+ * Makes a few scattered edits to a pool with a given matrix
+ * format, and checks that only the 64-object blocks containing
+ * those edits are uploaded.
+ */
+static void test_scattered_edits(MatrixFormat format) {
+  ObjectPool pool;
+
+  pool.setMatrixFormat(format);
+  pool.reserve(TOTAL_OBJECTS);
+
+  auto span = pool.createObjects(TOTAL_OBJECTS);
+  u32 matrixSize = pool.getMatrixSize();
+  u32 totalBytes = 0;
+
+  // Newly created objects upload everything
+  auto uploads = recordUploads(pool, totalBytes);
+
+  expect(uploads.size() == 2, "New objects upload one matrix range and one color range");
+  expect(totalBytes == TOTAL_OBJECTS * (matrixSize + sizeof(pVec4)), "New objects upload every matrix and color");
+
+  // Move objects 5, 300, 301 and 999, and recolor object 130
+  Matrix4f matrix = Matrix4f::translation(Vec3f(1.0f, 2.0f, 3.0f)).transpose();
+
+  pool.transformById(span[5]._record.id, matrix);
+  pool.transformById(span[300]._record.id, matrix);
+  pool.transformById(span[301]._record.id, matrix);
+  pool.transformById(span[999]._record.id, matrix);
+  pool.setColorById(span[130]._record.id, pVec4(255, 0, 0));
+
+  uploads = recordUploads(pool, totalBytes);
+
+  auto* matrixData = format == MatrixFormat::AFFINE ? (const u8*)pool.getAffineMatrices() : (const u8*)pool.getMatrices();
+
+  expect(uploads.size() == 4, "Scattered edits upload four ranges");
+
+  if (uploads.size() == 4) {
+    expect(isUpload(uploads[0], PoolBuffer::MATRICES, 0, 64 * matrixSize), "Object 5 uploads matrices [0, 64)");
+    expect(isUpload(uploads[1], PoolBuffer::MATRICES, 256 * matrixSize, 64 * matrixSize), "Objects 300-301 upload matrices [256, 320)");
+    expect(isUpload(uploads[2], PoolBuffer::MATRICES, 960 * matrixSize, 40 * matrixSize), "Object 999 uploads matrices [960, 1000)");
+    expect(isUpload(uploads[3], PoolBuffer::COLORS, 128 * sizeof(pVec4), 64 * sizeof(pVec4)), "Object 130 uploads colors [128, 192)");
+    expect(uploads[1].data == matrixData + uploads[1].byteOffset, "Matrix uploads point into the pool's matrices");
+    expect(uploads[3].data == pool.getColors() + 128, "Color uploads point into the pool's colors");
+  }
+
+  expect(totalBytes == 168 * matrixSize + 64 * sizeof(pVec4), "Scattered edits upload only their dirty blocks");
+
+  pool.free();
+}
+
+/**
+ * Checks that a pool which hasn't changed since its last
+ * upload doesn't upload anything.
+ */
+static void test_static_pool() {
+  ObjectPool pool;
+
+  pool.reserve(TOTAL_OBJECTS);
+  pool.createObjects(TOTAL_OBJECTS);
+  pool.commitObjects();
+
+  u32 totalBytes = 0;
+
+  recordUploads(pool, totalBytes);
+
+  expect(totalBytes == TOTAL_OBJECTS * (sizeof(Matrix4f) + sizeof(pVec4)), "The first frame uploads every matrix and color");
+
+  auto uploads = recordUploads(pool, totalBytes);
+
+  expect(uploads.empty(), "A static pool makes no uploads on the second frame");
+  expect(totalBytes == 0, "A static pool uploads zero bytes on the second frame");
+
+  pool.free();
+}
+
+void test_dirty_ranges() {
+  std::cout << "test_dirty_ranges\n";
+
+  test_scattered_edits(MatrixFormat::FULL);
+  test_scattered_edits(MatrixFormat::AFFINE);
+  test_static_pool();
+}
\ No newline at end of file
@@ -0,0 +1,3 @@
+#pragma once
+
+void test_dirty_ranges();
\ No newline at end of file
@@ -0,0 +1,285 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "math/batch_culling.h"
+#include "math/constants.h"
+#include "math/vector.h"
+#include "system/camera.h"
+#include "system/entities.h"
+#include "system/LightClusters.h"
+#include "test.h"
+#include "light_clusters.h"
+
+using namespace Gamma;
+
+constexpr static u32 TOTAL_RANDOM_LIGHTS = 500;
+constexpr static u32 TOTAL_SAMPLES_PER_LIGHT = 20000;
+
+static float randomFloat(float low, float high) {
+  return low + (high - low) * ((float)rand() / (float)RAND_MAX);
+}
+
+static Camera createCamera() {
+  Camera camera;
+
+  camera.position = Vec3f(5.0f, 10.0f, -20.0f);
+  camera.fov = 60.0f;
+  camera.rotation = Orientation(0.2f, 0.6f, 0.1f).toQuaternion();
+
+  return camera;
+}
+
+/**
+ * Returns the cluster containing a world space position,
+ * or false if the position is outside the view frustum.
+ * Computed independently of LightClusters, from the grid
+ * dimensions alone.
+ */
+static bool findCluster(const LightClusters& lightClusters, const Camera& camera, const Area<u32>& area, const Vec3f& position, u32& clusterIndex) {
+  Vec4f view = Gm_GetCameraViewMatrix(camera) * position.gl();
+  float depth = -view.z;
+  float tanHalfFovY = tanf(camera.fov * 0.5f * DEGREES_TO_RADIANS);
+  float tanHalfFovX = tanHalfFovY * (float)area.width / (float)area.height;
+
+  if (depth <= CAMERA_NEAR_PLANE || depth >= CAMERA_FAR_PLANE) {
+    return false;
+  }
+
+  float ndcX = view.x / depth / tanHalfFovX;
+  float ndcY = view.y / depth / tanHalfFovY;
+
+  if (std::abs(ndcX) >= 1.0f || std::abs(ndcY) >= 1.0f) {
+    return false;
+  }
+
+  u32 x = (u32)floorf((ndcX * 0.5f + 0.5f) * LIGHT_CLUSTERS_X);
+  u32 y = (u32)floorf((ndcY * 0.5f + 0.5f) * LIGHT_CLUSTERS_Y);
+  float slice = floorf(logf(depth / CAMERA_NEAR_PLANE) / logf(CAMERA_FAR_PLANE / CAMERA_NEAR_PLANE) * LIGHT_CLUSTERS_Z);
+  u32 z = (u32)std::min(slice, float(LIGHT_CLUSTERS_Z - 1));
+
+  clusterIndex = lightClusters.getClusterIndex(x, y, z);
+
+  return true;
+}
+
+static bool isLit(const ClusterLight& light, bool isSpotLight, const Vec3f& position) {
+  Vec3f delta = position - light.position;
+  float distance = delta.magnitude();
+
+  if (distance > light.radius) {
+    return false;
+  }
+
+  if (isSpotLight && distance > 0.0f) {
+    float halfAngle = Gm_GetSpotLightHalfAngle(light.fov);
+
+    return Vec3f::dot(delta / distance, light.direction.unit()) >= cosf(halfAngle);
+  }
+
+  return true;
+}
+
+static bool isLightInCluster(const LightClusters& lightClusters, u32 lightIndex, u32 clusterIndex) {
+  auto& cluster = lightClusters.getClusters()[clusterIndex];
+  auto* indices = lightClusters.getLightIndices().data() + cluster.offset;
+
+  return std::find(indices, indices + cluster.count, lightIndex) != indices + cluster.count;
+}
+
+/**
+ * Checks every cluster's light list against a brute force
+ * intersectsCluster() test of every light.
+ */
+static void expectBruteForceBinning(const LightClusters& lightClusters, const std::string& scene) {
+  auto& clusters = lightClusters.getClusters();
+  auto& indices = lightClusters.getLightIndices();
+  u32 totalLights = (u32)lightClusters.getLights().size();
+  u32 totalMismatches = 0;
+  u32 totalBruteForceIndices = 0;
+
+  for (u32 clusterIndex = 0; clusterIndex < TOTAL_LIGHT_CLUSTERS; clusterIndex++) {
+    auto& cluster = clusters[clusterIndex];
+    std::vector<u32> binned(indices.begin() + cluster.offset, indices.begin() + cluster.offset + cluster.count);
+    std::vector<u32> expected;
+
+    for (u32 lightIndex = 0; lightIndex < totalLights; lightIndex++) {
+      if (lightClusters.intersectsCluster(lightIndex, clusterIndex)) {
+        expected.push_back(lightIndex);
+      }
+    }
+
+    std::sort(binned.begin(), binned.end());
+
+    if (binned != expected) {
+      totalMismatches++;
+    }
+
+    totalBruteForceIndices += (u32)expected.size();
+  }
+
+  expect(totalMismatches == 0, scene + ": every cluster's lights match the brute force result");
+  expect(totalBruteForceIndices == indices.size(), scene + ": the light index list matches the brute force total");
+}
+
+/**
+ * Samples positions lit by a light, and checks that the light
+ * is binned into every cluster containing one of them.
+ */
+static void expectLitClustersBinned(const LightClusters& lightClusters, const Camera& camera, const Area<u32>& area, u32 lightIndex, const std::string& description) {
+  auto& light = lightClusters.getLights()[lightIndex];
+  bool isSpotLight = lightIndex >= lightClusters.totalPointLights();
+  u32 totalChecked = 0;
+  u32 totalMissed = 0;
+
+  for (u32 i = 0; i < TOTAL_SAMPLES_PER_LIGHT; i++) {
+    Vec3f position = light.position + Vec3f(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f)) * light.radius;
+    u32 clusterIndex;
+
+    if (!isLit(light, isSpotLight, position) || !findCluster(lightClusters, camera, area, position, clusterIndex)) {
+      continue;
+    }
+
+    totalChecked++;
+
+    if (!isLightInCluster(lightClusters, lightIndex, clusterIndex)) {
+      totalMissed++;
+    }
+  }
+
+  expect(totalChecked > 0, description + ": lights visible clusters");
+  expect(totalMissed == 0, description + ": is binned into every cluster it lights");
+}
+
+/**
+ * Bins a spot light wider than 180 degrees, pointing away from
+ * the camera so it lights the clusters between the camera and
+ * its apex, along with a point light and a spot light which
+ * straddle the near plane.
+ */
+static void test_wide_and_near_lights() {
+  Camera camera;
+  Area<u32> area = { 1920, 1080 };
+  LightClusters lightClusters;
+  std::vector<Light> lights(3);
+  std::vector<Light*> pointLights;
+  std::vector<Light*> spotLights;
+  Vec3f forward = Vec3f(0.0f, 0.0f, 1.0f);
+
+  camera.fov = 60.0f;
+
+  // Make sure the camera faces the direction we expect
+  Vec4f ahead = Gm_GetCameraViewMatrix(camera) * (forward * 10.0f).gl();
+
+  expect(ahead.z < 0.0f, "The default camera faces +Z");
+
+  auto& nearPoint = lights[0];
+  auto& wideSpot = lights[1];
+  auto& nearSpot = lights[2];
+
+  nearPoint.type = LightType::POINT;
+  nearPoint.position = forward * 0.5f;
+  nearPoint.radius = 4.0f;
+
+  wideSpot.type = LightType::SPOT;
+  wideSpot.position = forward * 50.0f;
+  wideSpot.direction = forward;
+  wideSpot.radius = 40.0f;
+  wideSpot.fov = 300.0f;
+
+  nearSpot.type = LightType::SPOT;
+  nearSpot.position = Vec3f(0.0f, 0.0f, -2.0f);
+  nearSpot.direction = forward;
+  nearSpot.radius = 10.0f;
+  nearSpot.fov = 60.0f;
+
+  pointLights.push_back(&nearPoint);
+  spotLights.push_back(&wideSpot);
+  spotLights.push_back(&nearSpot);
+
+  lightClusters.build(camera, area, pointLights, spotLights);
+
+  expectBruteForceBinning(lightClusters, "Wide and near lights");
+  expectLitClustersBinned(lightClusters, camera, area, 0, "A point light straddling the near plane");
+  expectLitClustersBinned(lightClusters, camera, area, 1, "A spot light wider than 180 degrees");
+  expectLitClustersBinned(lightClusters, camera, area, 2, "A spot light straddling the near plane");
+
+  // A position nearer to the camera than the wide spot
+  // light's apex, 117 degrees off of its direction
+  Vec3f behindApex = Vec3f(20.0f, 0.0f, 40.0f);
+  u32 clusterIndex;
+  bool hasCluster = findCluster(lightClusters, camera, area, behindApex, clusterIndex);
+
+  expect(isLit(lightClusters.getLights()[1], true, behindApex), "A spot light wider than 180 degrees lights positions behind its apex");
+
+  expect(hasCluster && isLightInCluster(lightClusters, 1, clusterIndex), "A spot light wider than 180 degrees lights clusters behind its apex");
+}
+
+/**
+ * Bins a large number of random point and spot lights, with
+ * spot lights of every width, around a rotated camera.
+ */
+static void test_random_lights() {
+  Camera camera = createCamera();
+  Area<u32> area = { 1920, 1080 };
+  LightClusters lightClusters;
+  std::vector<Light> lights(TOTAL_RANDOM_LIGHTS);
+  std::vector<Light*> pointLights;
+  std::vector<Light*> spotLights;
+
+  srand(1);
+
+  for (u32 i = 0; i < TOTAL_RANDOM_LIGHTS; i++) {
+    auto& light = lights[i];
+
+    light.position = camera.position + Vec3f(randomFloat(-300.0f, 300.0f), randomFloat(-100.0f, 100.0f), randomFloat(-300.0f, 300.0f));
+    light.radius = randomFloat(5.0f, 150.0f);
+
+    if (i % 3 == 0) {
+      light.type = LightType::SPOT;
+      light.direction = Vec3f(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f)).unit();
+      light.fov = randomFloat(5.0f, 355.0f);
+
+      spotLights.push_back(&light);
+    } else {
+      light.type = LightType::POINT;
+
+      pointLights.push_back(&light);
+    }
+  }
+
+  lightClusters.build(camera, area, pointLights, spotLights);
+
+  expectBruteForceBinning(lightClusters, "Random lights");
+
+  u32 totalLights = (u32)lightClusters.getLights().size();
+  u32 totalMissed = 0;
+
+  for (u32 i = 0; i < TOTAL_SAMPLES_PER_LIGHT * 10; i++) {
+    u32 lightIndex = (u32)rand() % totalLights;
+    auto& light = lightClusters.getLights()[lightIndex];
+    bool isSpotLight = lightIndex >= lightClusters.totalPointLights();
+    Vec3f position = light.position + Vec3f(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f)) * light.radius;
+    u32 clusterIndex;
+
+    if (
+      isLit(light, isSpotLight, position) &&
+      findCluster(lightClusters, camera, area, position, clusterIndex) &&
+      !isLightInCluster(lightClusters, lightIndex, clusterIndex)
+    ) {
+      totalMissed++;
+    }
+  }
+
+  expect(totalMissed == 0, "Random lights are binned into every cluster they light");
+}
+
+void test_light_clusters() {
+  std::cout << "test_light_clusters\n";
+
+  test_wide_and_near_lights();
+  test_random_lights();
+}
\ No newline at end of file
@@ -0,0 +1,3 @@
+#pragma once
+
+void test_light_clusters();
\ No newline at end of file
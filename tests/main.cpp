@@ -0,0 +1,24 @@
+#include <iostream>
+
+#include "test.h"
+#include "dirty_ranges.h"
+#include "light_clusters.h"
+#include "math_kernels.h"
+
+int main() {
+  test_dirty_ranges();
+  test_light_clusters();
+  test_math_kernels();
+
+  u32 totalFailures = getTotalFailures();
+
+  if (totalFailures > 0) {
+    std::cout << totalFailures << " expectation(s) failed\n";
+
+    return 1;
+  }
+
+  std::cout << "All tests passed\n";
+
+  return 0;
+}
\ No newline at end of file
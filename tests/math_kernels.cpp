@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "math/utilities.h"
+#include "math/matrix.h"
+#include "math/Quaternion.h"
+#include "math/vector.h"
+#include "test.h"
+#include "math_kernels.h"
+
+using namespace Gamma;
+
+constexpr static u32 TOTAL_MATRICES = 1024;
+
+/**
+ * The largest errors allowed between the SIMD kernels and
+ * their scalar references, relative to the largest term of
+ * each expected result. Products may round differently if
+ * the compiler fuses multiplies and adds; inverses divide by
+ * the determinant, and round differently regardless.
+ */
+constexpr static float MAX_PRODUCT_ERROR = 1e-6f;
+constexpr static float MAX_INVERSE_ERROR = 1e-5f;
+
+static float randomFloat(float low, float high) {
+  return low + (high - low) * ((float)rand() / (float)RAND_MAX);
+}
+
+/**
+ * Creates random transformation matrices, which are always
+ * invertible.
+ */
+static std::vector<Matrix4f> createRandomMatrices() {
+  std::vector<Matrix4f> matrices(TOTAL_MATRICES);
+
+  for (auto& matrix : matrices) {
+    Vec3f position = Vec3f(randomFloat(-1000.0f, 1000.0f), randomFloat(-1000.0f, 1000.0f), randomFloat(-1000.0f, 1000.0f));
+    Vec3f scale = Vec3f(randomFloat(0.1f, 10.0f), randomFloat(0.1f, 10.0f), randomFloat(0.1f, 10.0f));
+    Vec3f rotation = Vec3f(randomFloat(0.0f, Gm_TAU), randomFloat(0.0f, Gm_TAU), randomFloat(0.0f, Gm_TAU));
+
+    matrix = Matrix4f::transformation(position, scale, rotation);
+  }
+
+  return matrices;
+}
+
+static std::vector<Quaternion> createRandomQuaternions() {
+  std::vector<Quaternion> quaternions(TOTAL_MATRICES);
+
+  for (auto& quaternion : quaternions) {
+    Vec3f axis = Vec3f(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f)).unit();
+
+    quaternion = Quaternion::fromAxisAngle(randomFloat(0.0f, Gm_TAU), axis.x, axis.y, axis.z);
+  }
+
+  return quaternions;
+}
+
+/**
+ * Returns the largest difference between the terms of two
+ * results, relative to the largest term of the expected one.
+ */
+static float getRelativeError(const float* actual, const float* expected, u32 totalTerms) {
+  float error = 0.0f;
+  float largest = 0.0f;
+
+  for (u32 i = 0; i < totalTerms; i++) {
+    error = std::max(error, std::abs(actual[i] - expected[i]));
+    largest = std::max(largest, std::abs(expected[i]));
+  }
+
+  return largest > 0.0f ? error / largest : error;
+}
+
+static float getRelativeError(const Matrix4f& actual, const Matrix4f& expected) {
+  return getRelativeError(actual.m, expected.m, 16);
+}
+
+static float getRelativeError(const Vec4f& actual, const Vec4f& expected) {
+  float actualTerms[4] = { actual.x, actual.y, actual.z, actual.w };
+  float expectedTerms[4] = { expected.x, expected.y, expected.z, expected.w };
+
+  return getRelativeError(actualTerms, expectedTerms, 4);
+}
+
+static float getRelativeError(const Quaternion& actual, const Quaternion& expected) {
+  float actualTerms[4] = { actual.w, actual.x, actual.y, actual.z };
+  float expectedTerms[4] = { expected.w, expected.x, expected.y, expected.z };
+
+  return getRelativeError(actualTerms, expectedTerms, 4);
+}
+
+/**
+ * Checks the SIMD Matrix4f and Quaternion operations against
+ * their scalar references over random transformations.
+ */
+void test_math_kernels() {
+  std::cout << "test_math_kernels\n";
+
+  srand(1);
+
+  auto matrices = createRandomMatrices();
+  auto quaternions = createRandomQuaternions();
+  float productError = 0.0f;
+  float vectorError = 0.0f;
+  float quaternionError = 0.0f;
+  float inverseError = 0.0f;
+  u32 totalTransposeMismatches = 0;
+
+  for (u32 i = 0; i < TOTAL_MATRICES; i++) {
+    auto& a = matrices[i];
+    auto& b = matrices[(i + 1) % TOTAL_MATRICES];
+    auto& q1 = quaternions[i];
+    auto& q2 = quaternions[(i + 1) % TOTAL_MATRICES];
+    Vec3f vector = Vec3f(b.m[3], b.m[7], b.m[11]);
+    Matrix4f transposed = a.transpose();
+    Matrix4f expectedTransposed = Gm_TransposeMatrixScalar(a);
+
+    productError = std::max(productError, getRelativeError(a * b, Gm_MultiplyMatricesScalar(a, b)));
+    vectorError = std::max(vectorError, getRelativeError(a * vector, Gm_TransformVectorScalar(a, vector)));
+    quaternionError = std::max(quaternionError, getRelativeError(q1 * q2, Gm_MultiplyQuaternionsScalar(q1, q2)));
+    inverseError = std::max(inverseError, getRelativeError(a.inverse(), Gm_InvertMatrixScalar(a)));
+
+    for (u32 j = 0; j < 16; j++) {
+      if (transposed.m[j] != expectedTransposed.m[j]) {
+        totalTransposeMismatches++;
+      }
+    }
+  }
+
+  expect(productError <= MAX_PRODUCT_ERROR, "Matrix4f::operator*(Matrix4f) matches Gm_MultiplyMatricesScalar() (error: " + std::to_string(productError) + ")");
+  expect(vectorError <= MAX_PRODUCT_ERROR, "Matrix4f::operator*(Vec3f) matches Gm_TransformVectorScalar() (error: " + std::to_string(vectorError) + ")");
+  expect(quaternionError <= MAX_PRODUCT_ERROR, "Quaternion::operator* matches Gm_MultiplyQuaternionsScalar() (error: " + std::to_string(quaternionError) + ")");
+  expect(inverseError <= MAX_INVERSE_ERROR, "Matrix4f::inverse() matches Gm_InvertMatrixScalar() (error: " + std::to_string(inverseError) + ")");
+  expect(totalTransposeMismatches == 0, "Matrix4f::transpose() matches Gm_TransposeMatrixScalar() exactly");
+}
\ No newline at end of file
@@ -0,0 +1,3 @@
+#pragma once
+
+void test_math_kernels();
\ No newline at end of file
@@ -0,0 +1,17 @@
+#include <iostream>
+
+#include "test.h"
+
+static u32 totalFailures = 0;
+
+void expect(bool condition, const std::string& description) {
+  if (!condition) {
+    std::cout << "  Failed: " << description << "\n";
+
+    totalFailures++;
+  }
+}
+
+u32 getTotalFailures() {
+  return totalFailures;
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+#include "system/type_aliases.h"
+
+/**
+ * Checks a test condition, logging the description of any
+ * which fail. Failures don't stop the test run, so a single
+ * run reports every failing expectation.
+ */
+void expect(bool condition, const std::string& description);
+
+u32 getTotalFailures();
\ No newline at end of file